@@ -0,0 +1,133 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "TObjString.h"
+
+#include "FlatQVectors.h"
+
+namespace Qn {
+
+FlatQVectors::FlatQVectors(std::string name,
+                           const DataContainerQVector &prototype,
+                           std::bitset<QVector::kmaxharmonics> harmonics) :
+    name_(std::move(name)),
+    sum_weights_(prototype.size(), 0.),
+    n_(prototype.size(), 0) {
+  for (unsigned int h = 1; h <= QVector::kmaxharmonics; ++h) {
+    if (harmonics.test(h - 1)) harmonics_.push_back(h);
+  }
+  x_.resize(harmonics_.size(), std::vector<float>(prototype.size(), 0.));
+  y_.resize(harmonics_.size(), std::vector<float>(prototype.size(), 0.));
+  prototype_ = std::make_unique<DataContainerQVector>(prototype);
+}
+
+DataContainerQVector *FlatQVectors::CreateOutputPrototype() {
+  auto output_prototype = new DataContainerQVector(*prototype_);
+  output_prototypes_.push_back(output_prototype);
+  return output_prototype;
+}
+
+void FlatQVectors::AttachToTree(TTree *tree) {
+  const auto size = std::to_string(sum_weights_.size());
+  auto add_branch = [tree, &size](const std::string &branch_name, void *address, const char *type) {
+    auto leaf_list = branch_name + "[" + size + "]/" + type;
+    tree->Branch(branch_name.data(), address, leaf_list.data());
+  };
+  add_branch(name_ + "_sumweights", sum_weights_.data(), "F");
+  add_branch(name_ + "_n", n_.data(), "I");
+  for (std::size_t ih = 0; ih < harmonics_.size(); ++ih) {
+    const auto harmonic = std::to_string(harmonics_[ih]);
+    add_branch(name_ + "_x" + harmonic, x_[ih].data(), "F");
+    add_branch(name_ + "_y" + harmonic, y_[ih].data(), "F");
+  }
+  auto prototypes = dynamic_cast<TMap *>(tree->GetUserInfo()->FindObject(kPrototypesName));
+  if (!prototypes) {
+    prototypes = new TMap();
+    prototypes->SetName(kPrototypesName);
+    prototypes->SetOwnerKeyValue(true, true);
+    tree->GetUserInfo()->Add(prototypes);
+  }
+  // the tree keeps the prototype of a previous configuration e.g. of a previous run.
+  if (!prototypes->GetValue(name_.data())) {
+    prototypes->Add(new TObjString(name_.data()), CreateOutputPrototype());
+  }
+}
+
+void FlatQVectors::Fill(const DataContainerQVector &q_vectors) {
+  if (!prototype_filled_) {
+    // the prototypes receive the harmonics and normalization of the first event.
+    for (std::size_t ibin = 0; ibin < q_vectors.size(); ++ibin) {
+      (*prototype_)[ibin] = q_vectors[ibin];
+    }
+    for (auto output_prototype : output_prototypes_) {
+      *output_prototype = *prototype_;
+    }
+    prototype_filled_ = true;
+  }
+  for (std::size_t ibin = 0; ibin < q_vectors.size(); ++ibin) {
+    const auto &q_vector = q_vectors[ibin];
+    sum_weights_[ibin] = q_vector.sumweights();
+    n_[ibin] = static_cast<Int_t>(q_vector.n());
+    const auto bits = q_vector.GetHarmonics();
+    for (std::size_t ih = 0; ih < harmonics_.size(); ++ih) {
+      const auto harmonic = harmonics_[ih];
+      if (bits.test(harmonic - 1)) {
+        x_[ih][ibin] = q_vector.x(harmonic);
+        y_[ih][ibin] = q_vector.y(harmonic);
+      } else {
+        x_[ih][ibin] = 0.;
+        y_[ih][ibin] = 0.;
+      }
+    }
+  }
+}
+
+std::vector<std::string> FlatQVectors::GetBranchNames(const std::string &name, const DataContainerQVector &prototype) {
+  std::vector<std::string> names{name + "_sumweights", name + "_n"};
+  for (auto harmonic : GetHarmonics(prototype)) {
+    names.push_back(name + "_x" + std::to_string(harmonic));
+    names.push_back(name + "_y" + std::to_string(harmonic));
+  }
+  return names;
+}
+
+std::vector<unsigned int> FlatQVectors::GetHarmonics(const DataContainerQVector &prototype) {
+  std::vector<unsigned int> harmonics;
+  if (prototype.size()==0) return harmonics;
+  const auto bits = prototype[0].GetHarmonics();
+  for (unsigned int h = 1; h <= QVector::kmaxharmonics; ++h) {
+    if (bits.test(h - 1)) harmonics.push_back(h);
+  }
+  return harmonics;
+}
+
+std::map<std::string, const DataContainerQVector *> FlatQVectors::ReadPrototypes(TTree *tree) {
+  return ReadPrototypes(dynamic_cast<TMap *>(tree->GetUserInfo()->FindObject(kPrototypesName)));
+}
+
+std::map<std::string, const DataContainerQVector *> FlatQVectors::ReadPrototypes(TMap *prototype_map) {
+  std::map<std::string, const DataContainerQVector *> prototypes;
+  if (!prototype_map) return prototypes;
+  TIter next(prototype_map);
+  while (auto key = dynamic_cast<TObjString *>(next())) {
+    auto prototype = dynamic_cast<DataContainerQVector *>(prototype_map->GetValue(key));
+    if (prototype) prototypes.emplace(key->GetString().Data(), prototype);
+  }
+  return prototypes;
+}
+
+}
@@ -20,12 +20,81 @@
 #ifndef QNCUTS_H
 #define QNCUTS_H
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <vector>
 #include "ROOT/RMakeUnique.hxx"
 #include "ROOT/RIntegerSequence.hxx"
 
 namespace Qn {
 
+/**
+ * Selection of the channels packed into words of 64 bits.
+ * Channel i is stored in bit i % 64 of word i / 64.
+ */
+namespace Selection {
+constexpr std::size_t kBitsPerWord = 64;
+/**
+ * Number of words needed to store the selection of n channels.
+ * @param n number of channels
+ */
+inline std::size_t NumberOfWords(std::size_t n) { return (n + kBitsPerWord - 1)/kBitsPerWord; }
+/**
+ * Number of set bits in the word.
+ */
+inline unsigned int PopCount(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned int>(__builtin_popcountll(word));
+#else
+  unsigned int count = 0;
+  for (; word; word &= word - 1) ++count;
+  return count;
+#endif
+}
+/**
+ * Position of the lowest set bit. The word must not be zero.
+ */
+inline unsigned int LowestBit(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned int>(__builtin_ctzll(word));
+#else
+  unsigned int bit = 0;
+  for (; !(word & 1u); word >>= 1) ++bit;
+  return bit;
+#endif
+}
+/**
+ * Calls func with the index of every selected channel in increasing order.
+ * @param words selection
+ * @param n_words number of words
+ * @param func function called with the channel index.
+ */
+template<typename FUNC>
+inline void ForEachSelected(const std::uint64_t *words, std::size_t n_words, FUNC &&func) {
+  for (std::size_t iword = 0; iword < n_words; ++iword) {
+    for (auto word = words[iword]; word; word &= word - 1) {
+      func(iword*kBitsPerWord + LowestBit(word));
+    }
+  }
+}
+/**
+ * Extracts the indices of the selected channels.
+ * @param words selection
+ * @param n_words number of words
+ * @param indices indices of the selected channels in increasing order. The vector is resized to their number.
+ */
+inline void Compact(const std::uint64_t *words, std::size_t n_words, std::vector<unsigned int> &indices) {
+  std::size_t n_selected = 0;
+  for (std::size_t iword = 0; iword < n_words; ++iword) { n_selected += PopCount(words[iword]); }
+  indices.resize(n_selected);
+  auto index = indices.data();
+  ForEachSelected(words, n_words, [&index](std::size_t i) { *index++ = static_cast<unsigned int>(i); });
+}
+}
+
 /**
  * Base class of the Cut.
  */
@@ -33,6 +102,12 @@ struct CutBase {
   virtual ~CutBase() = default;
   virtual bool Check() const = 0;
   virtual bool Check(unsigned int) const = 0;
+  /**
+   * Evaluates the cut for all channels and removes the failing channels from the selection.
+   * @param n number of channels
+   * @param selection selection of the channels packed into 64 bit words (see Qn::Selection).
+   */
+  virtual void CheckAll(std::size_t n, std::uint64_t *selection) const = 0;
   virtual std::string Name() const = 0;
 };
 
@@ -40,13 +115,16 @@ struct CutBase {
  * Template class of a cut applied in the correction step.
  * Number of dimensions is determined by the signature of the cut function
  * and by the size of the variables array passed to the constructor.
+ * The cut function is stored with its own type, so that it can be inlined into the loop over the channels.
+ * @tparam VAR Type of the variables. Provides GetLength(), operator[] and Data<U>() for double, float and int.
+ * @tparam FUNC Type of the cut function
  * @tparam T Type of variable
  */
-template<typename VAR, typename... T>
+template<typename VAR, typename FUNC, typename... T>
 class Cut : public CutBase {
  public:
-  Cut(VAR (&arr)[sizeof...(T)], std::function<bool(T...)> lambda, std::string name)
-      : lambda_(lambda), name_(std::move(name)) {
+  Cut(VAR (&arr)[sizeof...(T)], FUNC lambda, std::string name)
+      : lambda_(std::move(lambda)), name_(std::move(name)) {
     int i = 0;
     for (auto &a : arr) {
       variables_.at(i) = std::move(a);
@@ -57,6 +135,9 @@ class Cut : public CutBase {
     return CheckImpl(i_channel, std::make_index_sequence<sizeof...(T)>{});
   }
   bool Check() const override { return CheckImpl(0, std::make_index_sequence<sizeof...(T)>{}); }
+  void CheckAll(std::size_t n, std::uint64_t *selection) const override {
+    CheckAllImpl(n, selection, std::make_index_sequence<sizeof...(T)>{});
+  }
 
   std::string Name() const override { return name_; }
 
@@ -69,21 +150,66 @@ class Cut : public CutBase {
    */
   template<std::size_t... I>
   bool CheckImpl(const unsigned int i, std::index_sequence<I...>) const {
-    return lambda_(*(variables_[I].Get() + i)...);
+    return lambda_(variables_[I][i]...);
+  }
+  /**
+   * Implements the evaluation of the cut for all channels.
+   * The results of 64 channels are packed into one word, which is combined with the selection.
+   * Words in which all channels are already rejected are skipped. Variables with a single value, e.g. event
+   * variables in a cut on tracks, are read with a stride of zero. The type of the values of each variable is
+   * resolved once before the loop over the channels (see Values).
+   * @tparam I index sequence
+   * @param n number of channels
+   * @param selection selection of the channels.
+   */
+  template<std::size_t... I>
+  void CheckAllImpl(const std::size_t n, std::uint64_t *selection, std::index_sequence<I...>) const {
+    const std::array<std::size_t, sizeof...(T)> strides{{(variables_[I].GetLength() > 1 ? 1u : 0u)...}};
+    const std::array<const double *, sizeof...(T)> values{{Values(I, strides[I] ? n : 1)...}};
+    for (std::size_t first = 0, iword = 0; first < n; first += Selection::kBitsPerWord, ++iword) {
+      if (!selection[iword]) continue;
+      const auto last = std::min(n, first + Selection::kBitsPerWord);
+      std::uint64_t passed = 0;
+      for (std::size_t i = first; i < last; ++i) {
+        passed |= static_cast<std::uint64_t>(lambda_(values[I][i*strides[I]]...)) << (i - first);
+      }
+      selection[iword] &= passed;
+    }
+  }
+  /**
+   * Returns the values of a variable as double.
+   * Double values are read in place. Float and int values are converted into the buffer of the variable.
+   * @param ivar index of the variable
+   * @param length number of values which are read.
+   * @return pointer to the first value. Valid until the next call.
+   */
+  const double *Values(const std::size_t ivar, const std::size_t length) const {
+    const auto &variable = variables_[ivar];
+    if (auto values = variable.template Data<double>()) return values;
+    auto &buffer = buffers_[ivar];
+    buffer.resize(length);
+    if (auto values = variable.template Data<float>()) {
+      std::copy(values, values + length, buffer.begin());
+    } else if (auto values = variable.template Data<int>()) {
+      std::copy(values, values + length, buffer.begin());
+    }
+    return buffer.data();
   }
   std::array<VAR, sizeof...(T)> variables_; /// array of the variables used in the cut.
-  std::function<bool(T...)> lambda_; /// function used to evaluate the cut.
+  FUNC lambda_; /// function used to evaluate the cut.
   std::string name_;
+  mutable std::array<std::vector<double>, sizeof...(T)> buffers_; //!<! converted values of float and int variables
 };
 
 namespace Details {
 template<typename T, std::size_t>
 using CutDataType = T &;
 template<typename T,typename VAR, std::size_t N, typename FUNC, std::size_t... Is>
-std::unique_ptr<Cut<VAR, CutDataType<T, Is>...>> MakeUniqueCutImpl(std::index_sequence<Is...>,
-                                                                   VAR (&arr)[N],
-                                                                   FUNC &&func, std::string name) {
-  return std::make_unique<Cut<VAR, CutDataType<T, Is>...>>(arr, std::forward<FUNC>(func), name);
+std::unique_ptr<Cut<VAR, std::decay_t<FUNC>, CutDataType<T, Is>...>> MakeUniqueCutImpl(std::index_sequence<Is...>,
+                                                                                       VAR (&arr)[N],
+                                                                                       FUNC &&func,
+                                                                                       std::string name) {
+  return std::make_unique<Cut<VAR, std::decay_t<FUNC>, CutDataType<T, Is>...>>(arr, std::forward<FUNC>(func), name);
 }
 }
 
@@ -0,0 +1,131 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_FLATQVECTORS_H
+#define FLOW_FLATQVECTORS_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TTree.h"
+#include "TMap.h"
+
+#include "QVector.h"
+#include "DataContainer.h"
+
+namespace Qn {
+/**
+ * @class FlatQVectors
+ * @brief Flat columnar layout of a DataContainerQVector.
+ * The x and y components of each harmonic, the sum of weights and the number of contributors are stored in separate
+ * fixed size arrays with one entry per bin of the container. They are written to the branches
+ * "<name>_x<harmonic>", "<name>_y<harmonic>", "<name>_sumweights" and "<name>_n".
+ * Axes, harmonics and normalization do not change from event to event. They are saved once per tree
+ * as a prototype container in the user info of the tree or once per RNTuple next to it in the file.
+ */
+class FlatQVectors {
+ public:
+  static constexpr auto kPrototypesName = "QVectorPrototypes";
+
+  FlatQVectors() = default;
+  /**
+   * Constructor
+   * @param name name of the Q-vector used as prefix of the branch names.
+   * @param prototype container with the axes of the Q-vector.
+   * @param harmonics activated harmonics of the Q-vector.
+   */
+  FlatQVectors(std::string name, const DataContainerQVector &prototype, std::bitset<QVector::kmaxharmonics> harmonics);
+  /// The branches and fields of the outputs point to the arrays, so the Q-vectors are not copied.
+  FlatQVectors(const FlatQVectors &) = delete;
+  FlatQVectors &operator=(const FlatQVectors &) = delete;
+  FlatQVectors(FlatQVectors &&) = default;
+  FlatQVectors &operator=(FlatQVectors &&) = default;
+  ~FlatQVectors() = default;
+
+  /**
+   * Creates the branches in the tree and adds a copy of the prototype to the user info of the tree.
+   * @param tree output tree. The arrays need to stay at their position in memory as long as the tree is filled.
+   */
+  void AttachToTree(TTree *tree);
+
+  /**
+   * Copies the Q-vectors of the current event into the flat arrays.
+   * @param q_vectors Q-vectors of the current event
+   */
+  void Fill(const DataContainerQVector &q_vectors);
+
+  std::string GetName() const { return name_; }
+  const std::vector<unsigned int> &GetHarmonics() const { return harmonics_; }
+  const std::vector<float> &GetX(std::size_t i_harmonic) const { return x_[i_harmonic]; }
+  const std::vector<float> &GetY(std::size_t i_harmonic) const { return y_[i_harmonic]; }
+  const std::vector<float> &GetSumWeights() const { return sum_weights_; }
+  const std::vector<Int_t> &GetN() const { return n_; }
+  const DataContainerQVector &GetPrototype() const { return *prototype_; }
+  /**
+   * Creates a copy of the prototype for an output, e.g. the prototype map of an RNTuple.
+   * The copy receives the harmonics and normalization of the first filled event.
+   * @return copy of the prototype. Ownership is passed to the output, which has to live as long as the Q-vectors
+   * are filled.
+   */
+  DataContainerQVector *CreateOutputPrototype();
+
+  /**
+   * Returns the names of the branches in the order expected when reading the Q-vectors:
+   * sumweights, n, followed by x and y of each harmonic.
+   * @param name name of the Q-vector
+   * @param prototype prototype of the Q-vector saved in the tree.
+   * @return vector of branch names
+   */
+  static std::vector<std::string> GetBranchNames(const std::string &name, const DataContainerQVector &prototype);
+
+  /**
+   * Returns the activated harmonics of a prototype.
+   * @param prototype prototype of the Q-vector saved in the tree.
+   * @return vector of the harmonics. Empty if the prototype has no bins.
+   */
+  static std::vector<unsigned int> GetHarmonics(const DataContainerQVector &prototype);
+
+  /**
+   * Reads the prototypes of all Q-vectors saved in the flat layout.
+   * @param tree tree containing the Q-vectors. The prototypes are owned by the tree.
+   * @return map of the prototypes. The key is the name of the Q-vector.
+   */
+  static std::map<std::string, const DataContainerQVector *> ReadPrototypes(TTree *tree);
+
+  /**
+   * Reads the prototypes of all Q-vectors saved in the flat layout.
+   * @param prototypes map of the prototypes as written to the file. It keeps ownership of the prototypes.
+   * @return map of the prototypes. The key is the name of the Q-vector.
+   */
+  static std::map<std::string, const DataContainerQVector *> ReadPrototypes(TMap *prototypes);
+
+ private:
+  std::string name_; ///< name of the Q-vector
+  std::vector<unsigned int> harmonics_; ///< activated harmonics
+  std::vector<std::vector<float>> x_; ///< x components [harmonic][bin]
+  std::vector<std::vector<float>> y_; ///< y components [harmonic][bin]
+  std::vector<float> sum_weights_; ///< sum of weights [bin]
+  std::vector<Int_t> n_; ///< number of contributors [bin]
+  std::unique_ptr<DataContainerQVector> prototype_; ///< prototype of the Q-vector
+  std::vector<DataContainerQVector *> output_prototypes_; ///< copies of the prototype. Owned by the outputs.
+  bool prototype_filled_ = false; ///< true after the prototypes received the harmonics and normalization.
+};
+}
+
+#endif //FLOW_FLATQVECTORS_H
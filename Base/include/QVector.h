@@ -295,6 +295,18 @@ class QVector {
     sum_weights_ = other.sum_weights_;
   }
 
+  /**
+   * Sets the number of contributors and the sum of weights.
+   * This is used when the Q-vector is read from the flat output layout.
+   * @param n number of contributors
+   * @param sum_weights sum of weights
+   */
+  void SetNumberOfContributors(const int n, const float sum_weights) {
+    n_ = n;
+    sum_weights_ = sum_weights;
+    quality_ = 0 < n_;
+  }
+
   /**
    * Gets the first harmonic.
    * @return first harmonic number. Returns 0 if none are found.
@@ -34,6 +34,7 @@
 #include "ROOT/RMakeUnique.hxx"
 #include "CorrectionAxisSet.h"
 #include "Alignment.h"
+#include "CorrectionParameterFile.h"
 #include "DetectorList.h"
 
 /// \cond CLASSIMP
@@ -101,6 +102,51 @@ void Alignment::CreateCorrectionHistograms() {
 void Alignment::AttachInput(TList *list) {
   if (fInputHistograms->AttachHistograms(list)) {
     fState = State::APPLYCOLLECT;
+    FreezeInput();
+  }
+}
+
+/// Attaches the frozen correction parameters to the correction step
+/// \param parameters file containing the correction parameter tables
+/// \param run name of the current run
+///
+/// The table is only used if it matches the event classes and the harmonics of the step.
+void Alignment::AttachInput(const CorrectionParameterFile &parameters, const std::string &run) {
+  if (parameters.Read(run, fSubEvent->GetName(), GetName(), fCalibrationHistograms->GetNoOfBins(), 3,
+                      QVector::kmaxharmonics + 1, fSubEvent->GetHarmonics().to_ullong(), fParameters)) {
+    fState = State::APPLYCOLLECT;
+  }
+}
+
+/// Freezes the calibration information into the table of correction parameters
+///
+/// For each validated event class bin and harmonic the rotation is stored
+/// as its cosine and sine together with the significance of the correction.
+void Alignment::FreezeInput() {
+  auto nNoOfHarmonics = fSubEvent->GetNoOfHarmonics();
+  std::vector<Int_t> harmonicsMap(nNoOfHarmonics);
+  fSubEvent->GetHarmonicMap(harmonicsMap.data());
+  auto nNoOfBins = fInputHistograms->GetNoOfBins();
+  fParameters.Reset(nNoOfBins, 3);
+  fParameters.SetHarmonics(fSubEvent->GetHarmonics().to_ullong());
+  for (Long64_t bin = 0; bin < nNoOfBins; ++bin) {
+    if (!fInputHistograms->BinContentValidated(bin)) continue;
+    fParameters.SetValidated(bin);
+    Double_t XX = fInputHistograms->GetXXBinContent(bin);
+    Double_t YY = fInputHistograms->GetYYBinContent(bin);
+    Double_t XY = fInputHistograms->GetXYBinContent(bin);
+    Double_t YX = fInputHistograms->GetYXBinContent(bin);
+    Double_t eXY = fInputHistograms->GetXYBinError(bin);
+    Double_t eYX = fInputHistograms->GetYXBinError(bin);
+    Double_t deltaPhi = -TMath::ATan2((XY - YX), (XX + YY))*(1.0/fHarmonicForAlignment);
+    /* significant correction? */
+    Bool_t significant = !(TMath::Sqrt((XY - YX)*(XY - YX)/(eXY*eXY + eYX*eYX)) < 2.0);
+    for (auto harmonic : harmonicsMap) {
+      auto parameters = fParameters.Parameters(bin, harmonic);
+      parameters[0] = TMath::Cos(((Double_t) harmonic)*deltaPhi);
+      parameters[1] = TMath::Sin(((Double_t) harmonic)*deltaPhi);
+      parameters[2] = significant;
+    }
   }
 }
 
@@ -133,12 +179,25 @@ void Alignment::AttachNveQAHistograms(TList *list) {
   fQANotValidatedBin->CreateHistogram(list);
 }
 
+/// Fills the non validated entries QA histograms
+///
+/// The events without validated calibration are counted per event class
+/// bin in the table of correction parameters. The counters are transferred
+/// to the histogram and restarted.
+void Alignment::FillNveQAHistograms() {
+  if (fQANotValidatedBin) {
+    fQANotValidatedBin->FillCounts(fParameters.GetFailures());
+    fParameters.ResetFailures();
+  }
+}
+
 /// Processes the correction step
 ///
 /// Apply the correction step
 /// \return kTRUE if the correction step was applied
 bool Alignment::ProcessCorrections() {
   bool applied = false;
+  Long64_t bin = -1;
   switch (fState) {
     case State::CALIBRATION:
       /* collect the data needed to further produce correction parameters if both current Qn vectors are good enough */
@@ -153,47 +212,7 @@ bool Alignment::ProcessCorrections() {
 //      QnCorrectionsInfo(Form("Alignment process in detector %s with reference %s: applying correction.",
 //                             fDetector->GetName(),
 //                             fDetectorConfigurationForAlignment->GetName()));
-      if (fSubEvent->GetCurrentQnVector()->IsGoodQuality()) {
-        /* we get the properties of the current Qn vector but its name */
-        fCorrectedQnVector->CopyNumberOfContributors(*fSubEvent->GetCurrentQnVector());
-        /* let's check the correction histograms */
-        Long64_t bin = fInputHistograms->GetBin();
-        if (fInputHistograms->BinContentValidated(bin)) {
-          /* the bin content is validated so, apply the correction */
-          Double_t XX = fInputHistograms->GetXXBinContent(bin);
-          Double_t YY = fInputHistograms->GetYYBinContent(bin);
-          Double_t XY = fInputHistograms->GetXYBinContent(bin);
-          Double_t YX = fInputHistograms->GetYXBinContent(bin);
-          Double_t eXY = fInputHistograms->GetXYBinError(bin);
-          Double_t eYX = fInputHistograms->GetYXBinError(bin);
-          Double_t deltaPhi = -TMath::ATan2((XY - YX), (XX + YY))*(1.0/fHarmonicForAlignment);
-          /* significant correction? */
-          if (!(TMath::Sqrt((XY - YX)*(XY - YX)/(eXY*eXY + eYX*eYX)) < 2.0)) {
-            Int_t harmonic = fSubEvent->GetCurrentQnVector()->GetFirstHarmonic();
-            while (harmonic!=-1) {
-              fCorrectedQnVector->SetX(harmonic,
-                                       fSubEvent->GetCurrentQnVector()->x(harmonic)
-                                           *TMath::Cos(((Double_t) harmonic)*deltaPhi)
-                                           + fSubEvent->GetCurrentQnVector()->y(harmonic)
-                                               *TMath::Sin(((Double_t) harmonic)*deltaPhi));
-              fCorrectedQnVector->SetY(harmonic,
-                                       fSubEvent->GetCurrentQnVector()->y(harmonic)
-                                           *TMath::Cos(((Double_t) harmonic)*deltaPhi)
-                                           - fSubEvent->GetCurrentQnVector()->x(harmonic)
-                                               *TMath::Sin(((Double_t) harmonic)*deltaPhi));
-              harmonic = fSubEvent->GetCurrentQnVector()->GetNextHarmonic(harmonic);
-            }
-          } /* if the correction is not significant we leave the Q vector untouched */
-        } /* if the correction bin is not validated we leave the Q vector untouched */
-        else {
-          if (fQANotValidatedBin) fQANotValidatedBin->Fill(1.0);
-        }
-      } else {
-        /* not done! input Q vector with bad quality */
-        fCorrectedQnVector->SetGood(kFALSE);
-      }
-      /* and update the current Qn vector */
-      fSubEvent->UpdateCurrentQnVector(*fCorrectedQnVector);
+      ApplyCorrection(bin);
       applied = true;
       break;
     case State::PASSIVE:
@@ -203,6 +222,98 @@ bool Alignment::ProcessCorrections() {
   return applied;
 }
 
+/// Processes the correction step of all sub-events of a detector
+///
+/// The sub-events of a detector share the event class variables, so
+/// the bin of the correction parameters is looked up once for all of them.
+/// The harmonics of all sub-events with a good quality Qn vector and a validated,
+/// significant correction are gathered with their row of the parameter table and
+/// rotated in one loop. The results are scattered back to the corrected Qn vectors.
+/// \param steps the alignment step of each sub-event
+/// \param n the number of sub-events
+/// \param applied per sub-event, true if the previous correction steps were applied
+void Alignment::ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied) {
+  Long64_t bin = -1;
+  fBatch.Reset(3);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!applied[i]) continue;
+    auto step = static_cast<Alignment *>(steps[i]);
+    if (step->fState!=State::APPLY && step->fState!=State::APPLYCOLLECT) {
+      applied[i] = kFALSE;
+      continue;
+    }
+    auto input = step->fSubEvent->GetCurrentQnVector();
+    if (!input->IsGoodQuality()) {
+      /* not done! input Q vector with bad quality */
+      step->fCorrectedQnVector->SetGood(kFALSE);
+      continue;
+    }
+    step->fCorrectedQnVector->CopyNumberOfContributors(*input);
+    if (bin < 0) bin = step->fCalibrationHistograms->GetBin();
+    if (!step->fParameters.Validated(bin)) {
+      /* if the correction bin is not validated we leave the Q vector untouched */
+      if (step->fQANotValidatedBin) step->fParameters.CountFailure(bin);
+      continue;
+    }
+    auto harmonic = input->GetFirstHarmonic();
+    /* if the correction is not significant we leave the Q vector untouched */
+    if (harmonic==-1 || step->fParameters.Parameters(bin, harmonic)[2]==0.0) continue;
+    for (; harmonic!=-1; harmonic = input->GetNextHarmonic(harmonic)) {
+      fBatch.Add(i, harmonic, input->x(harmonic), input->y(harmonic), step->fParameters.Parameters(bin, harmonic));
+    }
+  }
+  CorrectionKernels::Align(fBatch.size(), fBatch.Parameters(), fBatch.X(), fBatch.Y());
+  for (std::size_t row = 0; row < fBatch.size(); ++row) {
+    auto step = static_cast<Alignment *>(steps[fBatch.Owner(row)]);
+    step->fCorrectedQnVector->SetX(fBatch.Harmonic(row), fBatch.X()[row]);
+    step->fCorrectedQnVector->SetY(fBatch.Harmonic(row), fBatch.Y()[row]);
+  }
+  /* and update the current Qn vectors */
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!applied[i]) continue;
+    auto step = static_cast<Alignment *>(steps[i]);
+    step->fSubEvent->UpdateCurrentQnVector(*step->fCorrectedQnVector);
+  }
+}
+
+/// Applies the correction to the current Qn vector
+///
+/// \param bin the bin of the correction parameters for the current event class.
+/// If negative it is looked up in the calibration histograms when needed and returned.
+void Alignment::ApplyCorrection(Long64_t &bin) {
+  if (fSubEvent->GetCurrentQnVector()->IsGoodQuality()) {
+    /* we get the properties of the current Qn vector but its name */
+    fCorrectedQnVector->CopyNumberOfContributors(*fSubEvent->GetCurrentQnVector());
+    /* let's check the correction histograms */
+    /* the calibration histograms share the binning of the input histograms and are */
+    /* also available when the parameters are read from a correction parameter file */
+    if (bin < 0) bin = fCalibrationHistograms->GetBin();
+    if (fParameters.Validated(bin)) {
+      /* the bin content is validated so, apply the correction */
+      Int_t harmonic = fSubEvent->GetCurrentQnVector()->GetFirstHarmonic();
+      /* significant correction? */
+      if (harmonic!=-1 && fParameters.Parameters(bin, harmonic)[2]!=0.0) {
+        while (harmonic!=-1) {
+          auto parameters = fParameters.Parameters(bin, harmonic);
+          Double_t x = fSubEvent->GetCurrentQnVector()->x(harmonic);
+          Double_t y = fSubEvent->GetCurrentQnVector()->y(harmonic);
+          fCorrectedQnVector->SetX(harmonic, x*parameters[0] + y*parameters[1]);
+          fCorrectedQnVector->SetY(harmonic, y*parameters[0] - x*parameters[1]);
+          harmonic = fSubEvent->GetCurrentQnVector()->GetNextHarmonic(harmonic);
+        }
+      } /* if the correction is not significant we leave the Q vector untouched */
+    } /* if the correction bin is not validated we leave the Q vector untouched */
+    else {
+      if (fQANotValidatedBin) fParameters.CountFailure(bin);
+    }
+  } else {
+    /* not done! input Q vector with bad quality */
+    fCorrectedQnVector->SetGood(kFALSE);
+  }
+  /* and update the current Qn vector */
+  fSubEvent->UpdateCurrentQnVector(*fCorrectedQnVector);
+}
+
 /// Processes the correction step data collection
 ///
 /// Collect data for the correction step.
@@ -0,0 +1,431 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "THn.h"
+
+#include "CalibrationAccumulators.h"
+
+namespace Qn {
+
+namespace {
+constexpr char kMagic[8] = {'Q', 'n', 'C', 'a', 'l', 'A', 'c', 'c'};
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t n_accumulators;
+};
+
+struct Record {
+  std::uint64_t path;
+  std::uint64_t title;
+  std::uint64_t axes;
+  std::uint32_t n_axes;
+  char type;
+  char padding[3];
+  std::int64_t n_bins;
+  double entries;
+  std::uint64_t sum;
+  std::uint64_t sum2;
+};
+
+struct AxisRecord {
+  std::uint64_t name;
+  std::uint64_t title;
+  std::int32_t n_bins;
+  std::uint32_t variable;
+  std::uint64_t edges;
+};
+
+static_assert(sizeof(Header)==16, "Unexpected size of the accumulator file header.");
+static_assert(sizeof(Record)==64, "Unexpected size of the accumulator file index record.");
+static_assert(sizeof(AxisRecord)==32, "Unexpected size of the accumulator file axis record.");
+
+std::uint64_t Align(std::uint64_t offset) { return (offset + 7) & ~std::uint64_t(7); }
+
+/**
+ * Read-only mapping of a file into memory. The mapping is released when it goes out of scope.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &file_name) {
+    auto descriptor = ::open(file_name.data(), O_RDONLY);
+    if (descriptor < 0) throw std::runtime_error("Cannot open the accumulator file " + file_name + ".");
+    struct stat status{};
+    if (::fstat(descriptor, &status)!=0 || static_cast<std::size_t>(status.st_size) < sizeof(Header)) {
+      ::close(descriptor);
+      throw std::runtime_error(file_name + " is not an accumulator file.");
+    }
+    auto mapping = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (mapping==MAP_FAILED) throw std::runtime_error("Cannot map the accumulator file " + file_name + ".");
+    data_ = static_cast<const char *>(mapping);
+    size_ = status.st_size;
+  }
+  ~MappedFile() { ::munmap(const_cast<char *>(data_), size_); }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  const char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+  /**
+   * Checks if an array of n elements of type T starting at the offset lies inside the file and is aligned.
+   */
+  template<typename T>
+  bool Contains(std::uint64_t offset, std::uint64_t n) const {
+    return offset%alignof(T)==0 && offset <= size_ && n <= (size_ - offset)/sizeof(T);
+  }
+  std::string ReadName(std::uint64_t offset) const {
+    return std::string(data_ + offset, strnlen(data_ + offset, size_ - offset));
+  }
+ private:
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+char GetType(const THn *histogram) {
+  if (dynamic_cast<const THnF *>(histogram)) return 'F';
+  if (dynamic_cast<const THnD *>(histogram)) return 'D';
+  if (dynamic_cast<const THnI *>(histogram)) return 'I';
+  if (dynamic_cast<const THnL *>(histogram)) return 'L';
+  if (dynamic_cast<const THnS *>(histogram)) return 'S';
+  if (dynamic_cast<const THnC *>(histogram)) return 'C';
+  throw std::runtime_error(std::string("The type of the histogram ") + histogram->GetName() + " is not supported.");
+}
+}
+
+void CalibrationAccumulators::Add(const TList *list, const std::string &path) {
+  for (auto object : *list) {
+    const auto name = path.empty() ? std::string(object->GetName()) : path + "/" + object->GetName();
+    if (auto sub_list = dynamic_cast<const TList *>(object)) {
+      Add(sub_list, name);
+      continue;
+    }
+    auto histogram = dynamic_cast<const THn *>(object);
+    if (!histogram) throw std::runtime_error(name + " is not a dense histogram and cannot be accumulated.");
+    Accumulator accumulator;
+    accumulator.path = name;
+    accumulator.title = histogram->GetTitle();
+    accumulator.type = GetType(histogram);
+    for (Int_t dimension = 0; dimension < histogram->GetNdimensions(); ++dimension) {
+      auto axis = histogram->GetAxis(dimension);
+      Axis binning;
+      binning.name = axis->GetName();
+      binning.title = axis->GetTitle();
+      binning.variable = axis->IsVariableBinSize();
+      for (Int_t bin = 1; bin <= axis->GetNbins() + 1; ++bin) {
+        binning.edges.push_back(axis->GetBinLowEdge(bin));
+      }
+      accumulator.axes.push_back(std::move(binning));
+    }
+    accumulator.entries = histogram->GetEntries();
+    const auto n_bins = histogram->GetNbins();
+    accumulator.sum.resize(n_bins);
+    for (Long64_t bin = 0; bin < n_bins; ++bin) {
+      accumulator.sum[bin] = histogram->GetBinContent(bin);
+    }
+    if (histogram->GetCalculateErrors()) {
+      accumulator.sum2.resize(n_bins);
+      for (Long64_t bin = 0; bin < n_bins; ++bin) {
+        accumulator.sum2[bin] = histogram->GetBinError2(bin);
+      }
+    }
+    Insert(std::move(accumulator));
+  }
+}
+
+void CalibrationAccumulators::Add(CalibrationAccumulators other) {
+  for (auto &accumulator : other.accumulators_) {
+    Insert(std::move(accumulator));
+  }
+}
+
+void CalibrationAccumulators::Insert(Accumulator accumulator) {
+  auto position = index_.find(accumulator.path);
+  if (position==index_.end()) {
+    index_.emplace(accumulator.path, accumulators_.size());
+    accumulators_.push_back(std::move(accumulator));
+  } else {
+    AddContent(accumulators_[position->second], accumulator.type, accumulator.axes, accumulator.entries,
+               accumulator.sum.data(), accumulator.sum2.empty() ? nullptr : accumulator.sum2.data());
+  }
+}
+
+void CalibrationAccumulators::AddContent(Accumulator &target, char type, const std::vector<Axis> &axes,
+                                         double entries, const double *sum, const double *sum2) {
+  if (target.type!=type || target.axes!=axes) {
+    throw std::runtime_error("The binning of " + target.path + " differs. It cannot be merged.");
+  }
+  if (target.sum2.empty()!=(sum2==nullptr)) {
+    throw std::runtime_error("The errors of " + target.path + " are not calculated in all inputs.");
+  }
+  target.entries += entries;
+  const auto n_bins = target.sum.size();
+  auto target_sum = target.sum.data();
+  for (std::size_t bin = 0; bin < n_bins; ++bin) {
+    target_sum[bin] += sum[bin];
+  }
+  if (sum2) {
+    auto target_sum2 = target.sum2.data();
+    for (std::size_t bin = 0; bin < n_bins; ++bin) {
+      target_sum2[bin] += sum2[bin];
+    }
+  }
+}
+
+void CalibrationAccumulators::Read(const std::string &file_name) {
+  MappedFile file(file_name);
+  const auto header = reinterpret_cast<const Header *>(file.data());
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic))!=0 || header->version!=kVersion
+      || !file.Contains<Record>(sizeof(Header), header->n_accumulators)) {
+    throw std::runtime_error(file_name + " is not an accumulator file of version " + std::to_string(kVersion) + ".");
+  }
+  const auto corrupted = std::runtime_error(file_name + " is corrupted.");
+  const auto records = reinterpret_cast<const Record *>(file.data() + sizeof(Header));
+  for (std::uint32_t i = 0; i < header->n_accumulators; ++i) {
+    const auto &record = records[i];
+    if (record.path >= file.size() || record.title >= file.size()
+        || !file.Contains<AxisRecord>(record.axes, record.n_axes)) {
+      throw corrupted;
+    }
+    const auto axis_records = reinterpret_cast<const AxisRecord *>(file.data() + record.axes);
+    std::vector<Axis> axes;
+    std::int64_t n_bins = 1;
+    for (std::uint32_t dimension = 0; dimension < record.n_axes; ++dimension) {
+      const auto &axis_record = axis_records[dimension];
+      if (axis_record.name >= file.size() || axis_record.title >= file.size() || axis_record.n_bins < 1
+          || !file.Contains<double>(axis_record.edges, axis_record.n_bins + 1)) {
+        throw corrupted;
+      }
+      const auto edges = reinterpret_cast<const double *>(file.data() + axis_record.edges);
+      Axis axis;
+      axis.name = file.ReadName(axis_record.name);
+      axis.title = file.ReadName(axis_record.title);
+      axis.variable = axis_record.variable!=0;
+      axis.edges.assign(edges, edges + axis_record.n_bins + 1);
+      axes.push_back(std::move(axis));
+      n_bins *= axis_record.n_bins + 2;
+    }
+    if (record.n_bins!=n_bins || !file.Contains<double>(record.sum, n_bins)
+        || (record.sum2!=0 && !file.Contains<double>(record.sum2, n_bins))) {
+      throw corrupted;
+    }
+    const auto sum = reinterpret_cast<const double *>(file.data() + record.sum);
+    const auto sum2 = record.sum2!=0 ? reinterpret_cast<const double *>(file.data() + record.sum2) : nullptr;
+    auto path = file.ReadName(record.path);
+    auto position = index_.find(path);
+    if (position!=index_.end()) {
+      AddContent(accumulators_[position->second], record.type, axes, record.entries, sum, sum2);
+      continue;
+    }
+    Accumulator accumulator;
+    accumulator.path = std::move(path);
+    accumulator.title = file.ReadName(record.title);
+    accumulator.type = record.type;
+    accumulator.axes = std::move(axes);
+    accumulator.entries = record.entries;
+    accumulator.sum.assign(sum, sum + n_bins);
+    if (sum2) accumulator.sum2.assign(sum2, sum2 + n_bins);
+    index_.emplace(accumulator.path, accumulators_.size());
+    accumulators_.push_back(std::move(accumulator));
+  }
+}
+
+void CalibrationAccumulators::Write(const std::string &file_name) const {
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.n_accumulators = accumulators_.size();
+  // first pass computes the layout of the file.
+  std::size_t n_axes = 0;
+  for (const auto &accumulator : accumulators_) {
+    n_axes += accumulator.axes.size();
+  }
+  const std::uint64_t axes_offset = sizeof(Header) + accumulators_.size()*sizeof(Record);
+  const std::uint64_t names_offset = axes_offset + n_axes*sizeof(AxisRecord);
+  std::vector<Record> records;
+  std::vector<AxisRecord> axis_records;
+  std::string names;
+  auto add_name = [&names, names_offset](const std::string &name) {
+    auto offset = names_offset + names.size();
+    names.append(name.data(), name.size() + 1);
+    return offset;
+  };
+  for (const auto &accumulator : accumulators_) {
+    Record record{};
+    record.path = add_name(accumulator.path);
+    record.title = add_name(accumulator.title);
+    record.axes = axes_offset + axis_records.size()*sizeof(AxisRecord);
+    record.n_axes = accumulator.axes.size();
+    record.type = accumulator.type;
+    record.n_bins = accumulator.sum.size();
+    record.entries = accumulator.entries;
+    records.push_back(record);
+    for (const auto &axis : accumulator.axes) {
+      AxisRecord axis_record{};
+      axis_record.name = add_name(axis.name);
+      axis_record.title = add_name(axis.title);
+      axis_record.n_bins = axis.edges.size() - 1;
+      axis_record.variable = axis.variable;
+      axis_records.push_back(axis_record);
+    }
+  }
+  // the arrays of doubles keep the alignment of the data section.
+  auto offset = Align(names_offset + names.size());
+  auto axis_record = axis_records.begin();
+  auto record = records.begin();
+  for (const auto &accumulator : accumulators_) {
+    for (const auto &axis : accumulator.axes) {
+      axis_record->edges = offset;
+      offset += axis.edges.size()*sizeof(double);
+      ++axis_record;
+    }
+    record->sum = offset;
+    offset += accumulator.sum.size()*sizeof(double);
+    if (!accumulator.sum2.empty()) {
+      record->sum2 = offset;
+      offset += accumulator.sum2.size()*sizeof(double);
+    }
+    ++record;
+  }
+  // second pass writes the sections.
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("Cannot open the accumulator file " + file_name + ".");
+  auto write = [&file](const std::vector<double> &array) {
+    file.write(reinterpret_cast<const char *>(array.data()), array.size()*sizeof(double));
+  };
+  file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char *>(records.data()), records.size()*sizeof(Record));
+  file.write(reinterpret_cast<const char *>(axis_records.data()), axis_records.size()*sizeof(AxisRecord));
+  file.write(names.data(), names.size());
+  static const char zeros[8] = {};
+  file.write(zeros, Align(names_offset + names.size()) - (names_offset + names.size()));
+  for (const auto &accumulator : accumulators_) {
+    for (const auto &axis : accumulator.axes) {
+      write(axis.edges);
+    }
+    write(accumulator.sum);
+    write(accumulator.sum2);
+  }
+  if (!file) throw std::runtime_error("Cannot write the accumulator file " + file_name + ".");
+}
+
+THn *CalibrationAccumulators::CreateHistogram(const Accumulator &accumulator, const std::string &name) {
+  const auto n_dimensions = static_cast<Int_t>(accumulator.axes.size());
+  std::vector<Int_t> n_bins;
+  std::vector<Double_t> minimum;
+  std::vector<Double_t> maximum;
+  for (const auto &axis : accumulator.axes) {
+    n_bins.push_back(axis.edges.size() - 1);
+    minimum.push_back(axis.edges.front());
+    maximum.push_back(axis.edges.back());
+  }
+  const auto title = accumulator.title.data();
+  THn *histogram = nullptr;
+  switch (accumulator.type) {
+    case 'F':histogram = new THnF(name.data(), title, n_dimensions, n_bins.data(), minimum.data(), maximum.data());
+      break;
+    case 'D':histogram = new THnD(name.data(), title, n_dimensions, n_bins.data(), minimum.data(), maximum.data());
+      break;
+    case 'I':histogram = new THnI(name.data(), title, n_dimensions, n_bins.data(), minimum.data(), maximum.data());
+      break;
+    case 'L':histogram = new THnL(name.data(), title, n_dimensions, n_bins.data(), minimum.data(), maximum.data());
+      break;
+    case 'S':histogram = new THnS(name.data(), title, n_dimensions, n_bins.data(), minimum.data(), maximum.data());
+      break;
+    case 'C':histogram = new THnC(name.data(), title, n_dimensions, n_bins.data(), minimum.data(), maximum.data());
+      break;
+    default:throw std::runtime_error("The type of the accumulator " + accumulator.path + " is not supported.");
+  }
+  for (Int_t dimension = 0; dimension < n_dimensions; ++dimension) {
+    const auto &binning = accumulator.axes[dimension];
+    auto axis = histogram->GetAxis(dimension);
+    if (binning.variable) axis->Set(n_bins[dimension], binning.edges.data());
+    axis->SetName(binning.name.data());
+    axis->SetTitle(binning.title.data());
+  }
+  if (!accumulator.sum2.empty()) histogram->Sumw2();
+  const auto n = static_cast<Long64_t>(accumulator.sum.size());
+  for (Long64_t bin = 0; bin < n; ++bin) {
+    histogram->SetBinContent(bin, accumulator.sum[bin]);
+  }
+  if (!accumulator.sum2.empty()) {
+    for (Long64_t bin = 0; bin < n; ++bin) {
+      histogram->SetBinError2(bin, accumulator.sum2[bin]);
+    }
+  }
+  histogram->SetEntries(accumulator.entries);
+  return histogram;
+}
+
+std::unique_ptr<TList> CalibrationAccumulators::CreateList() const {
+  auto list = std::make_unique<TList>();
+  list->SetOwner(true);
+  std::map<std::string, TList *> directories;
+  for (const auto &accumulator : accumulators_) {
+    auto parent = list.get();
+    std::string::size_type begin = 0;
+    std::string::size_type end = 0;
+    while ((end = accumulator.path.find('/', begin))!=std::string::npos) {
+      auto &directory = directories[accumulator.path.substr(0, end)];
+      if (!directory) {
+        directory = new TList();
+        directory->SetName(accumulator.path.substr(begin, end - begin).data());
+        directory->SetOwner(true);
+        parent->Add(directory);
+      }
+      parent = directory;
+      begin = end + 1;
+    }
+    parent->Add(CreateHistogram(accumulator, accumulator.path.substr(begin)));
+  }
+  return list;
+}
+
+CalibrationAccumulators CalibrationAccumulators::Merge(const std::vector<std::string> &file_names,
+                                                       unsigned int n_threads) {
+  n_threads = std::max(1u, std::min(n_threads, static_cast<unsigned int>(file_names.size())));
+  std::vector<std::future<CalibrationAccumulators>> partial_results;
+  for (unsigned int thread = 0; thread < n_threads; ++thread) {
+    const auto begin = file_names.size()*thread/n_threads;
+    const auto end = file_names.size()*(thread + 1)/n_threads;
+    partial_results.push_back(std::async(std::launch::async, [&file_names, begin, end]() {
+      CalibrationAccumulators partial;
+      for (auto i = begin; i < end; ++i) {
+        partial.Read(file_names[i]);
+      }
+      return partial;
+    }));
+  }
+  CalibrationAccumulators merged;
+  for (auto &partial : partial_results) {
+    merged.Add(partial.get());
+  }
+  return merged;
+}
+
+}
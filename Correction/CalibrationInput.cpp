@@ -0,0 +1,142 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "TH1.h"
+
+#include "CalibrationInput.h"
+
+namespace Qn {
+
+namespace {
+/**
+ * Detaches the histograms of a list from the directory they were read from.
+ * This keeps them alive when the file is closed.
+ * @param list list of histograms and lists of histograms
+ */
+void DetachFromDirectory(TList *list) {
+  for (auto object : *list) {
+    if (auto sublist = dynamic_cast<TList *>(object)) {
+      DetachFromDirectory(sublist);
+    } else if (auto histogram = dynamic_cast<TH1 *>(object)) {
+      histogram->SetDirectory(nullptr);
+    }
+  }
+}
+}
+
+void CalibrationInput::Open(std::unique_ptr<TFile> file, const std::string &name) {
+  file_ = std::move(file);
+  name_ = name;
+  directory_ = nullptr;
+  all_runs_.reset();
+  runs_.clear();
+  current_run_.clear();
+  if (!file_ || file_->IsZombie()) return;
+  directory_ = file_->GetDirectory(name_.data());
+  if (!directory_) {
+    all_runs_.reset(dynamic_cast<TList *>(file_->FindObjectAny(name_.data())));
+    if (all_runs_) all_runs_->SetOwner(true);
+  }
+}
+
+TList *CalibrationInput::Get(const std::string &run) {
+  if (all_runs_) return dynamic_cast<TList *>(all_runs_->FindObject(run.data()));
+  if (!directory_) return nullptr;
+  // the parameters of the previous run are frozen, so its list is released. Prefetched runs, which were not yet
+  // requested, are kept.
+  if (current_run_!=run) runs_.erase(current_run_);
+  current_run_ = run;
+  auto loaded = runs_.find(run);
+  if (loaded!=runs_.end()) return loaded->second.get();
+  std::unique_ptr<TList> list;
+  if (prefetched_.valid() && prefetched_run_==run) {
+    list = prefetched_.get();
+  } else {
+    list = ReadRun(directory_, run);
+  }
+  auto list_ptr = list.get();
+  runs_.emplace(run, std::move(list));
+  return list_ptr;
+}
+
+std::unique_ptr<TList> CalibrationInput::Read(const std::string &run) const {
+  std::unique_ptr<TList> list;
+  if (all_runs_) {
+    if (auto found = all_runs_->FindObject(run.data())) {
+      list.reset(static_cast<TList *>(found->Clone()));
+      list->SetOwner(true);
+    }
+  } else if (directory_) {
+    list = ReadRun(directory_, run);
+  }
+  return list;
+}
+
+std::vector<std::string> CalibrationInput::GetRunNames() const {
+  std::vector<std::string> runs;
+  if (all_runs_) {
+    for (auto run : *all_runs_) runs.emplace_back(run->GetName());
+  } else if (directory_) {
+    for (auto key : *directory_->GetListOfKeys()) {
+      // keys with several cycles are listed once.
+      if (std::find(runs.begin(), runs.end(), key->GetName())==runs.end()) runs.emplace_back(key->GetName());
+    }
+  }
+  return runs;
+}
+
+void CalibrationInput::Prefetch(const std::string &run) {
+  if (!directory_ || runs_.find(run)!=runs_.end()) return;
+  if (prefetched_.valid()) {
+    if (prefetched_run_==run) return;
+    // keeps the previously prefetched run instead of discarding it.
+    runs_.emplace(prefetched_run_, prefetched_.get());
+  }
+  prefetched_run_ = run;
+  prefetched_ = std::async(std::launch::async, [file_name = std::string(file_->GetName()), name = name_, run]() {
+    std::unique_ptr<TList> list;
+    std::unique_ptr<TFile> file(TFile::Open(file_name.data(), "READ"));
+    if (file && !file->IsZombie()) {
+      auto directory = file->GetDirectory(name.data());
+      if (directory) list = ReadRun(directory, run);
+    }
+    return list;
+  });
+}
+
+void CalibrationInput::Write(TList *corrections, TDirectory *directory, const std::string &name) {
+  auto index = directory->GetDirectory(name.data());
+  if (!index) index = directory->mkdir(name.data());
+  if (!index) throw std::runtime_error("Cannot create the calibration directory " + name + ".");
+  for (auto run : *corrections) {
+    index->WriteTObject(run, run->GetName(), "Overwrite");
+  }
+}
+
+std::unique_ptr<TList> CalibrationInput::ReadRun(TDirectory *directory, const std::string &run) {
+  std::unique_ptr<TList> list(dynamic_cast<TList *>(directory->Get(run.data())));
+  if (list) {
+    list->SetOwner(true);
+    DetachFromDirectory(list.get());
+  }
+  return list;
+}
+
+}
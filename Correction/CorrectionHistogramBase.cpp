@@ -1,7 +1,15 @@
 /// file QnCorrectionsHistogramBase.cxx
 /// \brief Implementation of the multidimensional profile base class
+#include <algorithm>
 #include <utility>
+#include <vector>
+#include "RConfigure.h"
 #include "TList.h"
+#include "TROOT.h"
+#ifdef R__USE_IMT
+#include "ROOT/TSeq.hxx"
+#include "ROOT/TThreadExecutor.hxx"
+#endif
 #include "CorrectionHistogramBase.h"
 
 namespace Qn {
@@ -16,6 +24,7 @@ const char *CorrectionHistogramBase::szXYCorrelationComponentSuffix = "XY";
 const char *CorrectionHistogramBase::szYXCorrelationComponentSuffix = "YX";
 const char *CorrectionHistogramBase::szYYCorrelationComponentSuffix = "YY";
 const Int_t CorrectionHistogramBase::nMaxHarmonicNumberSupported = 15;
+const Long64_t CorrectionHistogramBase::nMinNoOfBinsForParallelDivision = 1 << 16;
 const UInt_t CorrectionHistogramBase::harmonicNumberMask[] =
     {0x0000, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080,
      0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000};
@@ -72,87 +81,124 @@ CorrectionHistogramBase::CorrectionHistogramBase(std::string name,
 /// Creates a value / error multidimensional histogram from
 /// a values and entries multidimensional histograms.
 /// The validation histogram is filled according to entries threshold value.
+///
+/// The division runs directly on the bin arrays of the histograms.
+/// Large histograms are split in chunks which are divided in parallel
+/// if implicit multithreading is enabled.
 /// \param hValues the values multidimensional histogram
 /// \param hEntries the entries multidimensional histogram
 /// \param hValid optional multidimensional histogram where validation information is stored
 /// \return the values / error multidimensional histogram
 THnF *CorrectionHistogramBase::DivideTHnF(THnF *hValues, THnI *hEntries, THnC *hValid) {
   THnF *hResult = (THnF *) THn::CreateHn(hValues->GetName(), hValues->GetTitle(), hValues);
-  Double_t value, error2;
-  Int_t nEntries;
-  Int_t nNotValidatedBins = 0;
-  for (Long64_t bin = 0; bin < hResult->GetNbins(); bin++) {
-    value = hValues->GetBinContent(bin);
-    nEntries = Int_t(hEntries->GetBinContent(bin));
-    error2 = hValues->GetBinError2(bin);
-    if (nEntries < fMinNoOfEntriesToValidate) {
-      /* bin content not validated */
-      hResult->SetBinContent(bin, 0.0);
-      hResult->SetBinError(bin, 0.0);
-      if (hValid) hValid->SetBinContent(bin, 0.0);
-      if (value!=0.0) {
-        nNotValidatedBins++;
-      }
-    } else {
-      Double_t average = value/nEntries;
-      Double_t serror = TMath::Sqrt(TMath::Abs(error2/nEntries - average*average));
-      switch (fErrorMode) {
-        case ErrorMode::MEAN:
-          /* standard error on the mean of the bin values */
-          hResult->SetBinContent(bin, average);
-          hResult->SetBinError(bin, serror/TMath::Sqrt(nEntries));
-          break;
-        case ErrorMode::SPREAD:
-          /* standard deviation of the bin values */
-          hResult->SetBinContent(bin, average);
-          hResult->SetBinError(bin, serror);
-          break;
+  /* allocate the bin storage before the bins are visited concurrently */
+  hResult->SetBinContent(0, 0.0);
+  hResult->SetBinError2(0, 0.0);
+  if (hValid) hValid->SetBinContent(0, 0.0);
+  const auto &values = static_cast<const TNDArrayT<Float_t> &>(static_cast<const THnF *>(hValues)->GetArray());
+  const auto &entries = static_cast<const TNDArrayT<Int_t> &>(static_cast<const THnI *>(hEntries)->GetArray());
+  auto &result = static_cast<TNDArrayT<Float_t> &>(hResult->GetArray());
+  auto valid = hValid ? &static_cast<TNDArrayT<Char_t> &>(hValid->GetArray()) : nullptr;
+  const Bool_t errorOnMean = fErrorMode==ErrorMode::MEAN;
+  const Int_t minNoOfEntries = fMinNoOfEntriesToValidate;
+  auto divide = [&](Long64_t first, Long64_t last) {
+    for (Long64_t bin = first; bin < last; bin++) {
+      Int_t nEntries = entries.At(bin);
+      if (nEntries < minNoOfEntries) {
+        /* bin content not validated */
+        result.At(bin) = 0.0;
+        hResult->SetBinError2(bin, 0.0);
+        if (valid) valid->At(bin) = 0;
+      } else {
+        Double_t average = values.At(bin)/nEntries;
+        Double_t serror = TMath::Sqrt(TMath::Abs(hValues->GetBinError2(bin)/nEntries - average*average));
+        result.At(bin) = average;
+        /* standard error on the mean or standard deviation of the bin values */
+        Double_t error = errorOnMean ? serror/TMath::Sqrt(nEntries) : serror;
+        hResult->SetBinError2(bin, error*error);
+        if (valid) valid->At(bin) = 1;
       }
-      if (hValid!=nullptr) hValid->SetBinContent(bin, 1.0);
     }
-    hResult->SetEntries(hValues->GetEntries());
+  };
+  const Long64_t nBins = hResult->GetNbins();
+#ifdef R__USE_IMT
+  if (ROOT::IsImplicitMTEnabled() && nBins >= nMinNoOfBinsForParallelDivision) {
+    const UInt_t nChunks = ROOT::GetImplicitMTPoolSize();
+    const Long64_t chunkSize = (nBins + nChunks - 1)/nChunks;
+    ROOT::TThreadExecutor executor;
+    executor.Foreach([&](UInt_t chunk) {
+      divide(chunk*chunkSize, std::min(nBins, (chunk + 1)*chunkSize));
+    }, ROOT::TSeqU(nChunks));
+  } else {
+    divide(0, nBins);
   }
+#else
+  divide(0, nBins);
+#endif
+  hResult->SetEntries(hValues->GetEntries());
   return hResult;
 }
 
-/// Starts the copy of two THnF histograms.
+/// Copies a THnF histogram into a THnF histogram with an additional dimension.
 ///
 /// Source should not have channel/group structure (axis)
 /// while dest should. The channel/group involved in dest
 /// should be stored in binsArray[nVariables].
+/// The bins of all event class variables are visited
+/// iteratively and the corresponding bins are copied.
 /// \param hDest the histogram that will receive the copy
 /// \param hSource the histogram to copy
 /// \param binsArray the array to build the bin numbers on each dimension
 void CorrectionHistogramBase::CopyTHnF(THnF *hDest, THnF *hSource, Int_t *binsArray) {
-  CopyTHnFDimension(hDest, hSource, binsArray, 0);
+  const Int_t nVariables = fEventClassVariables.GetSize();
+  std::vector<Int_t> nBins(nVariables);
+  for (Int_t var = 0; var < nVariables; var++) {
+    nBins[var] = hSource->GetAxis(var)->GetNbins();
+    if (nBins[var] < 1) return;
+    binsArray[var] = 1;
+  }
+  while (true) {
+    Long64_t sourceBin = hSource->GetBin(binsArray);
+    Long64_t destBin = hDest->GetBin(binsArray);
+    hDest->SetBinContent(destBin, hSource->GetBinContent(sourceBin));
+    hDest->SetBinError2(destBin, hSource->GetBinError2(sourceBin));
+    /* move to the next bin, the last variable runs fastest */
+    Int_t var = nVariables - 1;
+    while (var >= 0 && binsArray[var]==nBins[var]) {
+      binsArray[var] = 1;
+      var--;
+    }
+    if (var < 0) break;
+    binsArray[var]++;
+  }
 }
 
-/// Process a dimension in the copy of two THnF histograms process.
+/// Adds counts accumulated per bin of a dense histogram.
 ///
-/// Source should not have channel/group structure (axis)
-/// while dest should. The channel/group involved in dest
-/// should be stored in binsArray[nVariables].
-/// It is called in a recursive way until the number of
-/// event class variables (dimensions in the source) is
-/// exhausted then, the corresponding bins are copied.
-/// \param hDest the histogram that will receive the copy
-/// \param hSource the histogram to copy
-/// \param binsArray the array to build the bin numbers on each dimension
-/// \param dimension the current dimension being handled
-void CorrectionHistogramBase::CopyTHnFDimension(THnF *hDest, THnF *hSource, Int_t *binsArray, Int_t dimension) {
-  /* are all variables settled */
-  if ((unsigned long) dimension < fEventClassVariables.GetSize()) {
-    /* no then, scan this dimension and move to the next one */
-    for (Long64_t bin = 0; bin < hSource->GetAxis(dimension)->GetNbins(); bin++) {
-      binsArray[dimension] = bin + 1;
-      CopyTHnFDimension(hDest, hSource, binsArray, dimension + 1);
+/// The counts are indexed by the linear bin number of a dense THn with the
+/// same axes as hDest, e.g. the calibration histograms of a correction step.
+/// The linear bin is decomposed into the bins of each axis including under-
+/// and overflow bins, the last axis runs fastest. Each count is added as
+/// entries of weight one.
+/// \param hDest the histogram that will receive the counts
+/// \param counts the number of entries per linear bin of the dense histogram
+void CorrectionHistogramBase::AddDenseBinCounts(THnBase *hDest, const std::vector<Long64_t> &counts) {
+  const Int_t nDimensions = hDest->GetNdimensions();
+  std::vector<Int_t> binsArray(nDimensions);
+  Double_t nEntries = hDest->GetEntries();
+  for (std::size_t bin = 0; bin < counts.size(); ++bin) {
+    if (counts[bin]==0) continue;
+    Long64_t remainder = bin;
+    for (Int_t dim = nDimensions - 1; dim >= 0; --dim) {
+      const Long64_t nBins = hDest->GetAxis(dim)->GetNbins() + 2;
+      binsArray[dim] = remainder%nBins;
+      remainder /= nBins;
     }
-  } else {
-    /* all variables have a new bin configuration, let's do the actual copy */
-    Double_t value = hSource->GetBinContent(binsArray);
-    Double_t error = hSource->GetBinError(binsArray);
-    hDest->SetBinContent(binsArray, value);
-    hDest->SetBinError(binsArray, error);
+    Long64_t destBin = hDest->GetBin(binsArray.data());
+    hDest->AddBinContent(destBin, counts[bin]);
+    hDest->AddBinError2(destBin, counts[bin]);
+    nEntries += counts[bin];
   }
+  hDest->SetEntries(nEntries);
 }
 }
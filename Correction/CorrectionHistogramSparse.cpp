@@ -125,5 +125,16 @@ void CorrectionHistogramSparse::Fill(Float_t weight) {
   fValues->Fill(fBinAxesValues, weight);
   fValues->SetEntries(nEntries + 1);
 }
-}
 
+/// Fills the histogram with the number of entries per bin
+///
+/// The counts are indexed by the bin number of the dense histograms with
+/// the same event class binning, e.g. the calibration histograms.
+/// Used to build the histogram once from counters collected on the fly
+/// instead of filling it for every entry.
+///
+/// \param counts the number of entries per dense bin
+void CorrectionHistogramSparse::FillCounts(const std::vector<Long64_t> &counts) {
+  AddDenseBinCounts(fValues, counts);
+}
+}
@@ -52,7 +52,7 @@
 #pragma link C++ class Qn::Alignment+;
 #pragma link C++ class Qn::Recentering+;
 #pragma link C++ class Qn::TwistAndRescale+;
-#pragma link C++ class Qn::DataContainer<std::unique_ptr<Qn::SubEvent>,Qn::Axis<double>>+;
+#pragma link C++ class Qn::DataContainer<Qn::SubEvent*,Qn::Axis<double>>+;
 #pragma link C++ class Qn::InputVariable+;
 #pragma link C++ class std::map<std::string, InputVariable>+;
 #pragma link C++ class Qn::CorrectionBase+;
@@ -15,21 +15,122 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cstring>
+
 #include "CorrectionManager.h"
 #include "TList.h"
+#include "TROOT.h"
+#include "THnBase.h"
+#include "THn.h"
+#include "THnSparse.h"
 
 namespace Qn {
 
-void CorrectionManager::InitializeCorrections() {
-  // Connects the correction histogram list
-  if (!correction_input_file_) {
-    correction_input_file_ = std::make_unique<TFile>(correction_input_file_name_.data(), "READ");
+namespace {
+/**
+ * Adds the histograms of the source list to the histograms of the target list.
+ * Both lists are created by correction managers with the same configuration. Therefore the objects are matched by
+ * their position in the list. Objects at the same position must have the same name.
+ * @param target list which contains the merged histograms
+ * @param source list which is added to the target list
+ */
+void MergeHistogramLists(TList *target, TList *source) {
+  if (!target || !source) return;
+  if (target->GetSize()!=source->GetSize()) {
+    throw std::logic_error(std::string("Cannot merge list ") + target->GetName() + ". The structure of the slots differs.");
+  }
+  TIter next_target(target);
+  TIter next_source(source);
+  TObject *target_object = nullptr;
+  while ((target_object = next_target())) {
+    auto source_object = next_source();
+    if (std::strcmp(target_object->GetName(), source_object->GetName())!=0) {
+      throw std::logic_error(std::string("Cannot merge ") + source_object->GetName() + " into " +
+          target_object->GetName() + " of list " + target->GetName() + ". The structure of the slots differs.");
+    }
+    if (auto target_list = dynamic_cast<TList *>(target_object)) {
+      MergeHistogramLists(target_list, dynamic_cast<TList *>(source_object));
+      continue;
+    }
+    TList merge_list;
+    merge_list.Add(source_object);
+    if (auto histogram = dynamic_cast<THnBase *>(target_object)) {
+      histogram->Merge(&merge_list);
+    } else if (auto histogram = dynamic_cast<TH1 *>(target_object)) {
+      histogram->Merge(&merge_list);
+    }
+  }
+}
+
+/**
+ * Creates a compact copy of the calibration histograms of a finished run and resets the histograms in place.
+ * The histograms are stored as sparse histograms, which only keep the filled bins.
+ * @param list list of the finished run. It keeps the reset histograms for the next run.
+ * @return compact copy of the list. Ownership is passed to the caller.
+ */
+TList *CompactAndReset(TList *list) {
+  auto compact = new TList();
+  compact->SetName(list->GetName());
+  compact->SetOwner(true);
+  for (auto object : *list) {
+    if (auto sub_list = dynamic_cast<TList *>(object)) {
+      compact->Add(CompactAndReset(sub_list));
+    } else if (auto histogram = dynamic_cast<THnBase *>(object)) {
+      compact->Add(THnSparse::CreateSparse(histogram->GetName(), histogram->GetTitle(), histogram));
+      histogram->Reset();
+    } else {
+      compact->Add(object->Clone());
+    }
   }
-  if (correction_input_file_ && !correction_input_file_->IsZombie()) {
-    auto input = dynamic_cast<TList *>(correction_input_file_->FindObjectAny(kCorrectionListName));
-    correction_input_.reset(input);
-    if (input) correction_input_->SetOwner(true);
+  return compact;
+}
+
+/**
+ * Replaces the sparse histograms in the list by dense histograms of the same type.
+ * @param list list containing the compact copies of a finished run.
+ */
+void ExpandCompactHistograms(TList *list) {
+  for (auto link = list->FirstLink(); link; link = link->Next()) {
+    if (auto sub_list = dynamic_cast<TList *>(link->GetObject())) {
+      ExpandCompactHistograms(sub_list);
+    } else if (auto sparse = dynamic_cast<THnSparse *>(link->GetObject())) {
+      link->SetObject(THn::CreateHn(sparse->GetName(), sparse->GetTitle(), sparse));
+      delete sparse;
+    }
   }
+}
+}
+
+CorrectionManager::CorrectionManager(const CorrectionManager &other) :
+    fill_qa_histos_(other.fill_qa_histos_),
+    fill_validation_qa_histos_(other.fill_validation_qa_histos_),
+    fill_output_in_memory_(other.fill_output_in_memory_),
+    qa_sampling_(other.qa_sampling_),
+    qa_buffer_size_(other.qa_buffer_size_),
+    detectors_(other.detectors_),
+    variable_manager_(other.variable_manager_),
+    correction_axes_(other.correction_axes_),
+    event_cuts_(other.event_cuts_),
+    event_histograms_(other.event_histograms_) {
+}
+
+void CorrectionManager::SetNumberOfSlots(unsigned int n_slots) {
+  if (n_slots==0) {
+    throw std::invalid_argument("The number of slots has to be larger than zero.");
+  }
+  n_slots_ = n_slots;
+}
+
+void CorrectionManager::InitializeSlot() {
+  variable_manager_.Initialize();
+  correction_axes_.Initialize(variable_manager_);
+  event_histograms_.Initialize(variable_manager_);
+  event_histograms_.SetSampling(qa_sampling_);
+  event_histograms_.SetBufferSize(qa_buffer_size_);
+  detectors_.Initialize(detectors_, variable_manager_, correction_axes_);
+  detectors_.SetQASampling(qa_sampling_);
+  detectors_.SetQABufferSize(qa_buffer_size_);
+  event_cuts_.Initialize(variable_manager_);
   // Prepares the correctionsteps
   detectors_.CreateSupportQVectors();
   correction_output = std::make_unique<TList>();
@@ -37,29 +138,82 @@ void CorrectionManager::InitializeCorrections() {
   correction_output->SetOwner(true);
 }
 
+void CorrectionManager::InitializeCorrections() {
+  if (!correction_parameter_file_name_.empty()) {
+    correction_parameters_.Open(correction_parameter_file_name_);
+    return;
+  }
+  // Connects the correction histogram list
+  if (!correction_input_file_) {
+    correction_input_file_ = std::make_unique<TFile>(correction_input_file_name_.data(), "READ");
+  }
+  correction_input_.Open(std::move(correction_input_file_), kCorrectionListName);
+}
+
 void CorrectionManager::SetCurrentRunName(const std::string &name) {
-  runs_.SetCurrentRun(name);
-  TList *current_output = nullptr;
-  if (!runs_.empty()) {
-    current_output = new TList();
-    current_output->SetName(runs_.GetCurrent().data());
-    current_output->SetOwner(true);
-    correction_output->Add(current_output);
-    detectors_.CreateCorrectionHistograms();
+  if (fill_output_tree_ && out_tree_ && !workers_.empty()) {
+    throw std::logic_error("The output tree cannot be filled in event-parallel mode.");
   }
-  if (correction_input_) {
-    auto current_run = (TList *) correction_input_->FindObject(runs_.GetCurrent().data());
-    if (current_run) {
-      detectors_.AttachCorrectionInput(current_run);
-    }
+#ifdef QN_RNTUPLE
+  if (out_ntuple_ && !workers_.empty()) {
+    throw std::logic_error("The output RNTuple cannot be filled in event-parallel mode.");
   }
-  detectors_.CopyToOutputList(current_output);
-  detectors_.IncludeQnVectors();
+#endif
+  runs_.SetCurrentRun(name);
+  auto current_input = correction_input_.Get(runs_.GetCurrent());
+  const auto next_run = runs_.GetNext();
+  if (!next_run.empty()) correction_input_.Prefetch(next_run);
+  auto current_parameters = correction_parameters_.IsOpen() ? &correction_parameters_ : nullptr;
+  PrepareRun(current_input, current_parameters);
   if (fill_output_tree_ && out_tree_) {
-    detectors_.SetOutputTree(out_tree_);
+    detectors_.SetOutputTree(out_tree_, flat_output_tree_);
     variable_manager_.SetOutputTree(out_tree_);
   }
-  detectors_.CreateReport();
+#ifdef QN_RNTUPLE
+  // the model of the RNTuple is frozen after the first run.
+  if (out_ntuple_ && !out_ntuple_->IsConnected()) {
+    detectors_.SetOutputNTuple(*out_ntuple_);
+    variable_manager_.SetOutputNTuple(*out_ntuple_);
+    out_ntuple_->Connect();
+  }
+#endif
+  for (auto &worker : workers_) {
+    worker->runs_.SetCurrentRun(name);
+    worker->PrepareRun(current_input, current_parameters);
+  }
+  detectors_.CreateReport(true);
+}
+
+/**
+ * Creates the calibration histograms of the current run and attaches the calibration input.
+ * The histograms are only created for the first run. Afterwards the histograms of the previous run are reset in place
+ * and moved to the list of the current run, while the previous run keeps a compact copy until Finalize.
+ * The input list is only read and can be shared between the slots.
+ * @param current_input list of the calibration histograms of the current run. nullptr if it is not available.
+ * @param current_parameters file of the correction parameters. If available it is used instead of the list.
+ */
+void CorrectionManager::PrepareRun(TList *current_input, const CorrectionParameterFile *current_parameters) {
+  if (!runs_.empty() && current_output_) {
+    auto compact = CompactAndReset(current_output_);
+    correction_output->AddBefore(current_output_, compact);
+    correction_output->Remove(current_output_);
+    current_output_->SetName(runs_.GetCurrent().data());
+    correction_output->Add(current_output_);
+    detectors_.EnableFirstCorrections();
+  } else if (!runs_.empty()) {
+    current_output_ = new TList();
+    current_output_->SetName(runs_.GetCurrent().data());
+    current_output_->SetOwner(true);
+    correction_output->Add(current_output_);
+    detectors_.CreateCorrectionHistograms();
+  }
+  if (current_parameters) {
+    detectors_.AttachCorrectionInput(*current_parameters, runs_.GetCurrent());
+  } else if (current_input) {
+    detectors_.AttachCorrectionInput(current_input);
+  }
+  detectors_.CopyToOutputList(current_output_);
+  detectors_.IncludeQnVectors(fill_output_tree_ || fill_output_in_memory_);
 }
 
 void CorrectionManager::AttachQAHistograms() {
@@ -79,43 +233,103 @@ void CorrectionManager::AttachQAHistograms() {
 }
 
 void CorrectionManager::InitializeOnNode() {
-  variable_manager_.Initialize();
-  correction_axes_.Initialize(variable_manager_);
-  event_histograms_.Initialize(variable_manager_);
-  detectors_.Initialize(detectors_,variable_manager_, correction_axes_);
-  event_cuts_.Initialize(variable_manager_);
+  // workers are cloned before the initialization of the configuration.
+  for (unsigned int slot = 1; slot < n_slots_; ++slot) {
+    workers_.emplace_back(new CorrectionManager(*this));
+  }
+  InitializeSlot();
   InitializeCorrections();
   AttachQAHistograms();
+  // the slots and the prefetching of the calibration input run in separate threads.
+  if (!workers_.empty() || correction_input_.CanPrefetch()) ROOT::EnableThreadSafety();
+  if (!workers_.empty()) {
+    // histograms of the workers are not added to the current directory to avoid clashes of their names.
+    auto add_directory = TH1::AddDirectoryStatus();
+    TH1::AddDirectory(false);
+    for (auto &worker : workers_) {
+      worker->InitializeSlot();
+      worker->AttachQAHistograms();
+    }
+    TH1::AddDirectory(add_directory);
+  }
 }
 
-bool CorrectionManager::ProcessEvent() {
-  event_passed_cuts_ = event_cuts_.CheckCuts(0);
-  if (event_passed_cuts_) {
-    event_cuts_.FillReport();
-    variable_manager_.UpdateOutVariables();
-    event_histograms_.Fill();
+bool CorrectionManager::ProcessEvent(unsigned int slot) {
+  auto &manager = GetSlot(slot);
+  manager.event_histograms_.NextEvent();
+  manager.detectors_.NextQAEvent();
+  manager.event_passed_cuts_ = manager.event_cuts_.CheckCuts(0);
+  if (manager.event_passed_cuts_) {
+    manager.variable_manager_.UpdateOutVariables();
+    manager.event_histograms_.Fill();
   }
-  return event_passed_cuts_;
+  return manager.event_passed_cuts_;
 }
 
-void CorrectionManager::ProcessCorrections() {
-  if (event_passed_cuts_) {
-    detectors_.ProcessCorrections();
-    detectors_.FillReport();
-    if (fill_output_tree_) out_tree_->Fill();
+void CorrectionManager::ProcessCorrections(unsigned int slot) {
+  auto &manager = GetSlot(slot);
+  if (manager.event_passed_cuts_) {
+    manager.detectors_.ProcessCorrections();
+    if (manager.fill_output_tree_ && manager.out_tree_) manager.out_tree_->Fill();
+#ifdef QN_RNTUPLE
+    if (manager.out_ntuple_) manager.out_ntuple_->Fill();
+#endif
   }
 }
 
-void CorrectionManager::Reset() {
-  event_passed_cuts_ = false;
-  detectors_.ResetDetectors();
+void CorrectionManager::Reset(unsigned int slot) {
+  auto &manager = GetSlot(slot);
+  manager.event_passed_cuts_ = false;
+  manager.detectors_.ResetDetectors();
+}
+
+void CorrectionManager::ExportCorrectionParameters(const std::string &file_name) {
+  CorrectionParameterFile::Writer writer;
+  // each run is attached to a fresh copy of the detectors to leave the current run and the outputs untouched.
+  InputVariableManager variables(variable_manager_);
+  variables.Initialize();
+  CorrectionAxisSet axes(correction_axes_);
+  axes.Initialize(variables);
+  auto add_directory = TH1::AddDirectoryStatus();
+  TH1::AddDirectory(false);
+  for (const auto &run : correction_input_.GetRunNames()) {
+    auto input = correction_input_.Read(run);
+    if (!input) continue;
+    DetectorList detectors(detectors_);
+    detectors.Initialize(detectors, variables, axes);
+    detectors.CreateSupportQVectors();
+    detectors.CreateCorrectionHistograms();
+    detectors.AttachCorrectionInput(input.get());
+    detectors.ExportCorrectionParameters(writer, run);
+  }
+  TH1::AddDirectory(add_directory);
+  writer.Write(file_name);
 }
 
 void CorrectionManager::Finalize() {
+  // the buffered QA histograms and the cut reports are completed before they are merged.
+  for (unsigned int slot = 0; slot <= workers_.size(); ++slot) {
+    auto &manager = GetSlot(slot);
+    manager.event_cuts_.FlushReport();
+    manager.event_histograms_.Flush();
+    manager.detectors_.FlushQA();
+  }
+  // merges the histograms of the workers in the order of the slots to obtain a reproducible result.
+  for (auto &worker : workers_) {
+    MergeHistogramLists(correction_output.get(), worker->correction_output.get());
+    MergeHistogramLists(correction_qa_histos_.get(), worker->correction_qa_histos_.get());
+  }
+  workers_.clear();
+  for (auto run : *correction_output) {
+    if (run!=current_output_) ExpandCompactHistograms(static_cast<TList *>(run));
+  }
+#ifdef QN_RNTUPLE
+  if (out_ntuple_) out_ntuple_->Finalize();
+#endif
   auto calibration_list = (TList *) correction_output->FindObject(runs_.GetCurrent().data());
   if (calibration_list) {
     correction_output->Add(calibration_list->Clone("all"));
   }
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,187 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CorrectionParameterFile.h"
+
+namespace Qn {
+
+namespace {
+constexpr char kMagic[8] = {'Q', 'n', 'C', 'o', 'r', 'P', 'a', 'r'};
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t n_tables;
+};
+
+struct Record {
+  std::uint64_t run;
+  std::uint64_t sub_event;
+  std::uint64_t step;
+  std::int64_t n_bins;
+  std::uint32_t n_parameters;
+  std::uint32_t n_harmonics;
+  std::uint64_t harmonics;
+  std::uint64_t parameters;
+  std::uint64_t validated;
+};
+
+static_assert(sizeof(Header)==16, "Unexpected size of the parameter file header.");
+static_assert(sizeof(Record)==64, "Unexpected size of the parameter file index record.");
+
+std::uint64_t Align(std::uint64_t offset) { return (offset + 7) & ~std::uint64_t(7); }
+
+std::string ReadName(const char *data, std::size_t size, std::uint64_t offset) {
+  return std::string(data + offset, strnlen(data + offset, size - offset));
+}
+}
+
+void CorrectionParameterFile::Writer::Write(const std::string &file_name) const {
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.n_tables = tables_.size();
+  // first pass computes the layout of the file.
+  std::vector<Record> records;
+  std::string names;
+  std::uint64_t names_offset = sizeof(Header) + tables_.size()*sizeof(Record);
+  auto add_name = [&names, names_offset](const std::string &name) {
+    auto offset = names_offset + names.size();
+    names.append(name.data(), name.size() + 1);
+    return offset;
+  };
+  for (const auto &table : tables_) {
+    Record record{};
+    record.run = add_name(std::get<0>(table.first));
+    record.sub_event = add_name(std::get<1>(table.first));
+    record.step = add_name(std::get<2>(table.first));
+    record.n_bins = table.second.GetNoOfBins();
+    record.n_parameters = table.second.GetNoOfParameters();
+    record.n_harmonics = table.second.GetNoOfHarmonics();
+    record.harmonics = table.second.GetHarmonics();
+    records.push_back(record);
+  }
+  auto offset = Align(names_offset + names.size());
+  for (auto &record : records) {
+    record.parameters = offset;
+    offset = Align(offset + record.n_bins*record.n_harmonics*record.n_parameters*sizeof(Double_t));
+    record.validated = offset;
+    offset = Align(offset + record.n_bins);
+  }
+  // second pass writes the sections.
+  std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("Cannot open the correction parameter file " + file_name + ".");
+  auto pad = [&file]() {
+    static const char zeros[8] = {};
+    auto position = static_cast<std::uint64_t>(file.tellp());
+    file.write(zeros, Align(position) - position);
+  };
+  file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char *>(records.data()), records.size()*sizeof(Record));
+  file.write(names.data(), names.size());
+  pad();
+  auto record = records.begin();
+  for (const auto &table : tables_) {
+    file.write(reinterpret_cast<const char *>(table.second.GetParameterArray()),
+               record->n_bins*record->n_harmonics*record->n_parameters*sizeof(Double_t));
+    pad();
+    file.write(table.second.GetValidatedArray(), record->n_bins);
+    pad();
+    ++record;
+  }
+  if (!file) throw std::runtime_error("Cannot write the correction parameter file " + file_name + ".");
+}
+
+void CorrectionParameterFile::Open(const std::string &file_name) {
+  Close();
+  auto descriptor = ::open(file_name.data(), O_RDONLY);
+  if (descriptor < 0) throw std::runtime_error("Cannot open the correction parameter file " + file_name + ".");
+  struct stat status{};
+  if (::fstat(descriptor, &status)!=0 || static_cast<std::size_t>(status.st_size) < sizeof(Header)) {
+    ::close(descriptor);
+    throw std::runtime_error(file_name + " is not a correction parameter file.");
+  }
+  auto mapping = ::mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  ::close(descriptor);
+  if (mapping==MAP_FAILED) throw std::runtime_error("Cannot map the correction parameter file " + file_name + ".");
+  data_ = static_cast<const char *>(mapping);
+  size_ = status.st_size;
+  const auto header = reinterpret_cast<const Header *>(data_);
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic))!=0 || header->version!=kVersion
+      || std::uint64_t(header->n_tables) > (size_ - sizeof(Header))/sizeof(Record)) {
+    Close();
+    throw std::runtime_error(file_name + " is not a correction parameter file of version "
+                                 + std::to_string(kVersion) + ".");
+  }
+  const auto records = reinterpret_cast<const Record *>(data_ + sizeof(Header));
+  for (std::uint32_t i = 0; i < header->n_tables; ++i) {
+    const auto &record = records[i];
+    // the sizes are compared with the remaining bytes, so that the checks cannot overflow.
+    const auto n_bins = static_cast<std::uint64_t>(record.n_bins);
+    const auto bin_size = std::uint64_t(record.n_harmonics)*record.n_parameters;
+    if (record.run >= size_ || record.sub_event >= size_ || record.step >= size_ || record.n_bins < 0
+        || record.validated > size_ || n_bins > size_ - record.validated
+        || record.parameters > size_ || bin_size > (size_ - record.parameters)/sizeof(Double_t)
+        || (bin_size!=0 && n_bins > (size_ - record.parameters)/sizeof(Double_t)/bin_size)) {
+      Close();
+      throw std::runtime_error(file_name + " is corrupted.");
+    }
+    Entry entry{record.n_bins, record.n_parameters, record.n_harmonics, record.harmonics,
+                reinterpret_cast<const Double_t *>(data_ + record.parameters), data_ + record.validated};
+    entries_.emplace(std::make_tuple(ReadName(data_, size_, record.run),
+                                     ReadName(data_, size_, record.sub_event),
+                                     ReadName(data_, size_, record.step)), entry);
+  }
+}
+
+void CorrectionParameterFile::Close() {
+  entries_.clear();
+  if (data_) ::munmap(const_cast<char *>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+bool CorrectionParameterFile::Contains(const std::string &run, const std::string &sub_event) const {
+  auto entry = entries_.lower_bound(std::make_tuple(run, sub_event, std::string()));
+  return entry!=entries_.end() && std::get<0>(entry->first)==run && std::get<1>(entry->first)==sub_event;
+}
+
+bool CorrectionParameterFile::Read(const std::string &run, const std::string &sub_event, const std::string &step,
+                                   Long64_t n_bins, unsigned int n_parameters, unsigned int n_harmonics,
+                                   std::uint64_t harmonics, CorrectionParameterTable &table) const {
+  auto entry = entries_.find(std::make_tuple(run, sub_event, step));
+  if (entry==entries_.end()) return false;
+  const auto &position = entry->second;
+  if (position.n_bins!=n_bins || position.n_parameters!=n_parameters || position.n_harmonics!=n_harmonics
+      || position.harmonics!=harmonics) {
+    return false;
+  }
+  table.Assign(position.n_bins, position.n_parameters, position.n_harmonics, position.harmonics,
+               position.parameters, position.validated);
+  return true;
+}
+
+}
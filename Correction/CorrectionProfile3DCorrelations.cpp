@@ -52,37 +52,6 @@ CorrectionProfile3DCorrelations::CorrectionProfile3DCorrelations(std::string nam
     CorrectionHistogramBase(name, name, ecvs, mode), fNameA(nameA), fNameB(nameB), fNameC(nameC) {
 }
 
-/// Default destructor
-///
-/// Returns the only taken memory, the harmonic histograms storage,
-/// the own histograms and other members are not own at destruction time
-CorrectionProfile3DCorrelations::~CorrectionProfile3DCorrelations() {
-  if (fXXValues) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      delete[] fXXValues[ixComb];
-    }
-    delete[] fXXValues;
-  }
-  if (fXYValues) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      delete[] fXYValues[ixComb];
-    }
-    delete[] fXYValues;
-  }
-  if (fYXValues) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      delete[] fYXValues[ixComb];
-    }
-    delete[] fYXValues;
-  }
-  if (fYYValues) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      delete[] fYYValues[ixComb];
-    }
-    delete[] fYYValues;
-  }
-}
-
 /// Creates the XX, XY, YX, YY correlation components support histograms
 /// for the profile function for each combination of Qn vectors
 ///
@@ -128,34 +97,8 @@ Bool_t CorrectionProfile3DCorrelations::CreateCorrelationComponentsProfileHistog
     return false;
   }
 
-  /* let's support the external harmonic number map */
-  /* external harmonic number will always start from one */
-  Int_t nNumberOfSlots = 1;
-  if (harmonicMap!=nullptr) {
-    /* the highest harmonic number within the map if any */
-    nNumberOfSlots += harmonicMap[nNoOfHarmonics - 1];
-  } else {
-    nNumberOfSlots += nNoOfHarmonics;
-  }
-
   /* now allocate the slots for the values histograms for each Qn vector correlation combination */
-  fXXValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-  fXYValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-  fYXValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-  fYYValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-  for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-    fXXValues[ixComb] = new THnF *[nNumberOfSlots];
-    fXYValues[ixComb] = new THnF *[nNumberOfSlots];
-    fYXValues[ixComb] = new THnF *[nNumberOfSlots];
-    fYYValues[ixComb] = new THnF *[nNumberOfSlots];
-    /* and initiallize them */
-    for (Int_t i = 0; i < nNumberOfSlots; i++) {
-      fXXValues[ixComb][i] = nullptr;
-      fXYValues[ixComb][i] = nullptr;
-      fYXValues[ixComb][i] = nullptr;
-      fYYValues[ixComb][i] = nullptr;
-    }
-  }
+  fValues.assign(CORRELATIONSNOOFQNVECTORS*kNoOfComponents*(nMaxHarmonicNumberSupported + 1), nullptr);
   /* now prepare the construction of the histograms */
   Int_t nVariables = fEventClassVariables.GetSize();
   Double_t *minvals = new Double_t[nVariables];
@@ -166,6 +109,8 @@ Bool_t CorrectionProfile3DCorrelations::CreateCorrelationComponentsProfileHistog
   fEventClassVariables.GetMultidimensionalConfiguration(nbins, minvals, maxvals);
   /* create the values multidimensional histograms for each Qn vector correlation combination and harmonic */
   const char *combNames[CORRELATIONSNOOFQNVECTORS] = {fNameA.data(), fNameB.data(), fNameC.data()};
+  const char *componentSuffixes[kNoOfComponents] = {szXXCorrelationComponentSuffix, szXYCorrelationComponentSuffix,
+                                                    szYXCorrelationComponentSuffix, szYYCorrelationComponentSuffix};
   for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
     Int_t currentHarmonic = 0;
     for (Int_t i = 0; i < nNoOfHarmonics; i++) {
@@ -179,75 +124,25 @@ Bool_t CorrectionProfile3DCorrelations::CreateCorrelationComponentsProfileHistog
           BaseName = GetName() + " " + combNames[ixComb] + "x" + combNames[(ixComb + 1)%CORRELATIONSNOOFQNVECTORS];
       TString
           BaseTitle = GetTitle() + " " + combNames[ixComb] + "x" + combNames[(ixComb + 1)%CORRELATIONSNOOFQNVECTORS];
-      TString histoXXName = BaseName;
-      histoXXName += szXXCorrelationComponentSuffix;
-      TString histoXYName = BaseName;
-      histoXYName += szXYCorrelationComponentSuffix;
-      TString histoYXName = BaseName;
-      histoYXName += szYXCorrelationComponentSuffix;
-      TString histoYYName = BaseName;
-      histoYYName += szYYCorrelationComponentSuffix;
-      TString histoXXTitle = BaseTitle;
-      histoXXTitle += szXXCorrelationComponentSuffix;
-      TString histoXYTitle = BaseTitle;
-      histoXYTitle += szXYCorrelationComponentSuffix;
-      TString histoYXTitle = BaseTitle;
-      histoYXTitle += szYXCorrelationComponentSuffix;
-      TString histoYYTitle = BaseTitle;
-      histoYYTitle += szYYCorrelationComponentSuffix;
-      fXXValues[ixComb][currentHarmonic] =
-          new THnF(Form("%s_h%d", (const char *) histoXXName, currentHarmonic*fHarmonicMultiplier),
-                   Form("%s h%d", (const char *) histoXXTitle, currentHarmonic),
-                   nVariables, nbins, minvals, maxvals);
-      fXYValues[ixComb][currentHarmonic] =
-          new THnF(Form("%s_h%d", (const char *) histoXYName, currentHarmonic*fHarmonicMultiplier),
-                   Form("%s h%d", (const char *) histoXYTitle, currentHarmonic),
-                   nVariables, nbins, minvals, maxvals);
-      fYXValues[ixComb][currentHarmonic] =
-          new THnF(Form("%s_h%d", (const char *) histoYXName, currentHarmonic*fHarmonicMultiplier),
-                   Form("%s h%d", (const char *) histoYXTitle, currentHarmonic),
-                   nVariables, nbins, minvals, maxvals);
-      fYYValues[ixComb][currentHarmonic] =
-          new THnF(Form("%s_h%d", (const char *) histoYYName, currentHarmonic*fHarmonicMultiplier),
-                   Form("%s h%d", (const char *) histoYYTitle, currentHarmonic),
-                   nVariables, nbins, minvals, maxvals);
-      /* now let's set the proper binning and label on each axis */
-      for (Int_t var = 0; var < nVariables; var++) {
-        fXXValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fXXValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fXXValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
-        fXXValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
-        fXYValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fXYValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fXYValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
-        fXYValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
-        fYXValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fYXValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fYXValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
-        fYXValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
-        fYYValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fYYValues[ixComb][currentHarmonic]->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(),
-                                                              fEventClassVariables[var].GetBins());
-        fYYValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
-        fYYValues[ixComb][currentHarmonic]->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
+      for (Int_t ixComp = 0; ixComp < kNoOfComponents; ixComp++) {
+        TString histoName = BaseName;
+        histoName += componentSuffixes[ixComp];
+        TString histoTitle = BaseTitle;
+        histoTitle += componentSuffixes[ixComp];
+        auto histogram = new THnF(Form("%s_h%d", (const char *) histoName, currentHarmonic*fHarmonicMultiplier),
+                                  Form("%s h%d", (const char *) histoTitle, currentHarmonic),
+                                  nVariables, nbins, minvals, maxvals);
+        /* now let's set the proper binning and label on each axis */
+        for (Int_t var = 0; var < nVariables; var++) {
+          histogram->GetAxis(var)->Set(fEventClassVariables[var].GetNBins(), fEventClassVariables[var].GetBins());
+          histogram->GetAxis(var)->SetTitle(fEventClassVariables[var].GetLabel().data());
+        }
+        /* ask for square sum accumulation */
+        histogram->Sumw2();
+        /* and finally add the histogram to the list */
+        histogramList->Add(histogram);
+        fValues[GetIndex(ixComb, ixComp, currentHarmonic)] = histogram;
       }
-      /* ask for square sum accumulation */
-      fXXValues[ixComb][currentHarmonic]->Sumw2();
-      fXYValues[ixComb][currentHarmonic]->Sumw2();
-      fYXValues[ixComb][currentHarmonic]->Sumw2();
-      fYYValues[ixComb][currentHarmonic]->Sumw2();
-      /* and finally add the histograms to the list */
-      histogramList->Add(fXXValues[ixComb][currentHarmonic]);
-      histogramList->Add(fXYValues[ixComb][currentHarmonic]);
-      histogramList->Add(fYXValues[ixComb][currentHarmonic]);
-      histogramList->Add(fYYValues[ixComb][currentHarmonic]);
     }
   }
   /* now the entries histogram name and title */
@@ -299,34 +194,7 @@ Bool_t CorrectionProfile3DCorrelations::CreateCorrelationComponentsProfileHistog
 Bool_t CorrectionProfile3DCorrelations::AttachHistograms(TList *histogramList) {
   /* initialize. Remember we don't own the histograms */
   fEntries = nullptr;
-  if (fXXValues!=nullptr) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      if (fXXValues[ixComb]!=nullptr)
-        delete[] fXXValues[ixComb];
-    }
-    delete[] fXXValues;
-  }
-  if (fXYValues!=nullptr) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      if (fXYValues[ixComb]!=nullptr)
-        delete[] fXYValues[ixComb];
-    }
-    delete[] fXYValues;
-  }
-  if (fYXValues!=nullptr) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      if (fYXValues[ixComb]!=nullptr)
-        delete[] fYXValues[ixComb];
-    }
-    delete[] fYXValues;
-  }
-  if (fYYValues!=nullptr) {
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      if (fYYValues[ixComb]!=nullptr)
-        delete[] fYYValues[ixComb];
-    }
-    delete[] fYYValues;
-  }
+  fValues.clear();
   /* let's build the entries histogram name */
   TString entriesHistoName = GetName();
   entriesHistoName = entriesHistoName + fNameA + fNameB + fNameC;
@@ -339,56 +207,28 @@ Bool_t CorrectionProfile3DCorrelations::AttachHistograms(TList *histogramList) {
   fEntries = (THnI *) histogramList->FindObject((const char *) entriesHistoName);
   if (fEntries && fEntries->GetEntries()!=0) {
     /* allocate enough space for the supported harmonic numbers */
-    fXXValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-    fXYValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-    fYXValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-    fYYValues = new THnF **[CORRELATIONSNOOFQNVECTORS];
-    for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      fXXValues[ixComb] = new THnF *[nMaxHarmonicNumberSupported + 1];
-      fXYValues[ixComb] = new THnF *[nMaxHarmonicNumberSupported + 1];
-      fYXValues[ixComb] = new THnF *[nMaxHarmonicNumberSupported + 1];
-      fYYValues[ixComb] = new THnF *[nMaxHarmonicNumberSupported + 1];
-    }
+    fValues.assign(CORRELATIONSNOOFQNVECTORS*kNoOfComponents*(nMaxHarmonicNumberSupported + 1), nullptr);
     /* search the multidimensional histograms for each harmonic and Qn vecto correlation combination */
     const char *combNames[CORRELATIONSNOOFQNVECTORS] = {fNameA.data(), fNameB.data(), fNameC.data()};
+    const char *componentSuffixes[kNoOfComponents] = {szXXCorrelationComponentSuffix, szXYCorrelationComponentSuffix,
+                                                      szYXCorrelationComponentSuffix, szYYCorrelationComponentSuffix};
     for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
-      Int_t currentHarmonic = 0;
       /* let's build the histograms names */
       TString
           BaseName = GetName() + " " + combNames[ixComb] + "x" + combNames[(ixComb + 1)%CORRELATIONSNOOFQNVECTORS];
-      TString
-          BaseTitle = GetTitle() + " " + combNames[ixComb] + "x" + combNames[(ixComb + 1)%CORRELATIONSNOOFQNVECTORS];
-      TString histoXXName = BaseName;
-      histoXXName += szXXCorrelationComponentSuffix;
-      TString histoXYName = BaseName;
-      histoXYName += szXYCorrelationComponentSuffix;
-      TString histoYXName = BaseName;
-      histoYXName += szYXCorrelationComponentSuffix;
-      TString histoYYName = BaseName;
-      histoYYName += szYYCorrelationComponentSuffix;
-      for (Int_t i = 0; i < nMaxHarmonicNumberSupported; i++) {
-        currentHarmonic++;
-        fXXValues[ixComb][currentHarmonic] = (THnF *) histogramList->FindObject(Form("%s_h%d",
-                                                                                     (const char *) histoXXName,
-                                                                                     currentHarmonic
-                                                                                         *fHarmonicMultiplier));
-        fXYValues[ixComb][currentHarmonic] = (THnF *) histogramList->FindObject(Form("%s_h%d",
-                                                                                     (const char *) histoXYName,
-                                                                                     currentHarmonic
-                                                                                         *fHarmonicMultiplier));
-        fYXValues[ixComb][currentHarmonic] = (THnF *) histogramList->FindObject(Form("%s_h%d",
-                                                                                     (const char *) histoYXName,
-                                                                                     currentHarmonic
-                                                                                         *fHarmonicMultiplier));
-        fYYValues[ixComb][currentHarmonic] = (THnF *) histogramList->FindObject(Form("%s_h%d",
-                                                                                     (const char *) histoYYName,
-                                                                                     currentHarmonic
-                                                                                         *fHarmonicMultiplier));
-
+      for (Int_t currentHarmonic = 1; currentHarmonic <= nMaxHarmonicNumberSupported; currentHarmonic++) {
+        Bool_t found = kTRUE;
+        for (Int_t ixComp = 0; ixComp < kNoOfComponents; ixComp++) {
+          TString histoName = BaseName;
+          histoName += componentSuffixes[ixComp];
+          auto histogram = (THnF *) histogramList->FindObject(Form("%s_h%d",
+                                                                   (const char *) histoName,
+                                                                   currentHarmonic*fHarmonicMultiplier));
+          fValues[GetIndex(ixComb, ixComp, currentHarmonic)] = histogram;
+          found = found && (histogram!=nullptr);
+        }
         /* update the correcto condition */
-        if ((fXXValues[ixComb][currentHarmonic]!=nullptr) && (fXYValues[ixComb][currentHarmonic]!=nullptr)
-            && (fYXValues[ixComb][currentHarmonic]!=nullptr) && (fYYValues[ixComb][currentHarmonic]!=nullptr))
-          harmonicFilledMask |= harmonicNumberMask[currentHarmonic];
+        if (found) harmonicFilledMask |= harmonicNumberMask[currentHarmonic];
       }
     }
   } else {
@@ -424,299 +264,67 @@ Bool_t CorrectionProfile3DCorrelations::BinContentValidated(Long64_t bin) {
   return nEntries >= fMinNoOfEntriesToValidate;
 }
 
-/// Get the XX correlation component bin content for the passed bin number
+/// Get the correlation component bin content for the passed bin number
 /// for the corresponding harmonic and Qn vector combination
 ///
 /// The bin number identifies a desired event class whose content is
 /// requested. If the bin content is not validated zero is returned.
 ///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
+/// \param comb the desired Qn vector combination
+/// \param component the desired correlation component
 /// \param harmonic the interested external harmonic number
 /// \param bin the interested bin number
 /// \return the bin number content
-Float_t CorrectionProfile3DCorrelations::GetXXBinContent(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
+Float_t CorrectionProfile3DCorrelations::GetBinContent(Combination comb,
+                                                       Component component,
+                                                       Int_t harmonic,
+                                                       Long64_t bin) {
   /* sanity check */
-  if (fXXValues[ixComb][harmonic]==nullptr) {
+  if (fValues.empty()) {
     return 0.0;
   }
-
-  if (!BinContentValidated(bin)) {
-    return 0.0;
-  } else {
-    auto nEntries = Int_t(fEntries->GetBinContent(bin));
-    return fXXValues[ixComb][harmonic]->GetBinContent(bin)/Float_t(nEntries);
-  }
-}
-
-/// Get the XY correlation component bin content for the passed bin number
-/// for the corresponding harmonic and Qn vector combination
-///
-/// The bin number identifies a desired event class whose content is
-/// requested. If the bin content is not validated zero is returned.
-///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
-/// \param harmonic the interested external harmonic number
-/// \param bin the interested bin number
-/// \return the bin number content
-Float_t CorrectionProfile3DCorrelations::GetXYBinContent(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
-  /* sanity check */
-  if (!fXYValues[ixComb][harmonic]) {
+  auto values = fValues[GetIndex(static_cast<Int_t>(comb), static_cast<Int_t>(component), harmonic)];
+  if (values==nullptr) {
     return 0.0;
   }
   if (!BinContentValidated(bin)) {
     return 0.0;
   } else {
     auto nEntries = Int_t(fEntries->GetBinContent(bin));
-    return fXYValues[ixComb][harmonic]->GetBinContent(bin)/Float_t(nEntries);
+    return values->GetBinContent(bin)/Float_t(nEntries);
   }
 }
 
-/// Get the YX correlation component bin content for the passed bin number
+/// Get the correlation component bin content error for the passed bin number
 /// for the corresponding harmonic and Qn vector combination
 ///
 /// The bin number identifies a desired event class whose content is
-/// requested. If the bin content is not validated zero is returned.
-///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
-/// \param harmonic the interested external harmonic number
-/// \param bin the interested bin number
-/// \return the bin number content
-Float_t CorrectionProfile3DCorrelations::GetYXBinContent(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
-  /* sanity check */
-  if (!fYXValues[ixComb][harmonic]) {
-    return 0.0;
-  }
-  if (!BinContentValidated(bin)) {
-    return 0.0;
-  } else {
-    auto nEntries = Int_t(fEntries->GetBinContent(bin));
-    return fYXValues[ixComb][harmonic]->GetBinContent(bin)/Float_t(nEntries);
-  }
-}
-
-/// Get the YY correlation component bin content for the passed bin number
-/// for the corresponding harmonic and Qn vector combination
-///
-/// The bin number identifies a desired event class whose content is
-/// requested. If the bin content is not validated zero is returned.
-///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
-/// \param harmonic the interested external harmonic number
-/// \param bin the interested bin number
-/// \return the bin number content
-Float_t CorrectionProfile3DCorrelations::GetYYBinContent(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
-  /* sanity check */
-  if (fYYValues[ixComb][harmonic]==nullptr) {
-    return 0.0;
-  }
-  if (!BinContentValidated(bin)) {
-    return 0.0;
-  } else {
-    auto nEntries = Int_t(fEntries->GetBinContent(bin));
-    return fYYValues[ixComb][harmonic]->GetBinContent(bin)/Float_t(nEntries);
-  }
-}
-
-/// Get the XX correlation component bin content error for the passed bin number
-/// for the corresponding harmonic  and Qn vector combination
-///
-/// The bin number identifies a desired event class whose content is
-/// error is requested. If the bin content is not validated zero is returned.
-///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
-/// \param harmonic the interested external harmonic number
-/// \param bin the interested bin number
-/// \return the bin content error
-Float_t CorrectionProfile3DCorrelations::GetXXBinError(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
-  /* sanity check */
-  if (fXXValues[ixComb][harmonic]==nullptr) {
-    return 0.0;
-  }
-  if (!BinContentValidated(bin)) {
-    return 0.0;
-  } else {
-    auto nEntries = Int_t(fEntries->GetBinContent(bin));
-    Float_t values = fXXValues[ixComb][harmonic]->GetBinContent(bin);
-    Float_t error2 = fXXValues[ixComb][harmonic]->GetBinError2(bin);
-
-    Double_t average = values/nEntries;
-    Double_t serror = TMath::Sqrt(TMath::Abs(error2/nEntries - average*average));
-    switch (fErrorMode) {
-      case ErrorMode::MEAN:return serror/TMath::Sqrt(nEntries);
-      case ErrorMode::SPREAD:return serror;
-      default:return 0.0;
-    }
-  }
-}
-
-/// Get the XY correlation component bin content error for the passed bin number
-/// for the corresponding harmonic  and Qn vector combination
-///
-/// The bin number identifies a desired event class whose content is
-/// error is requested. If the bin content is not validated zero is returned.
-///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
-/// \param harmonic the interested external harmonic number
-/// \param bin the interested bin number
-/// \return the bin content error
-Float_t CorrectionProfile3DCorrelations::GetXYBinError(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
-  /* sanity check */
-  if (fXYValues[ixComb][harmonic]==nullptr) {
-    return 0.0;
-  }
-  if (!BinContentValidated(bin)) {
-    return 0.0;
-  } else {
-    Int_t nEntries = Int_t(fEntries->GetBinContent(bin));
-    Float_t values = fXYValues[ixComb][harmonic]->GetBinContent(bin);
-    Float_t error2 = fXYValues[ixComb][harmonic]->GetBinError2(bin);
-
-    Double_t average = values/nEntries;
-    Double_t serror = TMath::Sqrt(TMath::Abs(error2/nEntries - average*average));
-    switch (fErrorMode) {
-      case ErrorMode::MEAN:return serror/TMath::Sqrt(nEntries);
-      case ErrorMode::SPREAD:return serror;
-      default:return 0.0;
-    }
-  }
-}
-
-/// Get the YX correlation component bin content error for the passed bin number
-/// for the corresponding harmonic  and Qn vector combination
-///
-/// The bin number identifies a desired event class whose content is
 /// error is requested. If the bin content is not validated zero is returned.
 ///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
+/// \param comb the desired Qn vector combination
+/// \param component the desired correlation component
 /// \param harmonic the interested external harmonic number
 /// \param bin the interested bin number
 /// \return the bin content error
-Float_t CorrectionProfile3DCorrelations::GetYXBinError(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
-
+Float_t CorrectionProfile3DCorrelations::GetBinError(Combination comb,
+                                                     Component component,
+                                                     Int_t harmonic,
+                                                     Long64_t bin) {
   /* sanity check */
-  if (fYXValues[ixComb][harmonic]==nullptr) {
+  if (fValues.empty()) {
     return 0.0;
   }
-
-  if (!BinContentValidated(bin)) {
-    return 0.0;
-  } else {
-    auto nEntries = Int_t(fEntries->GetBinContent(bin));
-    Float_t values = fYXValues[ixComb][harmonic]->GetBinContent(bin);
-    Float_t error2 = fYXValues[ixComb][harmonic]->GetBinError2(bin);
-
-    Double_t average = values/nEntries;
-    Double_t serror = TMath::Sqrt(TMath::Abs(error2/nEntries - average*average));
-    switch (fErrorMode) {
-      case ErrorMode::MEAN:return serror/TMath::Sqrt(nEntries);
-      case ErrorMode::SPREAD:return serror;
-      default:return 0.0;
-    }
-  }
-}
-
-/// Get the YY correlation component bin content error for the passed bin number
-/// for the corresponding harmonic  and Qn vector combination
-///
-/// The bin number identifies a desired event class whose content is
-/// error is requested. If the bin content is not validated zero is returned.
-///
-/// \param comb the name of the desired Qn vector combination: "AB", "BC" or "AC"
-/// \param harmonic the interested external harmonic number
-/// \param bin the interested bin number
-/// \return the bin content error
-Float_t CorrectionProfile3DCorrelations::GetYYBinError(const char *comb, Int_t harmonic, Long64_t bin) {
-  TString szComb = comb;
-  Int_t ixComb = -1;
-  if (szComb.EqualTo("AB"))
-    ixComb = 0;
-  else if (szComb.EqualTo("BC"))
-    ixComb = 1;
-  else if (szComb.EqualTo("AC"))
-    ixComb = 2;
-  else
-    return 0.0;
-  /* sanity check */
-  if (fYYValues[ixComb][harmonic]==nullptr) {
+  auto values = fValues[GetIndex(static_cast<Int_t>(comb), static_cast<Int_t>(component), harmonic)];
+  if (values==nullptr) {
     return 0.0;
   }
   if (!BinContentValidated(bin)) {
     return 0.0;
   } else {
     auto nEntries = Int_t(fEntries->GetBinContent(bin));
-    Float_t values = fYYValues[ixComb][harmonic]->GetBinContent(bin);
-    Float_t error2 = fYYValues[ixComb][harmonic]->GetBinError2(bin);
-    Double_t average = values/nEntries;
+    Float_t content = values->GetBinContent(bin);
+    Float_t error2 = values->GetBinError2(bin);
+    Double_t average = content/nEntries;
     Double_t serror = TMath::Sqrt(TMath::Abs(error2/nEntries - average*average));
     switch (fErrorMode) {
       case ErrorMode::MEAN:return serror/TMath::Sqrt(nEntries);
@@ -754,38 +362,29 @@ void CorrectionProfile3DCorrelations::Fill(const QVector *QnA,
   /* consider all combinations */
   const QVector *combQn[CORRELATIONSNOOFQNVECTORS] = {QnA, QnB, QnC};
   for (Int_t ixComb = 0; ixComb < CORRELATIONSNOOFQNVECTORS; ixComb++) {
+    const QVector *first = combQn[ixComb];
+    const QVector *second = combQn[(ixComb + 1)%CORRELATIONSNOOFQNVECTORS];
     /* and all harmonics */
     Int_t nCurrentHarmonic = QnA->GetFirstHarmonic();
     while (nCurrentHarmonic!=-1) {
       /* first the sanity checks */
-      if (fXXValues[ixComb][nCurrentHarmonic]==nullptr) {
+      if (fValues[GetIndex(ixComb, 0, nCurrentHarmonic)]==nullptr) {
         return;
       }
-      /* keep total entries in fValues updated */
-      Double_t nXXEntries = fXXValues[ixComb][nCurrentHarmonic]->GetEntries();
-      Double_t nXYEntries = fXYValues[ixComb][nCurrentHarmonic]->GetEntries();
-      Double_t nYXEntries = fYXValues[ixComb][nCurrentHarmonic]->GetEntries();
-      Double_t nYYEntries = fYYValues[ixComb][nCurrentHarmonic]->GetEntries();
-      fXXValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues,
-                                                combQn[ixComb]->x(nCurrentHarmonic)*combQn[(ixComb + 1)
-                                                    %CORRELATIONSNOOFQNVECTORS]->x(nCurrentHarmonic));
-      fXYValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues,
-                                                combQn[ixComb]->x(nCurrentHarmonic)*combQn[(ixComb + 1)
-                                                    %CORRELATIONSNOOFQNVECTORS]->y(nCurrentHarmonic));
-      fYXValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues,
-                                                combQn[ixComb]->y(nCurrentHarmonic)*combQn[(ixComb + 1)
-                                                    %CORRELATIONSNOOFQNVECTORS]->x(nCurrentHarmonic));
-      fYYValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues,
-                                                combQn[ixComb]->y(nCurrentHarmonic)*combQn[(ixComb + 1)
-                                                    %CORRELATIONSNOOFQNVECTORS]->y(nCurrentHarmonic));
-      fXXValues[ixComb][nCurrentHarmonic]->SetEntries(nXXEntries + 1);
-      fXYValues[ixComb][nCurrentHarmonic]->SetEntries(nXYEntries + 1);
-      fYXValues[ixComb][nCurrentHarmonic]->SetEntries(nYXEntries + 1);
-      fYYValues[ixComb][nCurrentHarmonic]->SetEntries(nYYEntries + 1);
+      /* the components are ordered XX, XY, YX, YY */
+      const Double_t firstComponents[2] = {first->x(nCurrentHarmonic), first->y(nCurrentHarmonic)};
+      const Double_t secondComponents[2] = {second->x(nCurrentHarmonic), second->y(nCurrentHarmonic)};
+      for (Int_t ixComp = 0; ixComp < kNoOfComponents; ixComp++) {
+        auto values = fValues[GetIndex(ixComb, ixComp, nCurrentHarmonic)];
+        /* keep total entries in fValues updated */
+        Double_t nEntries = values->GetEntries();
+        values->Fill(fBinAxesValues, firstComponents[ixComp/2]*secondComponents[ixComp%2]);
+        values->SetEntries(nEntries + 1);
+      }
       nCurrentHarmonic = QnA->GetNextHarmonic(nCurrentHarmonic);
     }
   }
   /* update the profile entries */
   fEntries->Fill(fBinAxesValues, 1.0);
 }
-}
\ No newline at end of file
+}
@@ -1,6 +1,8 @@
 /// \file QnCorrectionsProfileChannelizedIngress.cxx
 /// \brief Implementation of the multidimensional ingress channelized profile 
 
+#include <vector>
+
 #include "TList.h"
 
 #include "CorrectionAxisSet.h"
@@ -363,6 +365,39 @@ Long64_t CorrectionProfileChannelizedIngress::GetGrpBin(Int_t nChannel) {
   return -1;
 }
 
+/// Get the external channel number of the passed bin
+///
+/// Inverse of GetBin for the channel axis. Used to visit all
+/// event classes and channels without the current variables content.
+///
+/// \param bin the interested bin number
+/// \return the external channel number, -1 for under- and overflow bins
+Int_t CorrectionProfileChannelizedIngress::GetChannel(Long64_t bin) {
+  std::vector<Int_t> binsArray(fEventClassVariables.GetSize() + 1);
+  fValues->GetBinContent(bin, binsArray.data());
+  Int_t nActualChannel = binsArray.back() - 1;
+  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+    if (fUsedChannel[ixChannel] && fChannelMap[ixChannel]==nActualChannel) return ixChannel;
+  }
+  return -1;
+}
+
+/// Get the group bin number for the passed bin number
+///
+/// The group bin shares the event class of the passed bin
+/// and corresponds to the group of its channel.
+///
+/// \param bin the interested bin number
+/// \return the associated group bin, -1 if groups are not used
+Long64_t CorrectionProfileChannelizedIngress::GetGrpBinOfBin(Long64_t bin) {
+  Int_t nChannel = GetChannel(bin);
+  if (!fUseGroups || nChannel < 0) return -1;
+  std::vector<Int_t> binsArray(fEventClassVariables.GetSize() + 1);
+  fValues->GetBinContent(bin, binsArray.data());
+  binsArray.back() = fGroupMap[fChannelGroup[nChannel]] + 1;
+  return fGroupValues->GetBin(binsArray.data());
+}
+
 /// Get the group bin content for the passed bin number
 ///
 /// The bin number identifies a desired event class whose group content
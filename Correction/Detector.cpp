@@ -40,7 +40,8 @@ Detector::Detector(const Detector &other) :
     histograms_(other.histograms_),
     axes_(other.axes_),
     correction_on_q_vector(other.correction_on_q_vector),
-    correction_on_input_data(other.correction_on_input_data) {
+    correction_on_input_data(other.correction_on_input_data),
+    channel_groups_(other.channel_groups_) {
 }
 
 /**
@@ -55,19 +56,20 @@ void Detector::Initialize(DetectorList &detectors, InputVariableManager &var, Co
   var.InitVariable(phi_);
   var.InitVariable(weight_);
   var.InitVariable(radial_offset_);
-  int ibin = 0;
-  for (auto &event : sub_events_) {
-    if (type_==DetectorType::CHANNEL) {
-      event = std::make_unique<SubEventChannels>(ibin, &correction_axis, nchannels_, harmonics_bits_);
-      if (channel_groups_.empty()) {
-        for (int i = 0; i < nchannels_; ++i) {
-          channel_groups_.push_back(0);
-        }
+  if (type_==DetectorType::CHANNEL) {
+    sub_event_storage_.Create<SubEventChannels>(sub_events_.size(), &correction_axis, nchannels_, harmonics_bits_);
+    if (channel_groups_.empty()) {
+      for (int i = 0; i < nchannels_; ++i) {
+        channel_groups_.push_back(0);
       }
-      event->SetChannelsScheme(channel_groups_);
-    } else if (type_==DetectorType::TRACK) {
-      event = std::make_unique<SubEventTracks>(ibin, &correction_axis, harmonics_bits_);
     }
+  } else if (type_==DetectorType::TRACK) {
+    sub_event_storage_.Create<SubEventTracks>(sub_events_.size(), &correction_axis, harmonics_bits_);
+  }
+  int ibin = 0;
+  for (auto &event : sub_events_) {
+    event = sub_event_storage_[ibin];
+    if (type_==DetectorType::CHANNEL) event->SetChannelsScheme(channel_groups_);
     event->SetDetector(this);
     for (int i = 0; i < correction_on_input_data.GetEntriesFast(); ++i) {
       event->AddCorrectionOnInputData(dynamic_cast<CorrectionOnInputData *>(correction_on_input_data.At(i))->MakeCopy());
@@ -77,12 +79,14 @@ void Detector::Initialize(DetectorList &detectors, InputVariableManager &var, Co
     }
     ++ibin;
   }
+  CollectCorrectionSteps();
   if (!sub_events_.IsIntegrated()) {
     for (const auto &axis : sub_events_.GetAxes()) {
       input_variables_.push_back(var.FindVariable(axis.Name()));
     }
     coordinates_.resize(input_variables_.size());
   }
+  if (type_==DetectorType::CHANNEL) data_vectors_.Reserve(nchannels_);
   // Initialize the cuts
   cuts_.Initialize(var);
   int_cuts_.Initialize(var);
@@ -97,7 +101,8 @@ TList *Detector::CreateQAHistogramList(bool fill_qa, bool fill_validation) {
   detector_qa->SetOwner(true);
   detector_qa->SetName("detector_QA");
   int_cuts_.CreateCutReport(name_ + ":", 1);
-  cuts_.CreateCutReport(name_ + ":", phi_.size());
+  // the report of the tracks sums over all tracks.
+  cuts_.CreateCutReport(name_ + ":", type_==DetectorType::TRACK ? 1 : phi_.size());
   int_cuts_.AddToList(detector_qa);
   cuts_.AddToList(detector_qa);
   histograms_.AddToList(detector_qa);
@@ -121,65 +126,297 @@ TList *Detector::CreateQAHistogramList(bool fill_qa, bool fill_validation) {
   return list;
 }
 
+/**
+ * Groups the data vectors of the current event by sub-event with a counting sort.
+ * Each sub-event receives a contiguous range of the arena. The order of the data vectors inside a sub-event is the
+ * order of filling. The buffers keep their capacity, so that they are allocated only in the first events of the run.
+ */
+void Detector::GroupDataVectors() {
+  const auto n_bins = sub_events_.size();
+  if (n_bins==1) {
+    sub_events_.At(0)->SetDataVectors({data_vectors_, 0, data_vectors_.size()});
+    return;
+  }
+  arena_.Group(data_vectors_, data_vector_bins_.data(), n_bins, bin_offsets_, bin_positions_);
+  for (std::size_t ibin = 0; ibin < n_bins; ++ibin) {
+    sub_events_.At(ibin)->SetDataVectors({arena_, bin_offsets_[ibin], bin_offsets_[ibin + 1]});
+  }
+}
+
+/**
+ * Collects the correction steps of all sub-events into flat tables ordered by step and then by sub-event.
+ * All sub-events are configured with the same correction steps.
+ */
+void Detector::CollectCorrectionSteps() {
+  const auto n_bins = sub_events_.size();
+  std::vector<std::vector<CorrectionBase *>> input_steps(n_bins);
+  std::vector<std::vector<CorrectionBase *>> q_vector_steps(n_bins);
+  for (std::size_t ibin = 0; ibin < n_bins; ++ibin) {
+    sub_events_.At(ibin)->FillInputCorrectionSteps(input_steps[ibin]);
+    sub_events_.At(ibin)->FillQnVectorCorrectionSteps(q_vector_steps[ibin]);
+    if (input_steps[ibin].size()!=input_steps[0].size() || q_vector_steps[ibin].size()!=q_vector_steps[0].size()) {
+      throw std::logic_error(name_ + ": all sub-events need to be configured with the same correction steps.");
+    }
+  }
+  auto transpose = [n_bins](const std::vector<std::vector<CorrectionBase *>> &steps,
+                            std::vector<CorrectionBase *> &table) {
+    const auto n_steps = n_bins > 0 ? steps[0].size() : 0;
+    table.resize(n_steps*n_bins);
+    for (std::size_t ibin = 0; ibin < n_bins; ++ibin) {
+      for (std::size_t istep = 0; istep < n_steps; ++istep) {
+        table[istep*n_bins + ibin] = steps[ibin][istep];
+      }
+    }
+  };
+  transpose(input_steps, input_correction_steps_);
+  transpose(q_vector_steps, q_vector_correction_steps_);
+  sub_event_applied_.assign(n_bins, true);
+}
+
+/**
+ * Applies a chain of correction steps one step at a time to all sub-events.
+ * Each step processes all sub-events in one call. A sub-event leaves the chain at the first correction step, which
+ * is not applied.
+ * @param steps correction steps [step][bin]
+ */
+void Detector::ApplyCorrectionSteps(const std::vector<CorrectionBase *> &steps) {
+  const auto n_bins = sub_event_applied_.size();
+  for (std::size_t first = 0; first < steps.size(); first += n_bins) {
+    steps[first]->ProcessCorrectionsBatch(&steps[first], n_bins, sub_event_applied_.data());
+  }
+}
+
+/**
+ * Collects the data of a chain of correction steps one step at a time over all sub-events.
+ * A sub-event leaves the chain at the first correction step, which is not applied.
+ * @param steps correction steps [step][bin]
+ */
+void Detector::CollectCorrectionData(const std::vector<CorrectionBase *> &steps) {
+  const auto n_bins = sub_event_applied_.size();
+  for (std::size_t first = 0; first < steps.size(); first += n_bins) {
+    for (std::size_t ibin = 0; ibin < n_bins; ++ibin) {
+      if (sub_event_applied_[ibin]) sub_event_applied_[ibin] = steps[first + ibin]->ProcessDataCollection();
+    }
+  }
+}
+
+/**
+ * Processes the corrections of the current event.
+ * Instead of running all correction steps of one sub-event after another, each correction step is run over all
+ * sub-events in one loop. The order of the correction steps within a sub-event is the same as in
+ * SubEvent::ProcessCorrections and SubEvent::ProcessDataCollection.
+ */
 void Detector::ProcessCorrections() {
-  for (auto &ev : sub_events_) { ev->ProcessCorrections(); }
-  for (auto &ev : sub_events_) { ev->ProcessDataCollection(); }
+  GroupDataVectors();
+  const auto n_bins = sub_events_.size();
+  std::fill(sub_event_applied_.begin(), sub_event_applied_.end(), true);
+  for (std::size_t ibin = 0; ibin < n_bins; ++ibin) { sub_events_[ibin]->BuildRawQnVector(); }
+  ApplyCorrectionSteps(input_correction_steps_);
+  for (std::size_t ibin = 0; ibin < n_bins; ++ibin) {
+    if (sub_event_applied_[ibin]) sub_events_[ibin]->BuildQnVector();
+  }
+  ApplyCorrectionSteps(q_vector_correction_steps_);
+  std::fill(sub_event_applied_.begin(), sub_event_applied_.end(), true);
+  CollectCorrectionData(input_correction_steps_);
+  for (std::size_t ibin = 0; ibin < n_bins; ++ibin) {
+    if (sub_event_applied_[ibin]) sub_events_[ibin]->FillQAHistograms();
+  }
+  CollectCorrectionData(q_vector_correction_steps_);
   // passes the corrected Q-vectors to the output container.
-  for (auto &pair_step_qvector : q_vectors_) {
-    for (unsigned int i = 0; i < sub_events_.size(); ++i) {
-      try {
-        (*pair_step_qvector.second)[i] = *sub_events_[i]->GetQVector(pair_step_qvector.first);
-      } catch (std::out_of_range &) {
-        throw std::out_of_range(name_ + " bin " + std::to_string(i) + " correctionstep: " +
-            kCorrectionStepNamesArray[pair_step_qvector.first] + "not found.");
-      }
+  // The sources are resolved in IncludeQnVectors and the outputs already hold storage for all harmonics.
+  for (std::size_t step = 0; step < kNCorrectionSteps; ++step) {
+    const auto &sources = q_vector_sources_[step];
+    if (sources.empty()) continue;
+    auto &q_vectors = *q_vectors_[step];
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+      q_vectors[i] = *sources[i];
     }
   }
+  for (auto &step_flat_q_vector : flat_q_vectors_) {
+    step_flat_q_vector.second.Fill(*q_vectors_[step_flat_q_vector.first]);
+  }
+#ifdef QN_RNTUPLE
+  for (auto &step_flat_q_vector : ntuple_q_vectors_) {
+    step_flat_q_vector.second.Fill(*q_vectors_[step_flat_q_vector.first]);
+  }
+#endif
 }
 
-void Detector::AttachToTree(TTree *tree) {
-  for (const auto &qvec : q_vectors_) {
-    auto is_output_variable = std::find(output_tree_q_vectors_.begin(), output_tree_q_vectors_.end(), qvec.first);
+/**
+ * Creates the branches of the output Q-vectors.
+ * @param tree output tree
+ * @param flat if true, the Q-vectors are written in the flat layout with one array branch per component.
+ * Otherwise each Q-vector is written as a DataContainerQVector object.
+ */
+void Detector::AttachToTree(TTree *tree, bool flat) {
+  for (std::size_t i_step = 0; i_step < kNCorrectionSteps; ++i_step) {
+    if (!q_vectors_[i_step]) continue;
+    auto step = static_cast<QVector::CorrectionStep>(i_step);
+    auto is_output_variable = std::find(output_tree_q_vectors_.begin(), output_tree_q_vectors_.end(), step);
     if (is_output_variable!=output_tree_q_vectors_.end()) {
-      auto suffix = kCorrectionStepNamesArray[qvec.first];
+      auto suffix = kCorrectionStepNamesArray[step];
       auto name = name_ + "_" + suffix;
-      tree->Branch(name.data(), qvec.second.get());
+      if (flat) {
+        if (flat_q_vectors_.find(step)!=flat_q_vectors_.end()) continue;
+        auto flat_q_vector = flat_q_vectors_.emplace(std::piecewise_construct,
+                                                     std::forward_as_tuple(step),
+                                                     std::forward_as_tuple(name, *q_vectors_[step], harmonics_bits_));
+        flat_q_vector.first->second.AttachToTree(tree);
+      } else {
+        tree->Branch(name.data(), q_vectors_[step].get());
+      }
     }
   }
 }
 
-void Detector::IncludeQnVectors() {
+#ifdef QN_RNTUPLE
+/**
+ * Adds the output Q-vectors in the flat layout to the RNTuple.
+ * The RNTuple has its own flat arrays, so it receives all output Q-vectors also when a flat tree is filled as well.
+ * @param ntuple output RNTuple, which is not yet connected.
+ */
+void Detector::AttachToNTuple(OutputNTuple &ntuple) {
+  for (std::size_t i_step = 0; i_step < kNCorrectionSteps; ++i_step) {
+    if (!q_vectors_[i_step]) continue;
+    auto step = static_cast<QVector::CorrectionStep>(i_step);
+    if (ntuple_q_vectors_.find(step)!=ntuple_q_vectors_.end()) continue;
+    auto name = name_ + "_" + kCorrectionStepNamesArray[step];
+    auto flat_q_vector = ntuple_q_vectors_.emplace(std::piecewise_construct,
+                                                 std::forward_as_tuple(step),
+                                                 std::forward_as_tuple(name, *q_vectors_[step], harmonics_bits_));
+    ntuple.AddQVectors(&flat_q_vector.first->second);
+  }
+}
+#endif
+
+/**
+ * Includes the Q-vectors of the active correction steps.
+ * The Q-vectors of the sub-events, which are copied to the output containers, are looked up once. The output
+ * containers are initialized with them, so that copying them in every event does not allocate memory.
+ * @param fill_output if true, output containers are created for the correction steps requested for the output.
+ */
+void Detector::IncludeQnVectors(bool fill_output) {
   for (auto &ev : sub_events_) { ev->IncludeQnVectors(); }
-  // Adds DataContainerQVector for each of the active correction steps.
+  for (auto &sources : q_vector_sources_) { sources.clear(); }
+  for (std::size_t step = 0; step < kNCorrectionSteps; ++step) {
+    if (q_vectors_[step]) AddQVectorContainer(static_cast<QVector::CorrectionStep>(step));
+  }
+  if (!fill_output) return;
+  // Adds DataContainerQVector for each of the active correction steps, which is requested for the output.
   auto correction_steps = sub_events_[0]->GetCorrectionSteps();
   for (auto correction_step : correction_steps) {
+    auto is_output = std::find(output_tree_q_vectors_.begin(), output_tree_q_vectors_.end(), correction_step);
+    if (is_output==output_tree_q_vectors_.end()) continue;
+    if (q_vectors_[correction_step]) continue;
+    AddQVectorContainer(correction_step);
+  }
+}
+
+/**
+ * Creates the container of the Q-vectors of a correction step, if it does not exist yet, and looks up the Q-vectors
+ * of the sub-events, which are copied to it in every event.
+ * @param step correction step
+ */
+void Detector::AddQVectorContainer(QVector::CorrectionStep step) {
+  std::vector<const QVector *> sources;
+  for (unsigned int i = 0; i < sub_events_.size(); ++i) {
+    try {
+      sources.push_back(sub_events_[i]->GetQVector(step));
+    } catch (std::out_of_range &) {
+      throw std::out_of_range(name_ + " bin " + std::to_string(i) + " correctionstep: " +
+          kCorrectionStepNamesArray[step] + " not found.");
+    }
+  }
+  if (!q_vectors_[step]) {
     if (sub_events_.IsIntegrated()) {
-      q_vectors_.emplace(correction_step, std::make_unique<DataContainerQVector>());
+      q_vectors_[step] = std::make_unique<DataContainerQVector>();
     } else {
-      q_vectors_.emplace(correction_step, std::make_unique<DataContainerQVector>(sub_events_.GetAxes()));
+      q_vectors_[step] = std::make_unique<DataContainerQVector>(sub_events_.GetAxes());
     }
   }
+  for (std::size_t i = 0; i < sources.size(); ++i) { (*q_vectors_[step])[i] = *sources[i]; }
+  q_vector_sources_[step] = std::move(sources);
+}
+
+/**
+ * Returns the Q-vectors of the current event of a correction step.
+ * The Q-vectors of steps, which are not requested as output, are looked up in the sub-events on the first request.
+ * Afterwards they are copied to their container in every event like the output Q-vectors.
+ * @param step correction step
+ * @return container of the Q-vectors. Lifetime is managed by the detector.
+ */
+DataContainerQVector *Detector::GetQVector(QVector::CorrectionStep step) {
+  if (!q_vectors_[step]) AddQVectorContainer(step);
+  return q_vectors_[step].get();
 }
 
 void Detector::FillData() {
   if (!int_cuts_.CheckCuts(0)) return;
   histograms_.Fill();
-  for (std::size_t channel = 0; channel < phi_.size(); ++channel) {
-    if (!cuts_.CheckCuts(channel)) continue;
-    /// Integrated case (detector only has one bin)
-    if (input_variables_.empty()) {
-      sub_events_.At(0)->AddDataVector(channel, phi_[channel], weight_[channel], radial_offset_[channel]);
-      /// differential case (detector has more than one bin)
-    } else {
-      for (std::size_t coordinate = 0; coordinate < input_variables_.size(); ++coordinate) {
-        coordinates_.at(coordinate) = input_variables_[coordinate][channel];
-      }
-      const auto ibin = sub_events_.FindBin(coordinates_);
-      if (ibin > -1) {
-        sub_events_.At(ibin)->AddDataVector(channel, phi_[channel], weight_[channel], radial_offset_[channel]);
-      }
+  const auto &channels = cuts_.Evaluate(phi_.GetLength());
+  /// Integrated case (detector only has one bin)
+  if (input_variables_.empty()) {
+    for (auto channel : channels) {
+      AddDataVector(0, channel, phi_[channel], weight_[channel], radial_offset_[channel]);
+    }
+    return;
+  }
+  /// differential case (detector has more than one bin)
+  for (auto channel : channels) {
+    for (std::size_t coordinate = 0; coordinate < input_variables_.size(); ++coordinate) {
+      coordinates_[coordinate] = input_variables_[coordinate][channel];
+    }
+    const auto ibin = sub_events_.FindBin(coordinates_);
+    if (ibin > -1) {
+      AddDataVector(ibin, channel, phi_[channel], weight_[channel], radial_offset_[channel]);
+    }
+  }
+}
+
+/**
+ * Selects the tracks of the current event.
+ * The integrated and the per track cuts are each evaluated once over the track columns of the variable manager. The
+ * QA histograms are filled with the tracks which pass the integrated cuts, as when the tracks are filled one by one.
+ * @param n_tracks number of tracks of the event
+ */
+void Detector::SelectTracks(std::size_t n_tracks) {
+  int_cuts_.CheckCuts(n_tracks, track_selection_);
+  if (histograms_.IsFilled()) {
+    Selection::Compact(track_selection_.data(), track_selection_.size(), selected_tracks_);
+    histograms_.Fill(selected_tracks_);
+  }
+  cuts_.Select(n_tracks, track_selection_);
+  Selection::Compact(track_selection_.data(), track_selection_.size(), selected_tracks_);
+}
+
+/**
+ * Fills the selected tracks of the current event into the sub-events.
+ * The bin lookup and the filling of the data vectors run in one loop per detector over the track columns.
+ * @param tracks columns of the track variables of the current event
+ */
+void Detector::FillTracks(const TrackColumns &tracks) {
+  const auto phi = tracks.Find(phi_);
+  const auto weight = tracks.Find(weight_);
+  const auto radial_offset = tracks.Find(radial_offset_);
+  /// Integrated case (detector only has one bin)
+  if (input_variables_.empty()) {
+    for (const auto i : selected_tracks_) {
+      AddDataVector(0, 0, phi[i], weight[i], radial_offset[i]);
+    }
+    return;
+  }
+  /// differential case (detector has more than one bin)
+  track_coordinates_.clear();
+  for (const auto &variable : input_variables_) { track_coordinates_.push_back(tracks.Find(variable)); }
+  for (const auto i : selected_tracks_) {
+    for (std::size_t coordinate = 0; coordinate < track_coordinates_.size(); ++coordinate) {
+      coordinates_[coordinate] = track_coordinates_[coordinate][i];
+    }
+    const auto ibin = sub_events_.FindBin(coordinates_);
+    if (ibin > -1) {
+      AddDataVector(ibin, 0, phi[i], weight[i], radial_offset[i]);
     }
   }
 }
 
-}
\ No newline at end of file
+}
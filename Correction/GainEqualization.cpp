@@ -37,6 +37,7 @@
 #include "CorrectionHistogramChannelizedSparse.h"
 #include "SubEventChannels.h"
 #include "GainEqualization.h"
+#include "CorrectionParameterFile.h"
 #include "ROOT/RMakeUnique.hxx"
 /// \cond CLASSIMP
 ClassImp(Qn::GainEqualization);
@@ -60,6 +61,123 @@ void GainEqualization::AttachInput(TList *list) {
                                          ownerConfiguration->GetChannelsGroups())) {
     fState = State::APPLYCOLLECT;
     fHardCodedWeights = ownerConfiguration->GetHardCodedGroupWeights();
+    fGainTableBin = -1;
+    fParametersFromFile = kFALSE;
+    FreezeInput();
+  }
+}
+
+/// Attaches the frozen correction parameters to the correction step
+///
+/// Without calibration histograms the equalization is applied
+/// with the per channel gain table.
+/// The table is only used if it matches the event classes and the channels of the step.
+/// \param parameters file containing the correction parameter tables
+/// \param run name of the current run
+void GainEqualization::AttachInput(const CorrectionParameterFile &parameters, const std::string &run) {
+  if (parameters.Read(run, fSubEvent->GetName(), GetName(), fCalibrationHistograms->GetNoOfBins(), 2, 1, 0,
+                      fParameters)) {
+    fState = State::APPLYCOLLECT;
+    fGainTableBin = -1;
+    fParametersFromFile = kTRUE;
+  }
+}
+
+/// Freezes the calibration information into the table of correction parameters
+///
+/// For each validated event class and channel the equalization is stored
+/// as a factor and an offset so that M' = factor * M + offset.
+void GainEqualization::FreezeInput() {
+  auto nNoOfBins = fInputHistograms->GetNoOfBins();
+  fParameters.Reset(nNoOfBins, 2, 1);
+  for (Long64_t bin = 0; bin < nNoOfBins; ++bin) {
+    if (!fInputHistograms->BinContentValidated(bin)) continue;
+    Int_t channel = fInputHistograms->GetChannel(bin);
+    if (channel < 0) continue;
+    fParameters.SetValidated(bin);
+    auto parameters = fParameters.Parameters(bin, 0);
+    parameters[0] = 1.0;
+    parameters[1] = 0.0;
+    Double_t average = fInputHistograms->GetBinContent(bin);
+    /* let's handle the potential group weights usage */
+    Double_t groupweight = 1.0;
+    if (fUseChannelGroupsWeights) {
+      groupweight = fInputHistograms->GetGrpBinContent(fInputHistograms->GetGrpBinOfBin(bin));
+    } else {
+      if (fHardCodedWeights) {
+        groupweight = fHardCodedWeights[channel];
+      }
+    }
+    if (!(fMinimumSignificantValue < average)) {
+      parameters[0] = 0.0;
+      continue;
+    }
+    if (fEqualizationMethod==Method::AVERAGE) {
+      parameters[0] = groupweight/average;
+    } else if (fEqualizationMethod==Method::WIDTH) {
+      Double_t width = fInputHistograms->GetBinError(bin);
+      parameters[0] = fScale*groupweight/width;
+      parameters[1] = (fShift - fScale*average/width)*groupweight;
+    }
+  }
+}
+
+/// Rebuilds the gain table if the event class changed since the last event.
+///
+/// The event class is identified by the bin of a reference channel, which
+/// requires a single histogram lookup per event. If the sub-event has no used
+/// channel the table keeps all weights. The calibration histograms
+/// share the binning of the input histograms and are also available when
+/// the parameters are read from a correction parameter file.
+void GainEqualization::UpdateGainTable() {
+  if (fGainTableChannel < 0) {
+    auto ownerConfiguration = dynamic_cast<SubEventChannels *>(fSubEvent);
+    auto used = ownerConfiguration->GetUsedChannelsMask();
+    for (Int_t channel = 0; channel < ownerConfiguration->GetNoOfChannels(); ++channel) {
+      if (used[channel]) {
+        fGainTableChannel = channel;
+        break;
+      }
+    }
+    /* without a used channel there is no event class bin: all weights are kept */
+    if (fGainTableChannel < 0) {
+      if (fGainFactors.empty()) BuildGainTable();
+      return;
+    }
+  }
+  auto bin = fCalibrationHistograms->GetBin(fGainTableChannel);
+  if (bin!=fGainTableBin || fGainFactors.empty()) {
+    BuildGainTable();
+    fGainTableBin = bin;
+  }
+}
+
+/// Builds the equalization factor and offset of every channel for the current event class.
+///
+/// The equalized weight is obtained as factor * weight + offset.
+/// Channels without validated calibration keep their weight. The bins
+/// of the channels are kept to count the entries without validated calibration.
+void GainEqualization::BuildGainTable() {
+  auto ownerConfiguration = dynamic_cast<SubEventChannels *>(fSubEvent);
+  const auto nChannels = ownerConfiguration->GetNoOfChannels();
+  auto used = ownerConfiguration->GetUsedChannelsMask();
+  fGainFactors.assign(nChannels, 1.0);
+  fGainOffsets.assign(nChannels, 0.0);
+  fGainValidated.assign(nChannels, false);
+  fGainBins.assign(nChannels, -1);
+  fGainAllValidated = kTRUE;
+  for (Int_t channel = 0; channel < nChannels; ++channel) {
+    if (!used[channel]) continue;
+    Long64_t bin = fCalibrationHistograms->GetBin(channel);
+    fGainBins[channel] = bin;
+    if (!fParameters.Validated(bin)) {
+      fGainAllValidated = kFALSE;
+      continue;
+    }
+    fGainValidated[channel] = true;
+    auto parameters = fParameters.Parameters(bin, 0);
+    fGainFactors[channel] = parameters[0];
+    fGainOffsets[channel] = parameters[1];
   }
 }
 
@@ -136,6 +254,18 @@ void GainEqualization::AttachNveQAHistograms(TList *list) {
   fQANotValidatedBin->CreateChannelizedHistogram(list, sub_event->GetUsedChannelsMask());
 }
 
+/// Fills the non validated entries QA histograms
+///
+/// The entries without validated calibration are counted per event class
+/// and channel in the table of correction parameters. The counters are
+/// transferred to the histogram and restarted.
+void GainEqualization::FillNveQAHistograms() {
+  if (fQANotValidatedBin) {
+    fQANotValidatedBin->FillCounts(fParameters.GetFailures());
+    fParameters.ResetFailures();
+  }
+}
+
 /// Processes the correction step
 ///
 /// Data are always taken from the data bank from the equalized weights
@@ -147,91 +277,79 @@ void GainEqualization::AttachNveQAHistograms(TList *list) {
 /// \return kTRUE if the correction step was applied
 bool GainEqualization::ProcessCorrections() {
   bool applied = false;
+  auto &bank = fSubEvent->GetInputDataBank();
+  const auto ids = bank.Ids();
+  const auto weights = bank.EqualizedWeights();
+  const auto n = bank.size();
   switch (fState) {
     case State::CALIBRATION:
       /* collect the data needed to further produce equalization parameters */
-      for (const auto &dataVector : fSubEvent->GetInputDataBank()) {
-        fCalibrationHistograms->Fill(dataVector.GetId(), dataVector.EqualizedWeight());
+      for (std::size_t i = 0; i < n; ++i) {
+        fCalibrationHistograms->Fill(ids[i], weights[i]);
       }
       break;
     case State::APPLYCOLLECT:
       /* collect the data needed to further produce equalization parameters */
-      for (const auto &dataVector : fSubEvent->GetInputDataBank()) {
-        fCalibrationHistograms->Fill(dataVector.GetId(), dataVector.EqualizedWeight());
-      }
       /* and proceed to ... */
       /* FALLTHRU */
     case State::APPLY: /* apply the equalization */
-      /* collect QA data if asked */
-      if (fQAMultiplicityBefore) {
-        for (const auto &dataVector : fSubEvent->GetInputDataBank()) {
-          fQAMultiplicityBefore->Fill(dataVector.GetId(), dataVector.EqualizedWeight());
-        }
-      }
+      FillBeforeEqualization();
       /* store the equalized weights in the data vector bank according to equalization method */
-      switch (fEqualizationMethod) {
+      if (UsesGainTable()) {
+        UpdateGainTable();
+        EqualizeWithGainTable();
+      } else switch (fEqualizationMethod) {
         case Method::NONE:
-          for (auto &dataVector : fSubEvent->GetInputDataBank()) {
-            dataVector.SetEqualizedWeight(dataVector.EqualizedWeight());
-          }
           break;
         case Method::AVERAGE:
-          for (auto &dataVector : fSubEvent->GetInputDataBank()) {
-            Long64_t bin = fInputHistograms->GetBin(dataVector.GetId());
+          for (std::size_t i = 0; i < n; ++i) {
+            Long64_t bin = fInputHistograms->GetBin(ids[i]);
             if (fInputHistograms->BinContentValidated(bin)) {
               Float_t average = fInputHistograms->GetBinContent(bin);
               /* let's handle the potential group weights usage */
               Float_t groupweight = 1.0;
               if (fUseChannelGroupsWeights) {
-                groupweight = fInputHistograms->GetGrpBinContent(fInputHistograms->GetGrpBin(dataVector.GetId()));
+                groupweight = fInputHistograms->GetGrpBinContent(fInputHistograms->GetGrpBin(ids[i]));
               } else {
                 if (fHardCodedWeights) {
-                  groupweight = fHardCodedWeights[dataVector.GetId()];
+                  groupweight = fHardCodedWeights[ids[i]];
                 }
               }
               if (fMinimumSignificantValue < average)
-                dataVector.SetEqualizedWeight((dataVector.EqualizedWeight()/average)*groupweight);
+                weights[i] = (weights[i]/average)*groupweight;
               else
-                dataVector.SetEqualizedWeight(0.0);
+                weights[i] = 0.0;
             } else {
-              if (fQANotValidatedBin) fQANotValidatedBin->Fill(dataVector.GetId(), 1.0);
+              if (fQANotValidatedBin) fParameters.CountFailure(bin);
             }
           }
           break;
         case Method::WIDTH:
-          for (auto &dataVector : fSubEvent->GetInputDataBank()) {
-            Long64_t bin = fInputHistograms->GetBin(dataVector.GetId());
+          for (std::size_t i = 0; i < n; ++i) {
+            Long64_t bin = fInputHistograms->GetBin(ids[i]);
             if (fInputHistograms->BinContentValidated(bin)) {
-              Float_t average =
-                  fInputHistograms->GetBinContent(fInputHistograms->GetBin(dataVector.GetId()));
-              Float_t width =
-                  fInputHistograms->GetBinError(fInputHistograms->GetBin(dataVector.GetId()));
+              Float_t average = fInputHistograms->GetBinContent(bin);
+              Float_t width = fInputHistograms->GetBinError(bin);
               /* let's handle the potential group weights usage */
               Float_t groupweight = 1.0;
               if (fUseChannelGroupsWeights) {
-                groupweight = fInputHistograms->GetGrpBinContent(fInputHistograms->GetGrpBin(dataVector.GetId()));
+                groupweight = fInputHistograms->GetGrpBinContent(fInputHistograms->GetGrpBin(ids[i]));
               } else {
                 if (fHardCodedWeights) {
-                  groupweight = fHardCodedWeights[dataVector.GetId()];
+                  groupweight = fHardCodedWeights[ids[i]];
                 }
               }
               if (fMinimumSignificantValue < average)
-                dataVector.SetEqualizedWeight(
-                    (fShift + fScale*(dataVector.EqualizedWeight() - average)/width)*groupweight);
+                weights[i] = (fShift + fScale*(weights[i] - average)/width)*groupweight;
               else
-                dataVector.SetEqualizedWeight(0.0);
+                weights[i] = 0.0;
             } else {
-              if (fQANotValidatedBin) fQANotValidatedBin->Fill(dataVector.GetId(), 1.0);
+              if (fQANotValidatedBin) fParameters.CountFailure(bin);
             }
           }
           break;
       }
-      /* collect QA data if asked */
-      if (fQAMultiplicityAfter) {
-        for (const auto &dataVector : fSubEvent->GetInputDataBank()) {
-          fQAMultiplicityAfter->Fill(dataVector.GetId(), dataVector.EqualizedWeight());
-        }
-      }
+      FillAfterEqualization();
       applied = true;
       break;
     case State::PASSIVE:
@@ -241,6 +359,83 @@ bool GainEqualization::ProcessCorrections() {
   return applied;
 }
 
+/// Processes the correction step of all sub-events of a detector
+///
+/// The gain tables of all sub-events, which equalize with the correction
+/// parameters, are brought up to date first. Then the weights of the sub-events
+/// are equalized one sub-event after the other with the shared kernel, because
+/// each sub-event has its own table of channels. Sub-events, which equalize
+/// directly from the calibration histograms, are processed one by one.
+/// \param steps the gain equalization step of each sub-event
+/// \param n the number of sub-events
+/// \param applied per sub-event, true if the previous correction steps were applied
+void GainEqualization::ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied) {
+  fBatchUsesGainTable.assign(n, false);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!applied[i]) continue;
+    auto step = static_cast<GainEqualization *>(steps[i]);
+    if ((step->fState!=State::APPLY && step->fState!=State::APPLYCOLLECT) || !step->UsesGainTable()) {
+      applied[i] = step->ProcessCorrections();
+      continue;
+    }
+    fBatchUsesGainTable[i] = true;
+    step->FillBeforeEqualization();
+    step->UpdateGainTable();
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!fBatchUsesGainTable[i]) continue;
+    auto step = static_cast<GainEqualization *>(steps[i]);
+    step->EqualizeWithGainTable();
+    step->FillAfterEqualization();
+  }
+}
+
+/// Fills the calibration histograms in the APPLYCOLLECT state and the QA histograms before the equalization
+void GainEqualization::FillBeforeEqualization() {
+  auto &bank = fSubEvent->GetInputDataBank();
+  const auto ids = bank.Ids();
+  const auto weights = bank.EqualizedWeights();
+  const auto n = bank.size();
+  if (fState==State::APPLYCOLLECT) {
+    for (std::size_t i = 0; i < n; ++i) {
+      fCalibrationHistograms->Fill(ids[i], weights[i]);
+    }
+  }
+  /* collect QA data if asked */
+  if (fQAMultiplicityBefore) {
+    for (std::size_t i = 0; i < n; ++i) {
+      fQAMultiplicityBefore->Fill(ids[i], weights[i]);
+    }
+  }
+}
+
+/// Equalizes the weights with the gain table of the current event class
+///
+/// The entries of channels without validated calibration are counted.
+void GainEqualization::EqualizeWithGainTable() {
+  auto &bank = fSubEvent->GetInputDataBank();
+  const auto ids = bank.Ids();
+  const auto n = bank.size();
+  CorrectionKernels::Equalize(n, ids, fGainFactors.data(), fGainOffsets.data(), bank.EqualizedWeights());
+  if (fQANotValidatedBin && !fGainAllValidated) {
+    const auto bins = fGainBins.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!fGainValidated[ids[i]]) fParameters.CountFailure(bins[ids[i]]);
+    }
+  }
+}
+
+/// Fills the QA histograms after the equalization
+void GainEqualization::FillAfterEqualization() {
+  if (!fQAMultiplicityAfter) return;
+  auto &bank = fSubEvent->GetInputDataBank();
+  const auto ids = bank.Ids();
+  const auto weights = bank.EqualizedWeights();
+  for (std::size_t i = 0; i < bank.size(); ++i) {
+    fQAMultiplicityAfter->Fill(ids[i], weights[i]);
+  }
+}
+
 /// Processes the correction data collection step
 ///
 /// Data are always taken from the data bank from the equalized weights
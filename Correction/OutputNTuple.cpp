@@ -0,0 +1,96 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "TObjString.h"
+
+#include "OutputNTuple.h"
+
+namespace Qn {
+
+OutputNTuple::OutputNTuple(std::string name, TFile *file, int compression) :
+    name_(std::move(name)),
+    file_(file),
+    compression_(compression),
+    model_(ROOT::Experimental::RNTupleModel::Create()),
+    prototypes_(std::make_unique<TMap>()) {
+  if (!file_) throw std::invalid_argument("The output file of the RNTuple " + name_ + " is not valid.");
+  prototypes_->SetOwnerKeyValue(true, true);
+}
+
+OutputNTuple::~OutputNTuple() = default;
+
+void OutputNTuple::CheckNotConnected(const std::string &name) const {
+  if (writer_) {
+    throw std::logic_error("Field " + name + " cannot be added after the RNTuple " + name_ + " is connected.");
+  }
+}
+
+void OutputNTuple::AddVariable(const std::string &name, const Double32_t *value) {
+  CheckNotConnected(name);
+  auto field = model_->MakeField<double>(name);
+  copy_functions_.emplace_back([field, value]() { *field = *value; });
+}
+
+void OutputNTuple::AddVariable(const std::string &name, const Long64_t *value) {
+  CheckNotConnected(name);
+  auto field = model_->MakeField<std::int64_t>(name);
+  copy_functions_.emplace_back([field, value]() { *field = *value; });
+}
+
+void OutputNTuple::AddQVectors(FlatQVectors *q_vectors) {
+  const auto name = q_vectors->GetName();
+  CheckNotConnected(name);
+  auto add_field = [this](const std::string &field_name, const auto &array) {
+    using Array = std::decay_t<decltype(array)>;
+    auto field = model_->MakeField<Array>(field_name);
+    copy_functions_.emplace_back([field, &array]() { *field = array; });
+  };
+  add_field(name + "_sumweights", q_vectors->GetSumWeights());
+  add_field(name + "_n", q_vectors->GetN());
+  const auto &harmonics = q_vectors->GetHarmonics();
+  for (std::size_t ih = 0; ih < harmonics.size(); ++ih) {
+    const auto harmonic = std::to_string(harmonics[ih]);
+    add_field(name + "_x" + harmonic, q_vectors->GetX(ih));
+    add_field(name + "_y" + harmonic, q_vectors->GetY(ih));
+  }
+  prototypes_->Add(new TObjString(name.data()), q_vectors->CreateOutputPrototype());
+}
+
+void OutputNTuple::Connect() {
+  if (writer_) return;
+  ROOT::Experimental::RNTupleWriteOptions options;
+  options.SetCompression(compression_);
+  writer_ = ROOT::Experimental::RNTupleWriter::Append(std::move(model_), name_, *file_, options);
+}
+
+void OutputNTuple::Fill() {
+  for (auto &copy : copy_functions_) { copy(); }
+  writer_->Fill();
+}
+
+void OutputNTuple::Finalize() {
+  if (!writer_) return;
+  // the destructor of the writer commits the last cluster.
+  writer_.reset();
+  file_->cd();
+  prototypes_->Write((name_ + "_" + FlatQVectors::kPrototypesName).data(), TObject::kSingleKey);
+}
+
+}
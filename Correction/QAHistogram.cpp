@@ -15,10 +15,113 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+
 #include "QAHistogram.h"
 
 namespace Qn {
 
+namespace Impl {
+namespace {
+/**
+ * Binning of an axis. Uniform axes are binned without the lookup of TAxis::FindBin.
+ */
+class AxisBinning {
+ public:
+  explicit AxisBinning(TAxis *axis) :
+      axis_(axis),
+      n_bins_(axis->GetNbins()),
+      min_(axis->GetXmin()),
+      max_(axis->GetXmax()),
+      uniform_(!axis->IsVariableBinSize()) {}
+  Int_t FindBin(double x) const {
+    if (!uniform_) return axis_->FindBin(x);
+    if (x < min_) return 0;
+    if (!(x < max_)) return n_bins_ + 1;
+    return std::min(1 + static_cast<Int_t>(n_bins_*(x - min_)/(max_ - min_)), n_bins_);
+  }
+  bool IsInRange(Int_t bin) const { return bin > 0 && bin <= n_bins_; }
+  Int_t GetNbins() const { return n_bins_; }
+ private:
+  TAxis *axis_;
+  Int_t n_bins_;
+  double min_;
+  double max_;
+  bool uniform_;
+};
+
+/**
+ * Enables the sum of squared weights if an entry is weighted, as done by TH1::FillN.
+ */
+void EnableSumw2(TH1 *histogram, const std::vector<double> &weights) {
+  if (histogram->GetSumw2N() || histogram->TestBit(TH1::kIsNotW)) return;
+  if (std::any_of(weights.begin(), weights.end(), [](double weight) { return weight!=1.; })) histogram->Sumw2();
+}
+}
+
+void FlushBuffer(TH1F *histogram, QAHistoBuffer<2> &buffer) {
+  const auto n_entries = buffer.size();
+  if (n_entries==0) return;
+  const auto &x = buffer.values[0];
+  const auto &w = buffer.values[1];
+  EnableSumw2(histogram, w);
+  Double_t stats[TH1::kNstat] = {};
+  histogram->GetStats(stats);
+  const AxisBinning x_axis(histogram->GetXaxis());
+  const auto stat_overflows = histogram->GetStatOverflowsBehaviour();
+  auto content = histogram->GetArray();
+  auto sumw2 = histogram->GetSumw2N() ? histogram->GetSumw2()->GetArray() : nullptr;
+  for (std::size_t i = 0; i < n_entries; ++i) {
+    const auto bin = x_axis.FindBin(x[i]);
+    content[bin] += w[i];
+    if (sumw2) sumw2[bin] += w[i]*w[i];
+    if (!stat_overflows && !x_axis.IsInRange(bin)) continue;
+    stats[0] += w[i];
+    stats[1] += w[i]*w[i];
+    stats[2] += w[i]*x[i];
+    stats[3] += w[i]*x[i]*x[i];
+  }
+  histogram->PutStats(stats);
+  histogram->SetEntries(histogram->GetEntries() + n_entries);
+  buffer.clear();
+}
+
+void FlushBuffer(TH2F *histogram, QAHistoBuffer<3> &buffer) {
+  const auto n_entries = buffer.size();
+  if (n_entries==0) return;
+  const auto &x = buffer.values[0];
+  const auto &y = buffer.values[1];
+  const auto &w = buffer.values[2];
+  EnableSumw2(histogram, w);
+  Double_t stats[TH1::kNstat] = {};
+  histogram->GetStats(stats);
+  const AxisBinning x_axis(histogram->GetXaxis());
+  const AxisBinning y_axis(histogram->GetYaxis());
+  const auto stride = x_axis.GetNbins() + 2;
+  const auto stat_overflows = histogram->GetStatOverflowsBehaviour();
+  auto content = histogram->GetArray();
+  auto sumw2 = histogram->GetSumw2N() ? histogram->GetSumw2()->GetArray() : nullptr;
+  for (std::size_t i = 0; i < n_entries; ++i) {
+    const auto x_bin = x_axis.FindBin(x[i]);
+    const auto y_bin = y_axis.FindBin(y[i]);
+    const auto bin = x_bin + stride*y_bin;
+    content[bin] += w[i];
+    if (sumw2) sumw2[bin] += w[i]*w[i];
+    if (!stat_overflows && (!x_axis.IsInRange(x_bin) || !y_axis.IsInRange(y_bin))) continue;
+    stats[0] += w[i];
+    stats[1] += w[i]*w[i];
+    stats[2] += w[i]*x[i];
+    stats[3] += w[i]*x[i]*x[i];
+    stats[4] += w[i]*y[i];
+    stats[5] += w[i]*y[i]*y[i];
+    stats[6] += w[i]*x[i]*y[i];
+  }
+  histogram->PutStats(stats);
+  histogram->SetEntries(histogram->GetEntries() + n_entries);
+  buffer.clear();
+}
+}
+
 QAHistogram::QAHistogram(std::string name, const AxisD &axis, std::string weight) :
     name_(std::move(name)),
     weight_(std::move(weight)),
@@ -37,6 +37,7 @@
 #include "CorrectionProfileComponents.h"
 #include "CorrectionHistogramSparse.h"
 #include "Recentering.h"
+#include "CorrectionParameterFile.h"
 #include "SubEvent.h"
 #include "ROOT/RMakeUnique.hxx"
 
@@ -101,6 +102,49 @@ void Recentering::CreateCorrectionHistograms() {
 void Recentering::AttachInput(TList *list) {
   if (fInputHistograms->AttachHistograms(list)) {
     fState = State::APPLYCOLLECT;
+    FreezeInput();
+  }
+}
+
+/// Attaches the frozen correction parameters to the correction step
+/// \param parameters file containing the correction parameter tables
+/// \param run name of the current run
+///
+/// The table is only used if it matches the event classes and the harmonics of the step.
+void Recentering::AttachInput(const CorrectionParameterFile &parameters, const std::string &run) {
+  if (parameters.Read(run, fSubEvent->GetName(), GetName(), fCalibrationHistograms->GetNoOfBins(), 4,
+                      QVector::kmaxharmonics + 1, fSubEvent->GetHarmonics().to_ullong(), fParameters)) {
+    fState = State::APPLYCOLLECT;
+  }
+}
+
+/// Freezes the calibration information into the table of correction parameters
+///
+/// For each validated event class bin and harmonic the correction is stored as
+/// a factor and an offset per component so that Q' = factor * Q + offset.
+void Recentering::FreezeInput() {
+  auto nNoOfHarmonics = fSubEvent->GetNoOfHarmonics();
+  std::vector<Int_t> harmonicsMap(nNoOfHarmonics);
+  fSubEvent->GetHarmonicMap(harmonicsMap.data());
+  auto nNoOfBins = fInputHistograms->GetNoOfBins();
+  fParameters.Reset(nNoOfBins, 4);
+  fParameters.SetHarmonics(fSubEvent->GetHarmonics().to_ullong());
+  for (Long64_t bin = 0; bin < nNoOfBins; ++bin) {
+    if (!fInputHistograms->BinContentValidated(bin)) continue;
+    fParameters.SetValidated(bin);
+    for (auto harmonic : harmonicsMap) {
+      Double_t widthX = 1.0;
+      Double_t widthY = 1.0;
+      if (fApplyWidthEqualization) {
+        widthX = fInputHistograms->GetXBinError(harmonic, bin);
+        widthY = fInputHistograms->GetYBinError(harmonic, bin);
+      }
+      auto parameters = fParameters.Parameters(bin, harmonic);
+      parameters[0] = 1.0/widthX;
+      parameters[1] = -fInputHistograms->GetXBinContent(harmonic, bin)/widthX;
+      parameters[2] = 1.0/widthY;
+      parameters[3] = -fInputHistograms->GetYBinContent(harmonic, bin)/widthY;
+    }
   }
 }
 
@@ -131,13 +175,25 @@ void Recentering::AttachNveQAHistograms(TList *list) {
   fQANotValidatedBin->CreateHistogram(list);
 }
 
+/// Fills the non validated entries QA histograms
+///
+/// The events without validated calibration are counted per event class
+/// bin in the table of correction parameters. The counters are transferred
+/// to the histogram and restarted.
+void Recentering::FillNveQAHistograms() {
+  if (fQANotValidatedBin) {
+    fQANotValidatedBin->FillCounts(fParameters.GetFailures());
+    fParameters.ResetFailures();
+  }
+}
+
 /// Processes the correction step
 ///
 /// Pure virtual function
 /// \return kTRUE if the correction step was applied
 bool Recentering::ProcessCorrections() {
-  int harmonic;
   bool applied = false;
+  Long64_t bin = -1;
   switch (fState) {
     case State::CALIBRATION:
       /* collect the data needed to further produce correction parameters if the current Qn vector is good enough */
@@ -147,39 +203,7 @@ bool Recentering::ProcessCorrections() {
       /* collect the data needed to further produce correction parameters if the current Qn vector is good enough */
       /* and proceed to ... */
     case State::APPLY: /* apply the correction if the current Qn vector is good enough */
-      if (fSubEvent->GetCurrentQnVector()->IsGoodQuality()) {
-        /* we get the properties of the current Qn vector but its name */
-        fCorrectedQnVector->CopyNumberOfContributors(*fSubEvent->GetCurrentQnVector());
-        harmonic = fSubEvent->GetCurrentQnVector()->GetFirstHarmonic();
-        /* let's check the correction histograms */
-        Long64_t bin = fInputHistograms->GetBin();
-        if (fInputHistograms->BinContentValidated(bin)) {
-          /* correction information validated */
-          while (harmonic!=-1) {
-            Float_t widthX = 1.0;
-            Float_t widthY = 1.0;
-            if (fApplyWidthEqualization) {
-              widthX = fInputHistograms->GetXBinError(harmonic, bin);
-              widthY = fInputHistograms->GetYBinError(harmonic, bin);
-            }
-            fCorrectedQnVector->SetX(harmonic, (fSubEvent->GetCurrentQnVector()->x(harmonic)
-                - fInputHistograms->GetXBinContent(harmonic, bin))
-                /widthX);
-            fCorrectedQnVector->SetY(harmonic, (fSubEvent->GetCurrentQnVector()->y(harmonic)
-                - fInputHistograms->GetYBinContent(harmonic, bin))
-                /widthY);
-            harmonic = fSubEvent->GetCurrentQnVector()->GetNextHarmonic(harmonic);
-          }
-        } /* correction information not validated, we leave the Q vector untouched */
-        else {
-          if (fQANotValidatedBin) fQANotValidatedBin->Fill(1.0);
-        }
-      } else {
-        /* not done! input vector with bad quality */
-        fCorrectedQnVector->SetGood(kFALSE);
-      }
-      /* and update the current Qn vector */
-      fSubEvent->UpdateCurrentQnVector(*fCorrectedQnVector);
+      ApplyCorrection(bin);
       applied = true;
       break;
     case State::PASSIVE:
@@ -189,6 +213,93 @@ bool Recentering::ProcessCorrections() {
   return applied;
 }
 
+/// Processes the correction step of all sub-events of a detector
+///
+/// The sub-events of a detector share the event class variables, so
+/// the bin of the correction parameters is looked up once for all of them.
+/// The harmonics of all sub-events with a good quality Qn vector and validated
+/// parameters are gathered with their row of the parameter table and recentered
+/// in one loop. The results are scattered back to the corrected Qn vectors.
+/// \param steps the recentering step of each sub-event
+/// \param n the number of sub-events
+/// \param applied per sub-event, true if the previous correction steps were applied
+void Recentering::ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied) {
+  Long64_t bin = -1;
+  fBatch.Reset(4);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!applied[i]) continue;
+    auto step = static_cast<Recentering *>(steps[i]);
+    if (step->fState!=State::APPLY && step->fState!=State::APPLYCOLLECT) {
+      applied[i] = kFALSE;
+      continue;
+    }
+    auto input = step->fSubEvent->GetCurrentQnVector();
+    if (!input->IsGoodQuality()) {
+      /* not done! input vector with bad quality */
+      step->fCorrectedQnVector->SetGood(kFALSE);
+      continue;
+    }
+    step->fCorrectedQnVector->CopyNumberOfContributors(*input);
+    if (bin < 0) bin = step->fCalibrationHistograms->GetBin();
+    if (!step->fParameters.Validated(bin)) {
+      /* correction information not validated, we leave the Q vector untouched */
+      if (step->fQANotValidatedBin) step->fParameters.CountFailure(bin);
+      continue;
+    }
+    for (auto harmonic = input->GetFirstHarmonic(); harmonic!=-1; harmonic = input->GetNextHarmonic(harmonic)) {
+      fBatch.Add(i, harmonic, input->x(harmonic), input->y(harmonic), step->fParameters.Parameters(bin, harmonic));
+    }
+  }
+  CorrectionKernels::Recenter(fBatch.size(), fBatch.Parameters(), fBatch.X(), fBatch.Y());
+  for (std::size_t row = 0; row < fBatch.size(); ++row) {
+    auto step = static_cast<Recentering *>(steps[fBatch.Owner(row)]);
+    step->fCorrectedQnVector->SetX(fBatch.Harmonic(row), fBatch.X()[row]);
+    step->fCorrectedQnVector->SetY(fBatch.Harmonic(row), fBatch.Y()[row]);
+  }
+  /* and update the current Qn vectors */
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!applied[i]) continue;
+    auto step = static_cast<Recentering *>(steps[i]);
+    step->fSubEvent->UpdateCurrentQnVector(*step->fCorrectedQnVector);
+  }
+}
+
+/// Applies the correction to the current Qn vector
+///
+/// \param bin the bin of the correction parameters for the current event class.
+/// If negative it is looked up in the calibration histograms when needed and returned.
+void Recentering::ApplyCorrection(Long64_t &bin) {
+  int harmonic;
+  if (fSubEvent->GetCurrentQnVector()->IsGoodQuality()) {
+    /* we get the properties of the current Qn vector but its name */
+    fCorrectedQnVector->CopyNumberOfContributors(*fSubEvent->GetCurrentQnVector());
+    harmonic = fSubEvent->GetCurrentQnVector()->GetFirstHarmonic();
+    /* let's check the correction histograms */
+    /* the calibration histograms share the binning of the input histograms and are */
+    /* also available when the parameters are read from a correction parameter file */
+    if (bin < 0) bin = fCalibrationHistograms->GetBin();
+    if (fParameters.Validated(bin)) {
+      /* correction information validated */
+      while (harmonic!=-1) {
+        auto parameters = fParameters.Parameters(bin, harmonic);
+        fCorrectedQnVector->SetX(harmonic,
+                                 parameters[0]*fSubEvent->GetCurrentQnVector()->x(harmonic) + parameters[1]);
+        fCorrectedQnVector->SetY(harmonic,
+                                 parameters[2]*fSubEvent->GetCurrentQnVector()->y(harmonic) + parameters[3]);
+        harmonic = fSubEvent->GetCurrentQnVector()->GetNextHarmonic(harmonic);
+      }
+    } /* correction information not validated, we leave the Q vector untouched */
+    else {
+      if (fQANotValidatedBin) fParameters.CountFailure(bin);
+    }
+  } else {
+    /* not done! input vector with bad quality */
+    fCorrectedQnVector->SetGood(kFALSE);
+  }
+  /* and update the current Qn vector */
+  fSubEvent->UpdateCurrentQnVector(*fCorrectedQnVector);
+}
+
 /// Processes the correction step data collection
 ///
 /// Pure virtual function
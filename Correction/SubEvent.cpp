@@ -105,9 +105,12 @@ std::string SubEvent::GetName() const {
 void SubEvent::BuildQnVector() {
   fPlainQnVector.SetNormalization(QVector::Normalization::NONE);
   fPlainQ2nVector.SetNormalization(QVector::Normalization::NONE);
-  for (const auto &dataVector : fDataVectorBank) {
-    fPlainQnVector.Add(dataVector.Phi(), dataVector.RadialOffset(), dataVector.EqualizedWeight());
-    fPlainQ2nVector.Add(dataVector.Phi(), dataVector.RadialOffset(), dataVector.EqualizedWeight());
+  const auto phi = fDataVectorBank.Phis();
+  const auto radial_offset = fDataVectorBank.RadialOffsets();
+  const auto weight = fDataVectorBank.EqualizedWeights();
+  for (std::size_t i = 0; i < fDataVectorBank.size(); ++i) {
+    fPlainQnVector.Add(phi[i], radial_offset[i], weight[i]);
+    fPlainQ2nVector.Add(phi[i], radial_offset[i], weight[i]);
   }
   /* check the quality of the Qn vector */
   fPlainQnVector.CheckQuality();
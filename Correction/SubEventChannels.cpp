@@ -36,6 +36,7 @@
 
 #include "CorrectionProfileComponents.h"
 #include "SubEventChannels.h"
+#include "CorrectionParameterFile.h"
 
 #include "Detector.h"
 
@@ -98,11 +99,9 @@ void SubEventChannels::SetChannelsScheme(std::vector<int> channel_groups) {
 
 /// Asks for support data structures creation
 ///
-/// The input data vector bank is allocated and the request is
-/// transmitted to the input data corrections and then to the Q vector corrections.
+/// The request is transmitted to the input data corrections and then to the Q vector corrections.
+/// The input data vectors are stored in the arena of the detector.
 void SubEventChannels::CreateSupportQVectors() {
-  /* this is executed in the remote node so, allocate the data bank */
-  fDataVectorBank.reserve(Qn::SubEvent::INITIALSIZE);
   for (auto &correction : fInputDataCorrections) {
     correction->CreateSupportQVectors();
   }
@@ -121,11 +120,7 @@ void SubEventChannels::CreateSupportQVectors() {
 void SubEventChannels::CreateCorrectionHistograms() {
   fInputDataCorrections.CreateCorrectionHistograms();
   fQnVectorCorrections.CreateCorrectionHistograms();
-  if (!fInputDataCorrections.Empty()) {
-    fInputDataCorrections.EnableFirstCorrection();
-  } else {
-    fQnVectorCorrections.EnableFirstCorrection();
-  }
+  EnableFirstCorrection();
 //  /* if list is empty delete it if not incorporate it */
 //  if (!correction_list->IsEmpty()) {
 //    list->Add(correction_list);
@@ -134,7 +129,23 @@ void SubEventChannels::CreateCorrectionHistograms() {
 //  }
 }
 
+/// Enables the first input data correction or the first Q vector correction
+/// if no input data correction is configured
+void SubEventChannels::EnableFirstCorrection() {
+  if (!fInputDataCorrections.Empty()) {
+    fInputDataCorrections.EnableFirstCorrection();
+  } else {
+    fQnVectorCorrections.EnableFirstCorrection();
+  }
+}
+
 void SubEventChannels::CopyToOutputList(TList *list) {
+  /* the list is reused from a previous run. Only the histograms of newly enabled corrections are added */
+  if (auto run_list = dynamic_cast<TList *>(list->FindObject(GetName().data()))) {
+    fInputDataCorrections.CopyToOutputList(run_list);
+    fQnVectorCorrections.CopyToOutputList(run_list);
+    return;
+  }
   auto correction_list = new TList();
   correction_list->SetName(GetName().data());
   correction_list->SetOwner(kTRUE);
@@ -282,6 +293,19 @@ void SubEventChannels::AttachNveQAHistograms(TList *list) {
 
 }
 
+/// Fills the non validated entries QA histograms
+///
+/// The request is transmitted first to the input data corrections
+/// and then to the Q vector corrections.
+void SubEventChannels::FillNveQAHistograms() {
+  for (auto &correction : fInputDataCorrections) {
+    correction->FillNveQAHistograms();
+  }
+  for (auto &correction : fQnVectorCorrections) {
+    correction->FillNveQAHistograms();
+  }
+}
+
 /// Asks for attaching the needed input information to the correction steps
 ///
 /// The detector list is extracted from the passed list and then
@@ -303,6 +327,25 @@ void SubEventChannels::AttachCorrectionInput(TList *list) {
   }
 }
 
+/// Asks for attaching the frozen correction parameters to the correction steps
+///
+/// The request is transmitted to the input data corrections
+/// and then propagated to the Q vector corrections
+/// \param parameters file containing the correction parameter tables
+/// \param run name of the current run
+void SubEventChannels::AttachCorrectionInput(const CorrectionParameterFile &parameters, const std::string &run) {
+  if (parameters.Contains(run, GetName())) {
+    if (!fInputDataCorrections.Empty()) {
+      fInputDataCorrections.EnableFirstCorrection();
+      fInputDataCorrections.AttachInputs(parameters, run);
+    }
+    if (fInputDataCorrections.Empty() || fInputDataCorrections.IsLastStepApplied()) {
+      fQnVectorCorrections.EnableFirstCorrection();
+      fQnVectorCorrections.AttachInputs(parameters, run);
+    }
+  }
+}
+
 /// Perform after calibration histograms attach actions
 /// It is used to inform the different correction step that
 /// all conditions for running the network are in place so
@@ -331,13 +374,13 @@ void SubEventChannels::AddCorrectionOnInputData(CorrectionOnInputData *correctio
 /// \param variableContainer pointer to the variable content bank
 void SubEventChannels::FillQAHistograms() {
   if (fQAMultiplicityBefore3D && fQAMultiplicityAfter3D) {
-    for (const auto &dataVector : fDataVectorBank) {
+    for (std::size_t i = 0; i < fDataVectorBank.size(); ++i) {
       fQAMultiplicityBefore3D->Fill(fEventClassVariables->At(fQACentralityVarId).GetValue(),
-                                    fChannelMap[dataVector.GetId()],
-                                    dataVector.Weight());
+                                    fChannelMap[fDataVectorBank.GetId(i)],
+                                    fDataVectorBank.Weight(i));
       fQAMultiplicityAfter3D->Fill(fEventClassVariables->At(fQACentralityVarId).GetValue(),
-                                   fChannelMap[dataVector.GetId()],
-                                   dataVector.EqualizedWeight());
+                                   fChannelMap[fDataVectorBank.GetId(i)],
+                                   fDataVectorBank.EqualizedWeight(i));
     }
   }
   if (fQAQnAverageHistogram) {
@@ -397,8 +440,11 @@ void SubEventChannels::FillOverallQnVectorCorrectionStepList(std::set<Correction
 /// the one to be used for subsequent Q vector corrections.
 void SubEventChannels::BuildRawQnVector() {
   fRawQnVector.SetNormalization(QVector::Normalization::NONE);
-  for (const auto &dataVector : fDataVectorBank) {
-    fRawQnVector.Add(dataVector.Phi(), dataVector.RadialOffset(), dataVector.Weight());
+  const auto phi = fDataVectorBank.Phis();
+  const auto radial_offset = fDataVectorBank.RadialOffsets();
+  const auto weight = fDataVectorBank.Weights();
+  for (std::size_t i = 0; i < fDataVectorBank.size(); ++i) {
+    fRawQnVector.Add(phi[i], radial_offset[i], weight[i]);
   }
   fRawQnVector.CheckQuality();
   fRawQnVector.Normal(fDetector->GetNormalizationMethod());
@@ -36,6 +36,7 @@
 
 #include "CorrectionProfileComponents.h"
 #include "SubEventTracks.h"
+#include "CorrectionParameterFile.h"
 #include "ROOT/RMakeUnique.hxx"
 
 /// \cond CLASSIMP
@@ -57,12 +58,9 @@ SubEventTracks::SubEventTracks(unsigned int bin_id,
 
 /// Asks for support data structures creation
 ///
-/// The input data vector bank is allocated and the request is
-/// transmitted to the Q vector corrections.
+/// The request is transmitted to the Q vector corrections.
+/// The input data vectors are stored in the arena of the detector.
 void SubEventTracks::CreateSupportQVectors() {
-
-  /* this is executed in the remote node so, allocate the data bank */
-  fDataVectorBank.reserve(Qn::SubEvent::INITIALSIZE);
   for (auto &correction : fQnVectorCorrections) {
     correction->CreateSupportQVectors();
   }
@@ -78,10 +76,20 @@ void SubEventTracks::CreateSupportQVectors() {
 /// \return kTRUE if everything went OK
 void SubEventTracks::CreateCorrectionHistograms() {
   fQnVectorCorrections.CreateCorrectionHistograms();
+  EnableFirstCorrection();
+}
+
+/// Enables the first Q vector correction
+void SubEventTracks::EnableFirstCorrection() {
   fQnVectorCorrections.EnableFirstCorrection();
 }
 
 void SubEventTracks::CopyToOutputList(TList *list) {
+  /* the list is reused from a previous run. Only the histograms of newly enabled corrections are added */
+  if (auto run_list = dynamic_cast<TList *>(list->FindObject(GetName().data()))) {
+    fQnVectorCorrections.CopyToOutputList(run_list);
+    return;
+  }
   auto correction_list = new TList();
   correction_list->SetName(GetName().data());
   correction_list->SetOwner(kTRUE);
@@ -154,6 +162,15 @@ void SubEventTracks::AttachNveQAHistograms(TList *list) {
   }
 }
 
+/// Fills the non validated entries QA histograms
+///
+/// The request is transmitted to the Q vector corrections.
+void SubEventTracks::FillNveQAHistograms() {
+  for (auto &correction : fQnVectorCorrections) {
+    correction->FillNveQAHistograms();
+  }
+}
+
 /// Asks for attaching the needed input information to the correction steps
 ///
 /// The detector list is extracted from the passed list and then
@@ -168,6 +185,18 @@ void SubEventTracks::AttachCorrectionInput(TList *list) {
   }
 }
 
+/// Asks for attaching the frozen correction parameters to the correction steps
+///
+/// The request is transmitted to the Q vector corrections.
+/// \param parameters file containing the correction parameter tables
+/// \param run name of the current run
+void SubEventTracks::AttachCorrectionInput(const CorrectionParameterFile &parameters, const std::string &run) {
+  if (parameters.Contains(run, GetName())) {
+    fQnVectorCorrections.EnableFirstCorrection();
+    fQnVectorCorrections.AttachInputs(parameters, run);
+  }
+}
+
 /// Perform after calibration histograms attach actions
 /// It is used to inform the different correction step that
 /// all conditions for running the network are in place so
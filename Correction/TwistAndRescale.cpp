@@ -36,6 +36,7 @@
 #include "CorrectionProfile3DCorrelations.h"
 #include "CorrectionHistogramSparse.h"
 #include "TwistAndRescale.h"
+#include "CorrectionParameterFile.h"
 #include "ROOT/RMakeUnique.hxx"
 #include "Detector.h"
 #include "DetectorList.h"
@@ -188,16 +189,235 @@ void TwistAndRescale::AttachInput(TList *list) {
       /* TODO: basically we are re producing half of the information already produce for recentering correction. Re use it! */
       if (fDoubleHarmonicInputHistograms->AttachHistograms(list)) {
         fState = State::APPLYCOLLECT;
+        FreezeInput();
       }
       break;
     case Method::CORRELATIONS:
       if (fCorrelationsInputHistograms->AttachHistograms(list)) {
         fState = State::APPLYCOLLECT;
+        FreezeInput();
       }
       break;
   }
 }
 
+/// Attaches the frozen correction parameters to the correction step
+/// \param parameters file containing the correction parameter tables
+/// \param run name of the current run
+///
+/// The table is only used if it matches the event classes and the harmonics of the step.
+void TwistAndRescale::AttachInput(const CorrectionParameterFile &parameters, const std::string &run) {
+  Long64_t nNoOfBins = 0;
+  switch (fTwistAndRescaleMethod) {
+    case Method::DOUBLE_HARMONIC:nNoOfBins = fDoubleHarmonicCalibrationHistograms->GetNoOfBins();
+      break;
+    case Method::CORRELATIONS:nNoOfBins = fCorrelationsCalibrationHistograms->GetNoOfBins();
+      break;
+  }
+  if (parameters.Read(run, fSubEvent->GetName(), GetName(), nNoOfBins, 6, QVector::kmaxharmonics + 1,
+                      fSubEvent->GetHarmonics().to_ullong(), fParameters)) {
+    fState = State::APPLYCOLLECT;
+  }
+}
+
+/// Freezes the calibration information into the table of correction parameters
+///
+/// For each validated event class bin and harmonic the twist parameters
+/// \f$ \Lambda^{+} \f$, \f$ \Lambda^{-} \f$, the twist normalization, the inverse
+/// rescale parameters \f$ 1/A^{+} \f$, \f$ 1/A^{-} \f$ and the status of the harmonic
+/// are stored. The status tells if the harmonic is left untouched (0), only
+/// twisted (1) or twisted and rescaled (2).
+void TwistAndRescale::FreezeInput() {
+  auto nNoOfHarmonics = fSubEvent->GetNoOfHarmonics();
+  std::vector<Int_t> harmonicsMap(nNoOfHarmonics);
+  fSubEvent->GetHarmonicMap(harmonicsMap.data());
+  Long64_t nNoOfBins = 0;
+  switch (fTwistAndRescaleMethod) {
+    case Method::DOUBLE_HARMONIC:nNoOfBins = fDoubleHarmonicInputHistograms->GetNoOfBins();
+      break;
+    case Method::CORRELATIONS:nNoOfBins = fCorrelationsInputHistograms->GetNoOfBins();
+      break;
+  }
+  fParameters.Reset(nNoOfBins, 6);
+  fParameters.SetHarmonics(fSubEvent->GetHarmonics().to_ullong());
+  for (Long64_t bin = 0; bin < nNoOfBins; ++bin) {
+    Bool_t validated = kFALSE;
+    switch (fTwistAndRescaleMethod) {
+      case Method::DOUBLE_HARMONIC:validated = fDoubleHarmonicInputHistograms->BinContentValidated(bin);
+        break;
+      case Method::CORRELATIONS:validated = fCorrelationsInputHistograms->BinContentValidated(bin);
+        break;
+    }
+    if (!validated) continue;
+    fParameters.SetValidated(bin);
+    for (auto harmonic : harmonicsMap) {
+      Double_t Aplus = 0.0;
+      Double_t Aminus = 0.0;
+      Double_t LambdaPlus = 0.0;
+      Double_t LambdaMinus = 0.0;
+      switch (fTwistAndRescaleMethod) {
+        case Method::DOUBLE_HARMONIC: {
+          /* remember we store the profile information on a twice the harmonic number base */
+          Double_t X2n = fDoubleHarmonicInputHistograms->GetXBinContent(harmonic*2, bin);
+          Double_t Y2n = fDoubleHarmonicInputHistograms->GetYBinContent(harmonic*2, bin);
+          Aplus = 1 + X2n;
+          Aminus = 1 - X2n;
+          LambdaPlus = Y2n/Aplus;
+          LambdaMinus = Y2n/Aminus;
+        }
+          break;
+        case Method::CORRELATIONS: {
+          using Combination = CorrectionProfile3DCorrelations::Combination;
+          using Component = CorrectionProfile3DCorrelations::Component;
+          Double_t XAXC = fCorrelationsInputHistograms->GetBinContent(Combination::AC, Component::XX, harmonic, bin);
+          Double_t YAYB = fCorrelationsInputHistograms->GetBinContent(Combination::AB, Component::YY, harmonic, bin);
+          Double_t XAXB = fCorrelationsInputHistograms->GetBinContent(Combination::AB, Component::XX, harmonic, bin);
+          Double_t XBXC = fCorrelationsInputHistograms->GetBinContent(Combination::BC, Component::XX, harmonic, bin);
+          Double_t XAYB = fCorrelationsInputHistograms->GetBinContent(Combination::AB, Component::XY, harmonic, bin);
+          Double_t XBYC = fCorrelationsInputHistograms->GetBinContent(Combination::BC, Component::XY, harmonic, bin);
+          Aplus = TMath::Sqrt(TMath::Abs(2.0*XAXC))*XAXB/TMath::Sqrt(TMath::Abs(XAXB*XBXC + XAYB*XBYC));
+          Aminus = TMath::Sqrt(TMath::Abs(2.0*XAXC))*YAYB/TMath::Sqrt(TMath::Abs(XAXB*XBXC + XAYB*XBYC));
+          LambdaPlus = XAYB/XAXB;
+          LambdaMinus = XAYB/YAYB;
+        }
+          break;
+      }
+      auto parameters = fParameters.Parameters(bin, harmonic);
+      parameters[0] = LambdaPlus;
+      parameters[1] = LambdaMinus;
+      parameters[2] = 1.0/(1 - LambdaMinus*LambdaPlus);
+      parameters[3] = 1.0/Aplus;
+      parameters[4] = 1.0/Aminus;
+      if (TMath::Abs(Aplus) > fMaxThreshold || TMath::Abs(Aminus) > fMaxThreshold
+          || TMath::Abs(LambdaPlus) > fMaxThreshold || TMath::Abs(LambdaMinus) > fMaxThreshold) {
+        parameters[5] = 0;
+      } else if (Aplus==0.0 || Aminus==0.0) {
+        parameters[5] = 1;
+      } else {
+        parameters[5] = 2;
+      }
+    }
+  }
+}
+
+/// Applies the twist and rescale correction to one harmonic
+/// \param parameters the frozen correction parameters of the harmonic in the current event class
+/// \param harmonic the harmonic number
+/// \param Qx the X component of the Qn vector to correct
+/// \param Qy the Y component of the Qn vector to correct
+void TwistAndRescale::ApplyCorrection(const Double_t *parameters, Int_t harmonic, Double_t Qx, Double_t Qy) {
+  if (parameters[5]==0) return;
+  Double_t newQx = (Qx - parameters[1]*Qy)*parameters[2];
+  Double_t newQy = (Qy - parameters[0]*Qx)*parameters[2];
+  if (fApplyTwist) {
+    fCorrectedQnVector->SetX(harmonic, newQx);
+    fCorrectedQnVector->SetY(harmonic, newQy);
+    fTwistCorrectedQnVector->SetX(harmonic, newQx);
+    fTwistCorrectedQnVector->SetY(harmonic, newQy);
+    fRescaleCorrectedQnVector->SetX(harmonic, newQx);
+    fRescaleCorrectedQnVector->SetY(harmonic, newQy);
+  }
+  if (parameters[5]==1) return;
+  newQx = newQx*parameters[3];
+  newQy = newQy*parameters[4];
+  if (fApplyRescale) {
+    fCorrectedQnVector->SetX(harmonic, newQx);
+    fCorrectedQnVector->SetY(harmonic, newQy);
+    fRescaleCorrectedQnVector->SetX(harmonic, newQx);
+    fRescaleCorrectedQnVector->SetY(harmonic, newQy);
+  }
+}
+
+/// Processes the correction step of all sub-events of a detector
+///
+/// The sub-events of a detector share the event class variables, so
+/// the bin of the correction parameters is looked up once for all of them.
+/// The harmonics of all sub-events with a good quality Qn vector and validated
+/// parameters are gathered with their row of the parameter table. Twist and
+/// rescale are computed in one loop over all rows. The results are scattered back
+/// according to the status of each harmonic as in ApplyCorrection.
+/// \param steps the twist and rescale step of each sub-event
+/// \param n the number of sub-events
+/// \param applied per sub-event, true if the previous correction steps were applied
+void TwistAndRescale::ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied) {
+  Long64_t doubleHarmonicBin = -1;
+  Long64_t correlationsBin = -1;
+  fBatch.Reset(6);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!applied[i]) continue;
+    auto step = static_cast<TwistAndRescale *>(steps[i]);
+    if (step->fState!=State::APPLY && step->fState!=State::APPLYCOLLECT) {
+      applied[i] = kFALSE;
+      continue;
+    }
+    if (!step->fSubEvent->GetCurrentQnVector()->IsGoodQuality()) {
+      /* not done! input Q vector with bad quality */
+      step->fCorrectedQnVector->SetGood(kFALSE);
+      continue;
+    }
+    step->fCorrectedQnVector->CopyNumberOfContributors(*step->fSubEvent->GetCurrentQnVector());
+    step->fTwistCorrectedQnVector->CopyNumberOfContributors(*step->fCorrectedQnVector);
+    step->fRescaleCorrectedQnVector->CopyNumberOfContributors(*step->fCorrectedQnVector);
+    const QVector *input = nullptr;
+    Long64_t bin = -1;
+    switch (step->fTwistAndRescaleMethod) {
+      case Method::DOUBLE_HARMONIC:
+        if (doubleHarmonicBin < 0) doubleHarmonicBin = step->fDoubleHarmonicCalibrationHistograms->GetBin();
+        bin = doubleHarmonicBin;
+        input = step->fSubEvent->GetCurrentQnVector();
+        break;
+      case Method::CORRELATIONS:
+        if (correlationsBin < 0) correlationsBin = step->fCorrelationsCalibrationHistograms->GetBin();
+        bin = correlationsBin;
+        input = step->fTwistCorrectedQnVector.get();
+        break;
+    }
+    if (!step->fParameters.Validated(bin)) {
+      if (step->fQANotValidatedBin) step->fParameters.CountFailure(bin);
+      continue;
+    }
+    auto corrected = step->fCorrectedQnVector.get();
+    for (auto harmonic = corrected->GetFirstHarmonic(); harmonic!=-1; harmonic = corrected->GetNextHarmonic(harmonic)) {
+      fBatch.Add(i, harmonic, input->x(harmonic), input->y(harmonic), step->fParameters.Parameters(bin, harmonic));
+    }
+  }
+  fRescaledX.resize(fBatch.size());
+  fRescaledY.resize(fBatch.size());
+  CorrectionKernels::TwistAndRescale(fBatch.size(), fBatch.Parameters(), fBatch.X(), fBatch.Y(),
+                                     fRescaledX.data(), fRescaledY.data());
+  for (std::size_t row = 0; row < fBatch.size(); ++row) {
+    auto step = static_cast<TwistAndRescale *>(steps[fBatch.Owner(row)]);
+    const auto status = fBatch.Parameters(row)[5];
+    const auto harmonic = fBatch.Harmonic(row);
+    if (status==0) continue;
+    if (step->fApplyTwist) {
+      for (auto qvector : {step->fCorrectedQnVector.get(), step->fTwistCorrectedQnVector.get(),
+                           step->fRescaleCorrectedQnVector.get()}) {
+        qvector->SetX(harmonic, fBatch.X()[row]);
+        qvector->SetY(harmonic, fBatch.Y()[row]);
+      }
+    }
+    if (status==1) continue;
+    if (step->fApplyRescale) {
+      for (auto qvector : {step->fCorrectedQnVector.get(), step->fRescaleCorrectedQnVector.get()}) {
+        qvector->SetX(harmonic, fRescaledX[row]);
+        qvector->SetY(harmonic, fRescaledY[row]);
+      }
+    }
+  }
+  /* and update the current Qn vectors */
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!applied[i]) continue;
+    auto step = static_cast<TwistAndRescale *>(steps[i]);
+    if (step->fApplyTwist) {
+      step->fSubEvent->UpdateCurrentQnVector(*step->fTwistCorrectedQnVector);
+    }
+    if (step->fApplyRescale) {
+      step->fSubEvent->UpdateCurrentQnVector(*step->fRescaleCorrectedQnVector);
+    }
+  }
+}
+
 /// Perform after calibration histograms attach actions
 /// It is used to inform the different correction step that
 /// all conditions for running the network are in place so
@@ -272,6 +492,18 @@ void TwistAndRescale::AttachNveQAHistograms(TList *list) {
   }
 }
 
+/// Fills the non validated entries QA histograms
+///
+/// The events without validated calibration are counted per event class
+/// bin in the table of correction parameters. The counters are transferred
+/// to the histogram and restarted.
+void TwistAndRescale::FillNveQAHistograms() {
+  if (fQANotValidatedBin) {
+    fQANotValidatedBin->FillCounts(fParameters.GetFailures());
+    fParameters.ResetFailures();
+  }
+}
+
 /// Processes the correction step
 ///
 /// Apply the correction step
@@ -299,67 +531,19 @@ bool TwistAndRescale::ProcessCorrections() {
             fTwistCorrectedQnVector->CopyNumberOfContributors(*fCorrectedQnVector);
             fRescaleCorrectedQnVector->CopyNumberOfContributors(*fCorrectedQnVector);
             /* let's check the correction histograms */
-            Long64_t bin = fDoubleHarmonicInputHistograms->GetBin();
-            if (fDoubleHarmonicInputHistograms->BinContentValidated(bin)) {
-              /* remember we store the profile information on a twice the harmonic number base */
+            /* the calibration histograms share the binning of the input histograms and are */
+            /* also available when the parameters are read from a correction parameter file */
+            Long64_t bin = fDoubleHarmonicCalibrationHistograms->GetBin();
+            if (fParameters.Validated(bin)) {
               harmonic = fCorrectedQnVector->GetFirstHarmonic();
               while (harmonic!=-1) {
-                Double_t X2n = fDoubleHarmonicInputHistograms->GetXBinContent(harmonic*2, bin);
-                Double_t Y2n = fDoubleHarmonicInputHistograms->GetYBinContent(harmonic*2, bin);
-
-                Double_t Aplus = 1 + X2n;
-                Double_t Aminus = 1 - X2n;
-                Double_t LambdaPlus = Y2n/Aplus;
-                Double_t LambdaMinus = Y2n/Aminus;
-
-                if (TMath::Abs(Aplus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (TMath::Abs(Aminus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (TMath::Abs(LambdaPlus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (TMath::Abs(LambdaMinus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                Double_t Qx = fSubEvent->GetCurrentQnVector()->x(harmonic);
-                Double_t Qy = fSubEvent->GetCurrentQnVector()->y(harmonic);
-                Double_t newQx = (Qx - LambdaMinus*Qy)/(1 - LambdaMinus*LambdaPlus);
-                Double_t newQy = (Qy - LambdaPlus*Qx)/(1 - LambdaMinus*LambdaPlus);
-                if (fApplyTwist) {
-                  fCorrectedQnVector->SetX(harmonic, newQx);
-                  fCorrectedQnVector->SetY(harmonic, newQy);
-                  fTwistCorrectedQnVector->SetX(harmonic, newQx);
-                  fTwistCorrectedQnVector->SetY(harmonic, newQy);
-                  fRescaleCorrectedQnVector->SetX(harmonic, newQx);
-                  fRescaleCorrectedQnVector->SetY(harmonic, newQy);
-                }
-                newQx = newQx/Aplus;
-                newQy = newQy/Aminus;
-                if (Aplus==0.0) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (Aminus==0.0) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (fApplyRescale) {
-                  fCorrectedQnVector->SetX(harmonic, newQx);
-                  fCorrectedQnVector->SetY(harmonic, newQy);
-                  fRescaleCorrectedQnVector->SetX(harmonic, newQx);
-                  fRescaleCorrectedQnVector->SetY(harmonic, newQy);
-                }
+                ApplyCorrection(fParameters.Parameters(bin, harmonic), harmonic,
+                                fSubEvent->GetCurrentQnVector()->x(harmonic),
+                                fSubEvent->GetCurrentQnVector()->y(harmonic));
                 harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
               }
             } else {
-              if (fQANotValidatedBin) fQANotValidatedBin->Fill(1.0);
+              if (fQANotValidatedBin) fParameters.CountFailure(bin);
             }
           } else {
             /* not done! input Q vector with bad quality */
@@ -373,70 +557,17 @@ bool TwistAndRescale::ProcessCorrections() {
             fTwistCorrectedQnVector->CopyNumberOfContributors(*fCorrectedQnVector);
             fRescaleCorrectedQnVector->CopyNumberOfContributors(*fCorrectedQnVector);
             /* let's check the correction histograms */
-            Long64_t bin = fCorrelationsInputHistograms->GetBin();
-            if (fCorrelationsInputHistograms->BinContentValidated(bin)) {
+            Long64_t bin = fCorrelationsCalibrationHistograms->GetBin();
+            if (fParameters.Validated(bin)) {
               harmonic = fCorrectedQnVector->GetFirstHarmonic();
               while (harmonic!=-1) {
-                Double_t XAXC = fCorrelationsInputHistograms->GetXXBinContent("AC", harmonic, bin);
-                Double_t YAYB = fCorrelationsInputHistograms->GetYYBinContent("AB", harmonic, bin);
-                Double_t XAXB = fCorrelationsInputHistograms->GetXXBinContent("AB", harmonic, bin);
-                Double_t XBXC = fCorrelationsInputHistograms->GetXXBinContent("BC", harmonic, bin);
-                Double_t XAYB = fCorrelationsInputHistograms->GetXYBinContent("AB", harmonic, bin);
-                Double_t XBYC = fCorrelationsInputHistograms->GetXYBinContent("BC", harmonic, bin);
-                Double_t
-                    Aplus = TMath::Sqrt(TMath::Abs(2.0*XAXC))*XAXB/TMath::Sqrt(TMath::Abs(XAXB*XBXC + XAYB*XBYC));
-                Double_t
-                    Aminus = TMath::Sqrt(TMath::Abs(2.0*XAXC))*YAYB/TMath::Sqrt(TMath::Abs(XAXB*XBXC + XAYB*XBYC));
-                Double_t LambdaPlus = XAYB/XAXB;
-                Double_t LambdaMinus = XAYB/YAYB;
-                if (TMath::Abs(Aplus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (TMath::Abs(Aminus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (TMath::Abs(LambdaPlus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (TMath::Abs(LambdaMinus) > fMaxThreshold) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                Double_t Qx = fTwistCorrectedQnVector->x(harmonic);
-                Double_t Qy = fTwistCorrectedQnVector->y(harmonic);
-                Double_t newQx = (Qx - LambdaMinus*Qy)/(1 - LambdaMinus*LambdaPlus);
-                Double_t newQy = (Qy - LambdaPlus*Qx)/(1 - LambdaMinus*LambdaPlus);
-                if (fApplyTwist) {
-                  fCorrectedQnVector->SetX(harmonic, newQx);
-                  fCorrectedQnVector->SetY(harmonic, newQy);
-                  fTwistCorrectedQnVector->SetX(harmonic, newQx);
-                  fTwistCorrectedQnVector->SetY(harmonic, newQy);
-                  fRescaleCorrectedQnVector->SetX(harmonic, newQx);
-                  fRescaleCorrectedQnVector->SetY(harmonic, newQy);
-                }
-                newQx = newQx/Aplus;
-                newQy = newQy/Aminus;
-                if (Aplus==0.0) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (Aminus==0.0) {
-                  harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-                  continue;
-                }
-                if (fApplyRescale) {
-                  fCorrectedQnVector->SetX(harmonic, newQx);
-                  fCorrectedQnVector->SetY(harmonic, newQy);
-                  fRescaleCorrectedQnVector->SetX(harmonic, newQx);
-                  fRescaleCorrectedQnVector->SetY(harmonic, newQy);
-                }
+                ApplyCorrection(fParameters.Parameters(bin, harmonic), harmonic,
+                                fTwistCorrectedQnVector->x(harmonic),
+                                fTwistCorrectedQnVector->y(harmonic));
                 harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
               }
             } else {
-              if (fQANotValidatedBin) fQANotValidatedBin->Fill(1.0);
+              if (fQANotValidatedBin) fParameters.CountFailure(bin);
             }
           } else {
             /* not done! input Q vector with bad quality */
@@ -51,6 +51,8 @@
 #include "CorrectionHistogramSparse.h"
 #include "CorrectionProfileCorrelationComponents.h"
 #include "CorrectionProfileComponents.h"
+#include "CorrectionParameterTable.h"
+#include "CorrectionBatch.h"
 
 /// \class QnCorrectionsQnVectorAlignment
 /// \brief Encapsulates Qn vector rotation for alignment correction
@@ -115,17 +117,23 @@ class Alignment : public CorrectionOnQnVector {
   /// \param nNoOfEntries the number of entries threshold
   void SetNoOfEntriesThreshold(Int_t nNoOfEntries) { fMinNoOfEntriesToValidate = nNoOfEntries; }
   virtual void AttachInput(TList *list);
+  virtual void AttachInput(const CorrectionParameterFile &parameters, const std::string &run);
+  virtual const CorrectionParameterTable *GetCorrectionParameters() const { return &fParameters; }
   virtual void AfterInputAttachAction() {}
   virtual void CreateSupportQVectors();
   virtual void CreateCorrectionHistograms();
   virtual void AttachQAHistograms(TList *list);
   virtual void AttachNveQAHistograms(TList *list);
+  virtual void FillNveQAHistograms();
 
   virtual Bool_t ProcessCorrections();
+  virtual void ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied);
   virtual Bool_t ProcessDataCollection();
   virtual void ClearCorrectionStep();
 
  private:
+  void FreezeInput();
+  void ApplyCorrection(Long64_t &bin);
   using State = Qn::CorrectionBase::State;
   static constexpr const unsigned int
       szPriority = CorrectionOnQnVector::Step::kAlignment; ///< the key of the correction step for ordering purpose
@@ -145,6 +153,8 @@ class Alignment : public CorrectionOnQnVector {
       fQANotValidatedBin;    //!<! the histogram with non validated bin information
   std::unique_ptr<CorrectionProfileComponents>
       fQAQnAverageHistogram; //!<! the after correction step average Qn components QA histogram
+  CorrectionParameterTable fParameters; //!<! the correction parameters frozen from the calibration information
+  QnVectorBatch fBatch; //!<! rows of all sub-events of the detector corrected in one batch
 
   Int_t fHarmonicForAlignment = -1;              ///< the harmonic number to be used for Qn vector alignment correction
   std::string
@@ -0,0 +1,162 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_CALIBRATIONACCUMULATORS_H
+#define FLOW_CALIBRATIONACCUMULATORS_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "TList.h"
+
+class THn;
+
+namespace Qn {
+/**
+ * @class CalibrationAccumulators
+ * @brief Mergeable flat representation of the calibration histograms.
+ * Each histogram of the calibration output is stored as an accumulator holding the sum of the values and, if the
+ * errors are calculated, the sum of the squared values for every bin including under- and overflow bins.
+ * The number of entries per bin of the correction profiles is kept in the accumulator of their entries histogram.
+ * Merging adds the arrays bin by bin, which is much faster than merging the histograms.
+ * The accumulators are identified by the path of the histogram in the calibration output,
+ * e.g. "<run>/<sub-event>/<histogram>". They keep the order in which they were added.
+ *
+ * Layout of the file (native byte order, all offsets in bytes from the start of the file, all sections aligned to
+ * 8 bytes):
+ * - header: char magic[8] "QnCalAcc", uint32 version, uint32 number of accumulators.
+ * - index: one record of 64 bytes per accumulator: uint64 offsets of the zero terminated path and title,
+ *   uint64 offset of the axis records, uint32 number of axes, char type of the histogram (e.g. 'F' for THnF),
+ *   char[3] padding, int64 number of bins, double number of entries, uint64 offset of the sums (double [bin]),
+ *   uint64 offset of the squared sums (double [bin], 0 if the errors are not calculated).
+ * - axes: one record of 32 bytes per axis: uint64 offsets of the zero terminated name and title, int32 number of bins,
+ *   uint32 flag for variable bin widths, uint64 offset of the bin edges (double [number of bins + 1]).
+ * - names and data sections.
+ */
+class CalibrationAccumulators {
+ public:
+  static constexpr std::uint32_t kVersion = 1;
+
+  /**
+   * @brief Adds the histograms of a list of calibration histograms e.g. as returned by
+   * CorrectionManager::GetCorrectionList. Lists inside the list are added recursively.
+   * Throws if an object is not a dense histogram (THn) or if its binning differs from an existing accumulator.
+   * @param list list of the calibration histograms
+   * @param path path of the list. It is prepended to the names of the histograms.
+   */
+  void Add(const TList *list, const std::string &path = "");
+
+  /**
+   * @brief Adds the accumulators of another set of accumulators.
+   * Accumulators, which do not exist yet, are moved. Throws if the binning of two accumulators differs.
+   * @param other accumulators to be added
+   */
+  void Add(CalibrationAccumulators other);
+
+  /**
+   * @brief Adds the accumulators of a file to the accumulators.
+   * The file is mapped into memory and only the merged arrays are kept. Throws if the file is not valid.
+   * @param file_name name of the file
+   */
+  void Read(const std::string &file_name);
+
+  /**
+   * @brief Writes the accumulators to a file. Throws if the file cannot be written.
+   * @param file_name name of the file
+   */
+  void Write(const std::string &file_name) const;
+
+  /**
+   * @brief Creates the calibration histograms from the accumulators.
+   * The nested lists follow the paths of the accumulators. The list can be written with CalibrationInput::Write and
+   * used as calibration input.
+   * @return list of the calibration histograms.
+   */
+  std::unique_ptr<TList> CreateList() const;
+
+  /**
+   * @brief Merges accumulator files using several threads.
+   * Each thread merges a contiguous range of the files, which are combined in the order of the threads afterwards.
+   * The result is reproducible for a given number of threads. The memory needed is bounded by the number of threads
+   * times the size of the merged accumulators, because the files are only mapped into memory.
+   * @param file_names names of the files
+   * @param n_threads number of threads
+   * @return merged accumulators
+   */
+  static CalibrationAccumulators Merge(const std::vector<std::string> &file_names, unsigned int n_threads);
+
+  std::size_t size() const { return accumulators_.size(); }
+  bool empty() const { return accumulators_.empty(); }
+
+ private:
+  /**
+   * Binning of one axis of the histogram.
+   */
+  struct Axis {
+    std::string name;
+    std::string title;
+    bool variable = false;
+    std::vector<double> edges;
+    bool operator==(const Axis &other) const { return edges==other.edges; }
+  };
+  /**
+   * Flat content of one histogram.
+   */
+  struct Accumulator {
+    std::string path;
+    std::string title;
+    char type = 'F';
+    std::vector<Axis> axes;
+    double entries = 0.;
+    std::vector<double> sum;
+    std::vector<double> sum2;
+  };
+
+  /**
+   * Adds the content of an accumulator with the same path. Throws if the binning differs.
+   * @param target accumulator which receives the content.
+   * @param type type of the added histogram.
+   * @param axes binning of the added histogram.
+   * @param entries number of entries of the added histogram.
+   * @param sum sums of the added histogram.
+   * @param sum2 squared sums of the added histogram. nullptr if the errors are not calculated.
+   */
+  static void AddContent(Accumulator &target, char type, const std::vector<Axis> &axes, double entries,
+                         const double *sum, const double *sum2);
+  /**
+   * Creates the histogram of an accumulator.
+   * @param accumulator accumulator of the histogram
+   * @param name name of the histogram
+   * @return histogram. Ownership is passed to the caller.
+   */
+  static THn *CreateHistogram(const Accumulator &accumulator, const std::string &name);
+  /**
+   * Adds an accumulator. If an accumulator with the same path exists, the content is added to it.
+   * @param accumulator accumulator to be added.
+   */
+  void Insert(Accumulator accumulator);
+
+  std::vector<Accumulator> accumulators_; ///< accumulators in the order in which they were added
+  std::map<std::string, std::size_t> index_; ///< position of the accumulators by their path
+};
+}
+
+#endif //FLOW_CALIBRATIONACCUMULATORS_H
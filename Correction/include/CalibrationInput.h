@@ -0,0 +1,119 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_CALIBRATIONINPUT_H
+#define FLOW_CALIBRATIONINPUT_H
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TList.h"
+
+namespace Qn {
+/**
+ * @class CalibrationInput
+ * @brief Store of the calibration histograms read from the calibration input file.
+ * Two layouts of the file are supported:
+ * - indexed: a directory with one key per run, each holding the list of calibration histograms of that run.
+ *   It is written with CalibrationInput::Write. The key table of the directory is the index. Only the runs which
+ *   are processed are read, and each one is read when it is requested. The next run can be read in the background.
+ *   Only the current and the prefetched runs are kept in memory: the list of the current run is released when a
+ *   new run is requested. Reading in the background requires ROOT::EnableThreadSafety() to be called before.
+ * - single key: one list containing the lists of all runs, as written by TList::Write with TObject::kSingleKey.
+ *   It is read completely when the file is opened.
+ * The lists are only read by the correction steps and are shared by all slots.
+ */
+class CalibrationInput {
+ public:
+  CalibrationInput() = default;
+  CalibrationInput(const CalibrationInput &) = delete;
+  CalibrationInput &operator=(const CalibrationInput &) = delete;
+
+  /**
+   * @brief Opens the calibration input.
+   * @param file calibration input file.
+   * @param name name of the directory or list containing the calibration histograms of all runs.
+   */
+  void Open(std::unique_ptr<TFile> file, const std::string &name);
+
+  /**
+   * @brief Returns the calibration histograms of a run. They are read from the file if they are not in memory.
+   * The list of the run, which was returned before, is released. Prefetched runs are kept until they are requested.
+   * The correction steps freeze their parameters when the input is attached, so they do not need the list of a
+   * previous run.
+   * @param run name of the run
+   * @return non-owning pointer to the list of the calibration histograms. nullptr if the run is not available.
+   * Valid until a different run is requested.
+   */
+  TList *Get(const std::string &run);
+
+  /**
+   * @brief Reads the calibration histograms of a run without changing the runs in memory.
+   * @param run name of the run
+   * @return list of the calibration histograms owned by the caller. nullptr if the run is not available.
+   */
+  std::unique_ptr<TList> Read(const std::string &run) const;
+
+  /**
+   * @brief Returns the names of all runs available in the calibration input.
+   * @return names of the runs
+   */
+  std::vector<std::string> GetRunNames() const;
+
+  /**
+   * @brief Starts reading the calibration histograms of a run in the background.
+   * Only supported for the indexed layout. The run is read with a separate handle of the file.
+   * ROOT::EnableThreadSafety() has to be called before e.g. by CorrectionManager::InitializeOnNode.
+   * @param run name of the run
+   */
+  void Prefetch(const std::string &run);
+
+  /**
+   * @brief Returns if runs can be read in the background.
+   * @return true for the indexed layout.
+   */
+  bool CanPrefetch() const { return directory_!=nullptr; }
+
+  /**
+   * @brief Writes the calibration histograms in the indexed layout.
+   * @param corrections list of the lists of calibration histograms of each run as returned by
+   * CorrectionManager::GetCorrectionList.
+   * @param directory directory the calibration histograms are written to.
+   * @param name name of the created directory
+   */
+  static void Write(TList *corrections, TDirectory *directory, const std::string &name);
+
+ private:
+  static std::unique_ptr<TList> ReadRun(TDirectory *directory, const std::string &run);
+
+  std::unique_ptr<TFile> file_; //!<! calibration input file
+  std::string name_; //!<! name of the directory or list of the calibration histograms
+  TDirectory *directory_ = nullptr; //!<! directory of the indexed layout. Owned by the file.
+  std::unique_ptr<TList> all_runs_; //!<! list of all runs of the single key layout
+  std::map<std::string, std::unique_ptr<TList>> runs_; //!<! runs of the indexed layout in memory
+  std::string current_run_; //!<! name of the run returned last by Get
+  std::string prefetched_run_; //!<! name of the run read in the background
+  std::future<std::unique_ptr<TList>> prefetched_; //!<! result of the run read in the background
+};
+}
+
+#endif //FLOW_CALIBRATIONINPUT_H
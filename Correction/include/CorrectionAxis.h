@@ -43,7 +43,7 @@ class CorrectionAxis {
   /// Gets the variable unique Id
   int GetId() const { return variable_.GetID(); }
   /// Gets the value of the variable
-  double GetValue() const { return *variable_.begin(); }
+  double GetValue() const { return variable_[0]; }
   /// Gets the variable name / label
   std::string GetLabel() const { return axis_.Name(); }
   /// Gets the number of bins
@@ -15,12 +15,16 @@
 /// \brief Base class for the support of the different correction steps within Q vector correction framework
 ///
 
+#include <cstddef>
+
 #include "TObject.h"
 #include "TList.h"
 
 namespace Qn {
 class SubEvent;
 class QVector;
+class CorrectionParameterFile;
+class CorrectionParameterTable;
 
 
 /// \class QnCorrectionsCorrectionStepBase
@@ -74,6 +78,19 @@ class CorrectionBase : public TObject {
   /// \param list list where the inputs should be found
   /// \return kTRUE if everything went OK
   virtual void AttachInput(TList *list) { (void) list; }
+  /// Attaches the frozen correction parameters to the correction step
+  ///
+  /// Alternative to the calibration histograms for steps which
+  /// store their parameters in a correction parameter table
+  /// \param parameters file containing the correction parameter tables
+  /// \param run name of the current run
+  virtual void AttachInput(const CorrectionParameterFile &parameters, const std::string &run) {
+    (void) parameters;
+    (void) run;
+  }
+  /// Gets the frozen correction parameters
+  /// \return the table of the correction parameters, nullptr if the step has none
+  virtual const CorrectionParameterTable *GetCorrectionParameters() const { return nullptr; }
   /// Perform after calibration histograms attach actions
   /// It is used to inform the different correction step that
   /// all conditions for running the network are in place so
@@ -104,11 +121,30 @@ class CorrectionBase : public TObject {
   /// \param list list where the histograms should be incorporated for its persistence
   /// \return kTRUE if everything went OK
   virtual void AttachNveQAHistograms(TList *list) { (void) list; }
+  /// Fills the non validated entries QA histograms
+  ///
+  /// The entries are counted per bin while processing and
+  /// transferred to the histograms before the output is written.
+  virtual void FillNveQAHistograms() {}
   /// Processes the correction step
   ///
   /// Pure virtual function
   /// \return kTRUE if everything went OK
   virtual bool ProcessCorrections() { return false; }
+  /// Processes the correction step of all sub-events of a detector
+  ///
+  /// The passed steps are the same correction step of each of the sub-events.
+  /// By default they are processed one after the other. Correction steps which
+  /// can share work between the sub-events override it.
+  /// \param steps the correction step of each sub-event
+  /// \param n the number of sub-events
+  /// \param applied per sub-event, true if the previous correction steps were applied.
+  /// It is updated with the result of this correction step.
+  virtual void ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (applied[i]) applied[i] = steps[i]->ProcessCorrections();
+    }
+  }
   /// Processes the correction step data collection
   ///
   /// Pure virtual function
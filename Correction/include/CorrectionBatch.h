@@ -0,0 +1,160 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_CORRECTIONBATCH_H
+#define FLOW_CORRECTIONBATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Rtypes.h"
+
+namespace Qn {
+/**
+ * @class QnVectorBatch
+ * @brief Q-vector components of all sub-events of a detector, which are corrected by one correction step.
+ * Each row holds one harmonic of one sub-event together with the parameters of this harmonic, copied from the row of
+ * the CorrectionParameterTable of the sub-event. The correction step gathers the rows of all sub-events, applies the
+ * correction with one of the kernels in Qn::CorrectionKernels in one loop over all rows and scatters the results
+ * back to the corrected Q-vectors of the sub-events. The buffers keep their capacity between events.
+ */
+class QnVectorBatch {
+ public:
+  /**
+   * @brief Removes all rows.
+   * @param n_parameters number of parameters per row.
+   */
+  void Reset(unsigned int n_parameters) {
+    n_parameters_ = n_parameters;
+    owners_.clear();
+    harmonics_.clear();
+    x_.clear();
+    y_.clear();
+    parameters_.clear();
+  }
+
+  /**
+   * @brief Adds a row.
+   * @param owner index of the sub-event in the batch of the detector
+   * @param harmonic harmonic number
+   * @param x x component of the Q-vector
+   * @param y y component of the Q-vector
+   * @param parameters parameters of the harmonic. n_parameters are copied.
+   */
+  void Add(std::size_t owner, int harmonic, double x, double y, const Double_t *parameters) {
+    owners_.push_back(owner);
+    harmonics_.push_back(harmonic);
+    x_.push_back(x);
+    y_.push_back(y);
+    parameters_.insert(parameters_.end(), parameters, parameters + n_parameters_);
+  }
+
+  std::size_t size() const { return owners_.size(); }
+  std::size_t Owner(std::size_t row) const { return owners_[row]; }
+  int Harmonic(std::size_t row) const { return harmonics_[row]; }
+  double *X() { return x_.data(); }
+  double *Y() { return y_.data(); }
+  const Double_t *Parameters() const { return parameters_.data(); }
+  const Double_t *Parameters(std::size_t row) const { return &parameters_[row*n_parameters_]; }
+
+ private:
+  unsigned int n_parameters_ = 0; ///< number of parameters per row
+  std::vector<std::size_t> owners_; ///< sub-event of each row [row]
+  std::vector<int> harmonics_; ///< harmonic of each row [row]
+  std::vector<double> x_; ///< x components [row]
+  std::vector<double> y_; ///< y components [row]
+  std::vector<Double_t> parameters_; ///< parameters [row][parameter]
+};
+
+/**
+ * Corrections applied to all rows of a QnVectorBatch or to the weights of the data vectors.
+ * The parameters are laid out as in the CorrectionParameterTable of the correction step.
+ */
+namespace CorrectionKernels {
+/**
+ * Recentering and width equalization: x' = p0 x + p1, y' = p2 y + p3.
+ * @param n number of rows
+ * @param parameters 4 parameters per row
+ * @param x x components, corrected in place
+ * @param y y components, corrected in place
+ */
+inline void Recenter(std::size_t n, const Double_t *parameters, double *x, double *y) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto p = parameters + 4*i;
+    x[i] = p[0]*x[i] + p[1];
+    y[i] = p[2]*y[i] + p[3];
+  }
+}
+
+/**
+ * Alignment, a rotation by the angle between the sub-event and the reference: x' = x cos + y sin, y' = y cos - x sin.
+ * @param n number of rows
+ * @param parameters 3 parameters per row (cos, sin, significance)
+ * @param x x components, corrected in place
+ * @param y y components, corrected in place
+ */
+inline void Align(std::size_t n, const Double_t *parameters, double *x, double *y) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto p = parameters + 3*i;
+    const double qx = x[i];
+    const double qy = y[i];
+    x[i] = qx*p[0] + qy*p[1];
+    y[i] = qy*p[0] - qx*p[1];
+  }
+}
+
+/**
+ * Twist and rescale: x_t = (x - L- y) N, y_t = (y - L+ x) N, x_r = x_t / A+, y_r = y_t / A-.
+ * Rows with a status of 0 or 1 are computed as well. The correction step decides which results are used.
+ * @param n number of rows
+ * @param parameters 6 parameters per row (L+, L-, N, 1/A+, 1/A-, status)
+ * @param x x components, twisted in place
+ * @param y y components, twisted in place
+ * @param rescaled_x rescaled x components
+ * @param rescaled_y rescaled y components
+ */
+inline void TwistAndRescale(std::size_t n, const Double_t *parameters, double *x, double *y,
+                            double *rescaled_x, double *rescaled_y) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto p = parameters + 6*i;
+    const double qx = x[i];
+    const double qy = y[i];
+    x[i] = (qx - p[1]*qy)*p[2];
+    y[i] = (qy - p[0]*qx)*p[2];
+    rescaled_x[i] = x[i]*p[3];
+    rescaled_y[i] = y[i]*p[4];
+  }
+}
+
+/**
+ * Gain equalization of the weights of the data vectors: w' = factor[id] w + offset[id].
+ * @param n number of data vectors
+ * @param ids channel of each data vector
+ * @param factors equalization factor of each channel
+ * @param offsets equalization offset of each channel
+ * @param weights weights, equalized in place
+ */
+template<typename ID, typename WEIGHT>
+inline void Equalize(std::size_t n, const ID *ids, const Double_t *factors, const Double_t *offsets, WEIGHT *weights) {
+  for (std::size_t i = 0; i < n; ++i) {
+    weights[i] = factors[ids[i]]*weights[i] + offsets[ids[i]];
+  }
+}
+}
+}
+
+#endif //FLOW_CORRECTIONBATCH_H
@@ -21,14 +21,19 @@
 #define FLOW_CORRECTIONCUTS_H
 
 #include <array>
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <functional>
 
+#include "TH1.h"
+#include "TH2.h"
+#include "TList.h"
+
 #include "ROOT/RMakeUnique.hxx"
 #include "ROOT/RIntegerSequence.hxx"
 
 #include "InputVariableManager.h"
-#include "QAHistogram.h"
 #include "Cuts.h"
 
 namespace Qn {
@@ -51,6 +56,9 @@ class CorrectionCut {
   bool Check() const {
     return cut_->Check();
   }
+  void CheckAll(std::size_t n, std::uint64_t *selection) const {
+    cut_->CheckAll(n, selection);
+  }
   CorrectionCut::CallBack GetCallBack() const { return callback_; }
  private:
   std::unique_ptr<CutBase> cut_;
@@ -66,39 +74,16 @@ class CorrectionCuts {
 
   CorrectionCuts(const CorrectionCuts &cuts) {
     n_channels_ = cuts.n_channels_;
-    var_values_ = cuts.var_values_;
-    cut_number = cuts.cut_number;
-    cut_weight_ = cuts.cut_weight_;
-    cut_channel_ = cuts.cut_channel_;
+    report_name_ = cuts.report_name_;
+    counts_.assign(cuts.counts_.size(), 0);
     for (auto &cut : cuts.cuts_) {
       cuts_.emplace_back(cut.GetCallBack());
     }
-    if (cuts.report_) {
-      CreateCutReport(cuts.report_->GetName(), n_channels_);
-    }
   }
 
-  CorrectionCuts(CorrectionCuts &&cuts) {
-    n_channels_ = cuts.n_channels_;
-    var_values_ = cuts.var_values_;
-    cut_number = cuts.cut_number;
-    cut_weight_ = cuts.cut_weight_;
-    cut_channel_ = cuts.cut_channel_;
-    cuts_ = std::move(cuts.cuts_);
-    report_ = std::move(cuts.report_);
-  }
-  CorrectionCuts &operator=(CorrectionCuts &&cuts)  noexcept {
-    n_channels_ = cuts.n_channels_;
-    var_values_ = cuts.var_values_;
-    cut_number = cuts.cut_number;
-    cut_weight_ = cuts.cut_weight_;
-    cut_channel_ = cuts.cut_channel_;
-    cuts_ = std::move(cuts.cuts_);
-    report_ = std::move(cuts.report_);
-    return *this;
-  };
-  
-  virtual ~CorrectionCuts() { delete[] var_values_; }
+  CorrectionCuts(CorrectionCuts &&cuts) = default;
+  CorrectionCuts &operator=(CorrectionCuts &&cuts) = default;
+  virtual ~CorrectionCuts() = default;
 //  /**
 //   * @brief Adds a cut to the manager.
 //   * @param cut pointer to the cut.
@@ -115,118 +100,154 @@ class CorrectionCuts {
 
   /**
    * Checks if the current variables pass the cuts
-   * Creates entries in the cut report
+   * Creates entries in the cut report if it was created.
    * @param i offset of the variable in case it has a length longer than 1
    * @return Returns true if the cut was passed.
    */
   inline bool CheckCuts(std::size_t i) {
-    int icut = 1;
     if (cuts_.empty()) return true;
-    ++*((cut_weight_).begin() + i);
     bool passed = true;
+    if (counts_.empty()) {
+      for (auto &cut : cuts_) { passed = cut.Check(i) && passed; }
+      return passed;
+    }
+    auto counts = counts_.data() + i;
+    ++counts[0];
+    std::size_t icut = 1;
     for (auto &cut : cuts_) {
-      bool ipass = cut.Check(i) && passed;
-      if (ipass) {
-        ++*cut_weight_.at(i + n_channels_*icut);
-      }
-      passed = ipass;
+      passed = cut.Check(i) && passed;
+      counts[n_channels_*icut] += passed;
       ++icut;
     }
     return passed;
   }
 
   /**
-   * @brief Fills the cut report.
+   * Checks the cuts for all channels at once.
+   * Each cut is evaluated in one loop over all channels. The entries of the cut report are updated in bulk,
+   * visiting only the channels which are still selected.
+   * @param n number of channels
+   * @param selection selection of the channels packed into 64 bit words (see Qn::Selection).
+   * The bits of the channels which passed all cuts are set.
    */
-  void FillReport() {
-    if (report_) {
-      report_->Fill();
-      // reset binvalues container before filling next event.
-      auto offset = n_channels_*(cuts_.size() + 1);
-      for (std::size_t i = 0; i < n_channels_; ++i) {
-        for (std::size_t j = 0; j < (cuts_.size() + 1); ++j) {
-          var_values_[2*offset + i + n_channels_*j] = 0;
-        }
-      }
+  void CheckCuts(std::size_t n, std::vector<std::uint64_t> &selection) {
+    selection.assign(Selection::NumberOfWords(n), ~std::uint64_t{0});
+    const auto n_tail = n%Selection::kBitsPerWord;
+    if (n_tail) selection.back() = (std::uint64_t{1} << n_tail) - 1;
+    Select(n, selection);
+  }
+
+  /**
+   * Checks the cuts for the channels which are already selected, e.g. by other cuts.
+   * With a cut report of a single channel, as for tracks, the report counts the selected entries of all channels.
+   * @param n number of channels
+   * @param selection selection of the channels packed into 64 bit words (see Qn::Selection).
+   * The bits of the channels which fail a cut are cleared.
+   */
+  void Select(std::size_t n, std::vector<std::uint64_t> &selection) {
+    if (cuts_.empty()) return;
+    std::size_t icut = 0;
+    CountSelected(selection, icut++);
+    for (auto &cut : cuts_) {
+      cut.CheckAll(n, selection.data());
+      CountSelected(selection, icut++);
     }
   }
 
   /**
-   * @brief Initializes the cut report histogram
+   * Evaluates all cuts for all channels at once and compacts the selected channels.
+   * The number of selected channels is counted with popcount and the indices are
+   * extracted from the set bits of the selection words.
+   * @param n number of channels
+   * @return indices of the channels, which passed all cuts, in increasing order.
+   * Valid until the next call.
+   */
+  const std::vector<unsigned int> &Evaluate(std::size_t n) {
+    CheckCuts(n, selection_);
+    Selection::Compact(selection_.data(), selection_.size(), selected_);
+    return selected_;
+  }
+
+  /**
+   * @brief Initializes the counters of the cut report.
+   * The counters are only converted to a histogram when the report is written.
    * @param report_name name of the histogram.
    * @param n_channels number of channels.
    */
   void CreateCutReport(const std::string &report_name, std::size_t n_channels = 1) {
     if (!cuts_.empty()) {
       n_channels_ = n_channels;
-      auto offset = n_channels_*(cuts_.size() + 1);
-      cut_number = InputVariable(0, offset);
-      cut_channel_ = InputVariable(offset, offset);
-      cut_weight_ = InputVariable(2*offset, offset);
-      var_values_ = new double[3*offset];
-      cut_weight_.values_container_ = var_values_;
-      cut_number.values_container_ = var_values_;
-      cut_channel_.values_container_ = var_values_;
-      for (std::size_t i = 0; i < n_channels_; ++i) {
-        for (std::size_t j = 0; j < (cuts_.size() + 1); ++j) {
-          var_values_[i + n_channels_*j] = j;
-          var_values_[offset + i + n_channels_*j] = i;
-          var_values_[2*offset + i + n_channels_*j] = 0;
-        }
-      }
-      if (n_channels_==1) {
-        std::string name = report_name + "Cut_Report";
-        std::string title(";cuts;entries");
-        auto nbins = cuts_.size() + 1;
-        float low = 0.;
-        float high = cuts_.size() + 1;
-        auto histo = new TH1F(name.data(), title.data(), nbins, low, high);
-        int icut = 2;
-        histo->GetXaxis()->SetBinLabel(1, "all");
-        for (auto &cut : cuts_) {
-          histo->GetXaxis()->SetBinLabel(icut, cut.Name().data());
-          ++icut;
-        }
-        std::array<InputVariable, 2> arr = {{cut_number, cut_weight_}};
-        report_ = std::make_unique<QAHisto1DPtr>(arr, histo);
-      } else {
-        std::string name = report_name + "Cut_Report";
-        std::string title(";cuts;channels");
-        auto x_nbins = cuts_.size() + 1;
-        auto y_nbins = n_channels_;
-        float low = 0.;
-        float x_high = cuts_.size() + 1;
-        float y_high = n_channels_;
-        auto histo = new TH2F(name.data(), title.data(), x_nbins, low, x_high, y_nbins, low, y_high);
-        histo->GetXaxis()->SetBinLabel(1, "all");
-        int icut = 2;
-        for (auto &cut : cuts_) {
-          histo->GetXaxis()->SetBinLabel(icut, cut.Name().data());
-          ++icut;
-        }
-        std::array<InputVariable, 3> arr = {{cut_number, cut_channel_, cut_weight_}};
-        report_ = std::make_unique<QAHisto2DPtr>(arr, histo);
-      }
+      report_name_ = report_name + "Cut_Report";
+      counts_.assign(n_channels_*(cuts_.size() + 1), 0);
     }
   }
 
   /**
-   * @brief Adds the cut report to the list.
+   * @brief Adds the cut report histogram to the list.
+   * It is filled with the counters when FlushReport is called.
    * Lifetime of the list and the histogram has to be managed by the user.
    * @param list list containing output histograms.
    */
   void AddToList(TList *list) {
-    if (report_) report_->AddToList(list);
+    if (counts_.empty()) return;
+    const auto n_cuts = static_cast<int>(cuts_.size() + 1);
+    if (n_channels_==1) {
+      report_ = new TH1D(report_name_.data(), ";cuts;entries", n_cuts, 0., n_cuts);
+    } else {
+      const auto n_channels = static_cast<int>(n_channels_);
+      report_ = new TH2D(report_name_.data(), ";cuts;channels", n_cuts, 0., n_cuts, n_channels, 0., n_channels);
+    }
+    report_->SetDirectory(nullptr);
+    report_->GetXaxis()->SetBinLabel(1, "all");
+    int icut = 2;
+    for (auto &cut : cuts_) {
+      report_->GetXaxis()->SetBinLabel(icut, cut.Name().data());
+      ++icut;
+    }
+    list->Add(report_);
+  }
+
+  /**
+   * @brief Copies the counters to the cut report histogram.
+   */
+  void FlushReport() {
+    if (!report_) return;
+    Long64_t entries = 0;
+    for (std::size_t icut = 0; icut < cuts_.size() + 1; ++icut) {
+      for (std::size_t channel = 0; channel < n_channels_; ++channel) {
+        const auto count = counts_[channel + n_channels_*icut];
+        const auto bin = n_channels_==1 ? report_->GetBin(icut + 1) : report_->GetBin(icut + 1, channel + 1);
+        report_->SetBinContent(bin, count);
+        entries += count;
+      }
+    }
+    report_->ResetStats();
+    report_->SetEntries(entries);
   }
 
  private:
+  /**
+   * Adds the selected channels to the counters of a cut.
+   * @param selection selection of the channels.
+   * @param icut index of the cut in the report. The first cut is "all".
+   */
+  void CountSelected(const std::vector<std::uint64_t> &selection, std::size_t icut) {
+    if (counts_.empty()) return;
+    auto cut_counts = counts_.data() + n_channels_*icut;
+    if (n_channels_==1) {
+      for (const auto word : selection) { cut_counts[0] += Selection::PopCount(word); }
+    } else {
+      Selection::ForEachSelected(selection.data(), selection.size(), [cut_counts](std::size_t i) { ++cut_counts[i]; });
+    }
+  }
+
   std::size_t n_channels_ = 0; /// number of channels is zero in case of no report
-  double *var_values_ = nullptr; /// pointer to the values which are filled to the histogram.
-  InputVariable cut_number; /// Variable of saving cut number
-  InputVariable cut_weight_; /// Variable saving a weight used for filling the cut histogram
-  InputVariable cut_channel_; /// Variable saving the channel number
+  std::string report_name_; /// name of the cut report histogram
   std::vector<CorrectionCut> cuts_; /// vector of cuts which are applied
-  std::unique_ptr<Impl::QAHistoBase> report_; //!<! histogram of the cut report.
+  std::vector<Long64_t> counts_; //!<! number of entries passing the cuts [cut][channel]. The first cut is "all".
+  TH1 *report_ = nullptr; //!<! histogram of the cut report. Owned by the output list.
+  std::vector<std::uint64_t> selection_; //!<! selection bits of the channels of the current event
+  std::vector<unsigned int> selected_; //!<! indices of the selected channels of the current event
 };
 
 namespace CallBacks {
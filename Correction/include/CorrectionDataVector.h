@@ -18,73 +18,181 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <cstddef>
+#include <vector>
+
 namespace Qn {
 /**
- * @class CorrectionDataVector
- * @brief Class models a data vector.
- * It allows to model data vector of different detector types.
+ * @class CorrectionDataVectors
+ * @brief Data vectors of one event stored as a structure of arrays.
+ * It allows to model data vectors of different detector types.
+ * Each field (id, phi, radial offset, weight, equalized weight) is stored in a separate contiguous array,
+ * so that loops reading only some of the fields stream through memory.
  */
-class CorrectionDataVector {
+class CorrectionDataVectors {
  public:
+  CorrectionDataVectors() = default;
+  ~CorrectionDataVectors() = default;
 
   /**
-   * Default constructor
-   */
-  CorrectionDataVector() = default;
-
-  /**
-   * Constructor
+   * Adds a data vector.
    * @param id id of the channel
    * @param phi azimuthal angle of the channel or track
    * @param weight weight applied to the channel or track
    * @param radial_offset radial offset of the channel is only used for certain detector geometries.
    */
-  CorrectionDataVector(int id, float phi, float weight, float radial_offset) :
-      id_(id),
-      phi_(phi),
-      radial_offset_(radial_offset),
-      weight_(weight),
-      equalized_weight_(weight) {}
+  void Add(int id, float phi, float weight, float radial_offset) {
+    ids_.push_back(id);
+    phis_.push_back(phi);
+    radial_offsets_.push_back(radial_offset);
+    weights_.push_back(weight);
+    equalized_weights_.push_back(weight);
+  }
+  /**
+   * Copies a data vector from another structure of arrays.
+   * @param i position of the data vector
+   * @param other data vectors which the data vector is copied from
+   * @param j position of the data vector in other
+   */
+  void Set(std::size_t i, const CorrectionDataVectors &other, std::size_t j) {
+    ids_[i] = other.ids_[j];
+    phis_[i] = other.phis_[j];
+    radial_offsets_[i] = other.radial_offsets_[j];
+    weights_[i] = other.weights_[j];
+    equalized_weights_[i] = other.equalized_weights_[j];
+  }
+  /**
+   * Replaces the data vectors with the data vectors of another structure of arrays grouped by bin.
+   * The grouping is a counting sort, so that the data vectors of one bin keep their order.
+   * The buffers keep their capacity between events.
+   * @param vectors data vectors in the order of filling
+   * @param bins bin of each data vector, smaller than n_bins
+   * @param n_bins number of bins
+   * @param offsets set to the n_bins + 1 boundaries of the bins.
+   * The data vectors of bin i are in the range [offsets[i], offsets[i+1]).
+   * @param positions buffer of the insert positions
+   */
+  void Group(const CorrectionDataVectors &vectors, const long *bins, std::size_t n_bins,
+             std::vector<std::size_t> &offsets, std::vector<std::size_t> &positions) {
+    const auto n = vectors.size();
+    offsets.assign(n_bins + 1, 0);
+    for (std::size_t i = 0; i < n; ++i) { ++offsets[bins[i] + 1]; }
+    for (std::size_t ibin = 0; ibin < n_bins; ++ibin) { offsets[ibin + 1] += offsets[ibin]; }
+    positions.assign(offsets.begin(), offsets.end() - 1);
+    Resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      Set(positions[bins[i]]++, vectors, i);
+    }
+  }
+  void Resize(std::size_t n) {
+    ids_.resize(n);
+    phis_.resize(n);
+    radial_offsets_.resize(n);
+    weights_.resize(n);
+    equalized_weights_.resize(n);
+  }
+  void Reserve(std::size_t n) {
+    ids_.reserve(n);
+    phis_.reserve(n);
+    radial_offsets_.reserve(n);
+    weights_.reserve(n);
+    equalized_weights_.reserve(n);
+  }
+  void Clear() {
+    ids_.clear();
+    phis_.clear();
+    radial_offsets_.clear();
+    weights_.clear();
+    equalized_weights_.clear();
+  }
+  std::size_t size() const { return ids_.size(); }
 
-  ~CorrectionDataVector() = default;
+  int *Ids() { return ids_.data(); }
+  float *Phis() { return phis_.data(); }
+  float *RadialOffsets() { return radial_offsets_.data(); }
+  float *Weights() { return weights_.data(); }
+  float *EqualizedWeights() { return equalized_weights_.data(); }
+
+ private:
+  std::vector<int> ids_;                  //!<! the ids associated with the data vectors
+  std::vector<float> phis_;               //!<! the azimuthal angles of the data vectors
+  std::vector<float> radial_offsets_;     //!<! radial offsets of the channels represented by the data vectors
+  std::vector<float> weights_;            //!<! raw weights assigned to the data vectors
+  std::vector<float> equalized_weights_;  //!<! eq weights assigned to the data vectors
+};
+
+/**
+ * @class CorrectionDataVectorRange
+ * @brief Non-owning contiguous range of data vectors.
+ * The data vectors of all sub-events of a detector are stored in one arena owned by the detector.
+ * Each sub-event accesses its data vectors through a range into the arena.
+ * The fields are accessed by the position i inside the range.
+ */
+class CorrectionDataVectorRange {
+ public:
+  CorrectionDataVectorRange() = default;
+  CorrectionDataVectorRange(CorrectionDataVectors &vectors, std::size_t begin, std::size_t end) :
+      ids_(vectors.Ids() + begin),
+      phis_(vectors.Phis() + begin),
+      radial_offsets_(vectors.RadialOffsets() + begin),
+      weights_(vectors.Weights() + begin),
+      equalized_weights_(vectors.EqualizedWeights() + begin),
+      size_(end - begin) {}
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_==0; }
+  void clear() { *this = CorrectionDataVectorRange(); }
 
   /**
    * Sets the equalized weight
+   * @param i position of the data vector
    * @param weight equalized weight after channel equalization
    */
-  inline void SetEqualizedWeight(const float weight) { equalized_weight_ = weight; }
+  inline void SetEqualizedWeight(std::size_t i, const float weight) { equalized_weights_[i] = weight; }
   /**
    * Gets the channel id associated with the data vector
+   * @param i position of the data vector
    * @return the channel id
    */
-  constexpr int GetId() const { return id_; }
-
+  inline int GetId(std::size_t i) const { return ids_[i]; }
   /**
    * Gets the azimuthal angle for the data vector
+   * @param i position of the data vector
    * @return phi
    */
-  constexpr float Phi() const { return phi_; }
+  inline float Phi(std::size_t i) const { return phis_[i]; }
   /**
    * Gets the radial offset of the data vector
+   * @param i position of the data vector
    * @return radial offset
    */
-  constexpr float RadialOffset() const {return radial_offset_; }
+  inline float RadialOffset(std::size_t i) const { return radial_offsets_[i]; }
   /**
    * Gets the weight for the data vector
+   * @param i position of the data vector
    * @return defaults to 1.0
    */
-  constexpr float Weight() const { return weight_; }
+  inline float Weight(std::size_t i) const { return weights_[i]; }
   /**
    * Gets the equalized weight for the data vector
+   * @param i position of the data vector
    * @return defaults to weights
    */
-  constexpr float EqualizedWeight() const { return equalized_weight_; }
+  inline float EqualizedWeight(std::size_t i) const { return equalized_weights_[i]; }
+
+  const int *Ids() const { return ids_; }
+  const float *Phis() const { return phis_; }
+  const float *RadialOffsets() const { return radial_offsets_; }
+  const float *Weights() const { return weights_; }
+  float *EqualizedWeights() const { return equalized_weights_; }
+
  private:
-  int   id_;                    //!<! the id associated with the data vector
-  float phi_;                   //!<! the azimuthal angle of the data vector
-  float radial_offset_; //!<! radial offset of the channel represented by the data vector
-  float weight_;                //!<! raw weight assigned to the data vector
-  float equalized_weight_;      //!<! eq weight assigned to the data vector
+  int *ids_ = nullptr;                 //!<! ids of the range
+  float *phis_ = nullptr;              //!<! azimuthal angles of the range
+  float *radial_offsets_ = nullptr;    //!<! radial offsets of the range
+  float *weights_ = nullptr;           //!<! raw weights of the range
+  float *equalized_weights_ = nullptr; //!<! eq weights of the range
+  std::size_t size_ = 0;               //!<! number of data vectors in the range
 };
 }
 #endif /* QNCORRECTIONS_DATAVECTORS_H */
@@ -0,0 +1,286 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_CORRECTIONHELPER_H
+#define FLOW_CORRECTIONHELPER_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RDF/ActionHelpers.hxx"
+#include "ROOT/RVec.hxx"
+#include "TList.h"
+
+#include "CorrectionManager.h"
+
+namespace Qn {
+/**
+ * @brief RDataFrame action which runs the correction step inside the event loop of the data frame.
+ * Each column is mapped to a variable of the correction manager.
+ * Scalar columns, array columns mapped to typed columns of the variable manager and array columns mapped to variables
+ * with a length larger than one (e.g. channels) are copied once per event. Array columns mapped to variables of
+ * length one are track columns. The tracking detectors are filled once for every entry of the track columns.
+ * Each slot of the data frame is processed by the slot of the correction manager with the same number.
+ * The result of the action is the merged list of the calibration histograms.
+ * @tparam Columns types of the input columns
+ */
+template<typename... Columns>
+class CorrectionHelper : public ROOT::Detail::RDF::RActionImpl<CorrectionHelper<Columns...>> {
+ public:
+  using Result_t = TList;
+  static constexpr auto kEntryColumnName = "rdfentry_";
+
+  /**
+   * @brief Constructor
+   * @param manager initialized correction manager. Lifetime is managed by the user.
+   * @param column_names names of the input columns.
+   * @param variable_names names of the variables the columns are mapped to. Defaults to the names of the columns.
+   */
+  CorrectionHelper(CorrectionManager *manager,
+                   std::vector<std::string> column_names,
+                   std::vector<std::string> variable_names = {}) :
+      manager_(manager),
+      column_names_(std::move(column_names)) {
+    if (column_names_.size()!=sizeof...(Columns)) {
+      throw std::invalid_argument("The number of column names must match the number of column types.");
+    }
+    if (variable_names.empty()) variable_names = column_names_;
+    if (variable_names.size()!=column_names_.size()) {
+      throw std::invalid_argument("The number of variable names must match the number of column names.");
+    }
+    for (const auto &name : variable_names) {
+      auto variable = manager_->FindVariable(name);
+      variables_.push_back({variable.GetID(), variable.size(), variable.IsColumn(), name});
+    }
+    const auto n_slots = ROOT::IsImplicitMTEnabled() ? ROOT::GetImplicitMTPoolSize() : 1;
+    if (manager_->GetNumberOfSlots() < n_slots) {
+      throw std::logic_error("The correction manager has less slots than the data frame. "
+                             "Call SetNumberOfSlots before InitializeOnNode.");
+    }
+    slots_ = std::make_shared<std::vector<SlotState>>(n_slots);
+  }
+
+  /**
+   * @brief Books the correction step on the data frame.
+   * @tparam DATAFRAME type of the data frame
+   * @param df data frame
+   * @return Result pointer to the list of calibration histograms.
+   */
+  template<typename DATAFRAME>
+  ROOT::RDF::RResultPtr<Result_t> BookMe(DATAFRAME &df) {
+    auto columns = GetColumnNames();
+    return df.template Book<ULong64_t, Columns...>(std::move(*this), columns);
+  }
+
+  /**
+   * @brief Defines all output Q-vectors of the correction manager as new columns of the data frame.
+   * Requires CorrectionManager::SetFillOutputInMemory(true) and SetCurrentRunName to be called before.
+   * The columns are named "<detector>_<step>" like the branches of the output tree. They hold pointers to the
+   * Q-vectors of the slot, which are valid for the current entry, so that the Q-vectors are not copied in every event.
+   * Together with MakeCorrelation<const DataContainerQVector *> and
+   * CorrelationHelper::BookMe(df, manager.GetOutputQVectors(), n_samples) the correlations are calculated in the
+   * same event loop as the corrections.
+   * Events, which do not pass the event cuts, point to empty Q-vectors.
+   * @param df data frame
+   * @return data frame containing the new columns.
+   */
+  ROOT::RDF::RNode DefineQVectors(ROOT::RDF::RNode df) const {
+    auto columns = GetColumnNames();
+    for (const auto &name_q_vector : manager_->GetOutputQVectors()) {
+      const auto &name = name_q_vector.first;
+      std::vector<const DataContainerQVector *> q_vectors;
+      for (unsigned int slot = 0; slot < slots_->size(); ++slot) {
+        q_vectors.push_back(manager_->GetOutputQVectors(slot).at(name));
+      }
+      const auto empty = MakeEmpty(*name_q_vector.second);
+      const auto helper = *this;
+      df = df.DefineSlot(name, [helper, q_vectors, empty](unsigned int slot, ULong64_t entry, Columns... values) {
+        return helper.Process(slot, entry, values...) ? q_vectors[slot] : empty.get();
+      }, columns);
+    }
+    return df;
+  }
+
+  /**
+   * @brief Defines the corrected Q-vectors as new columns of the data frame.
+   * Requires CorrectionManager::SetFillOutputInMemory(true) and SetCurrentRunName to be called before.
+   * Correction steps, which are not configured as output, are copied from the sub-events after they are defined.
+   * The columns are named "<detector>_<step>" like the branches of the output tree. They hold pointers to the
+   * Q-vectors of the slot, which are valid for the current entry.
+   * The events are only processed once per slot, even if the action is booked and several Q-vectors are defined.
+   * Events, which do not pass the event cuts, point to empty Q-vectors.
+   * @param df data frame
+   * @param q_vectors pairs of detector names and correction steps.
+   * @return data frame containing the new columns.
+   */
+  ROOT::RDF::RNode DefineQVectors(ROOT::RDF::RNode df,
+                                  const std::vector<std::pair<std::string, QVector::CorrectionStep>> &q_vectors) const {
+    auto columns = GetColumnNames();
+    for (const auto &q_vector : q_vectors) {
+      const auto &detector = q_vector.first;
+      const auto step = q_vector.second;
+      const auto name = detector + "_" + kCorrectionStepNamesArray[step];
+      std::vector<const DataContainerQVector *> slot_q_vectors;
+      for (unsigned int slot = 0; slot < slots_->size(); ++slot) {
+        slot_q_vectors.push_back(manager_->GetQVector(detector, step, slot));
+      }
+      const auto empty = MakeEmpty(*slot_q_vectors.front());
+      const auto helper = *this;
+      df = df.DefineSlot(name, [helper, slot_q_vectors, empty](unsigned int slot, ULong64_t entry, Columns... values) {
+        return helper.Process(slot, entry, values...) ? slot_q_vectors[slot] : empty.get();
+      }, columns);
+    }
+    return df;
+  }
+
+  void Exec(unsigned int slot, ULong64_t entry, Columns... values) {
+    Process(slot, entry, values...);
+  }
+
+  void InitTask(TTreeReader *, unsigned int) {}
+
+  void Initialize() { /* no-op */}
+
+  void Finalize() { manager_->Finalize(); }
+
+  std::shared_ptr<Result_t> GetResultPtr() const {
+    // non-owning pointer. The list is owned by the correction manager.
+    return std::shared_ptr<Result_t>(std::shared_ptr<Result_t>(), manager_->GetCorrectionList());
+  }
+
+  std::string GetActionName() const { return "CorrectionHelper"; }
+
+ private:
+  /**
+   * Position and length of a variable inside the values container.
+   * Columns are set by name through the correction manager.
+   */
+  struct Variable {
+    unsigned int id;
+    unsigned int size;
+    bool column;
+    std::string name;
+  };
+
+  /**
+   * State of the current event of a slot.
+   */
+  struct SlotState {
+    ULong64_t entry = std::numeric_limits<ULong64_t>::max();
+    bool passed = false;
+  };
+
+  CorrectionManager *manager_ = nullptr; //!<! non-owning pointer to the correction manager
+  std::vector<std::string> column_names_; //!<! names of the input columns
+  std::vector<Variable> variables_; //!<! variables the columns are mapped to
+  std::shared_ptr<std::vector<SlotState>> slots_; //!<! state of each slot shared between the copies of the helper
+
+  std::vector<std::string> GetColumnNames() const {
+    std::vector<std::string> columns{kEntryColumnName};
+    columns.insert(columns.end(), column_names_.begin(), column_names_.end());
+    return columns;
+  }
+
+  /**
+   * @brief Creates Q-vectors with the binning of the prototype, which are all empty.
+   * They are used for the events, which do not pass the event cuts.
+   * @param prototype Q-vectors defining the binning
+   * @return empty Q-vectors
+   */
+  static std::shared_ptr<const DataContainerQVector> MakeEmpty(const DataContainerQVector &prototype) {
+    auto empty = std::make_shared<DataContainerQVector>(prototype);
+    for (auto &bin : *empty) { bin = QVector(); }
+    return empty;
+  }
+
+  /**
+   * @brief Runs the correction step for one entry in a slot.
+   * @param slot number of the slot
+   * @param entry number of the entry. It is used to skip entries which are already processed.
+   * @param values values of the input columns
+   * @return true if the event passed the event cuts.
+   */
+  bool Process(unsigned int slot, ULong64_t entry, const Columns &... values) const {
+    auto &state = (*slots_)[slot];
+    if (state.entry==entry) return state.passed;
+    state.entry = entry;
+    manager_->Reset(slot);
+    auto container = manager_->GetVariableContainer(slot);
+    long n_tracks = -1;
+    std::size_t i_column = 0;
+    (SetEventValue(slot, container, variables_[i_column++], values, n_tracks), ...);
+    state.passed = manager_->ProcessEvent(slot);
+    if (state.passed) {
+      manager_->FillChannelDetectors(slot);
+      if (n_tracks < 0) manager_->FillTrackingDetectors(slot);
+      for (long track = 0; track < n_tracks; ++track) {
+        i_column = 0;
+        (SetTrackValue(container, variables_[i_column++], values, track), ...);
+        manager_->FillTrackingDetectors(slot);
+      }
+    }
+    manager_->ProcessCorrections(slot);
+    return state.passed;
+  }
+
+  template<typename T>
+  void SetEventValue(unsigned int slot, double *container, const Variable &variable, const T &value, long &) const {
+    if (variable.column) {
+      manager_->SetVariableValues(variable.name, &value, 1, slot);
+    } else {
+      container[variable.id] = value;
+    }
+  }
+
+  template<typename T>
+  void SetEventValue(unsigned int slot, double *container, const Variable &variable, const ROOT::RVec<T> &value,
+                     long &n_tracks) const {
+    if (variable.column) {
+      // the length of the column is the length of the array of the event.
+      manager_->SetVariableValues(variable.name, value.data(), value.size(), slot);
+    } else if (variable.size > 1) {
+      // entries beyond the length of the column are set to NAN as in InputVariableManager::SetValues.
+      const auto size = std::min<std::size_t>(variable.size, value.size());
+      const auto begin = container + variable.id;
+      std::copy(value.begin(), value.begin() + size, begin);
+      std::fill(begin + size, begin + variable.size, NAN);
+    } else {
+      if (n_tracks > -1 && n_tracks!=static_cast<long>(value.size())) {
+        throw std::runtime_error("All track columns need to have the same length.");
+      }
+      n_tracks = value.size();
+    }
+  }
+
+  template<typename T>
+  static void SetTrackValue(double *, const Variable &, const T &, long) {}
+
+  template<typename T>
+  static void SetTrackValue(double *container, const Variable &variable, const ROOT::RVec<T> &value, long track) {
+    if (variable.size==1 && !variable.column) container[variable.id] = value[track];
+  }
+};
+}
+
+#endif //FLOW_CORRECTIONHELPER_H
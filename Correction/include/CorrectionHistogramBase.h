@@ -4,6 +4,7 @@
 /// \file QnCorrectionsHistogramBase.h
 /// \brief Multidimensional profile histograms base class for the Q vector correction framework
 
+#include <vector>
 #include <THn.h>
 #include "CorrectionAxisSet.h"
 namespace Qn {
@@ -58,7 +59,7 @@ class CorrectionHistogramBase {
   void FillBinAxesValues(Int_t chgrpId = -1);
   THnF *DivideTHnF(THnF *values, THnI *entries, THnC *valid = nullptr);
   void CopyTHnF(THnF *hDest, THnF *hSource, Int_t *binsArray);
-  void CopyTHnFDimension(THnF *hDest, THnF *hSource, Int_t *binsArray, Int_t dimension);
+  void AddDenseBinCounts(THnBase *hDest, const std::vector<Long64_t> &counts);
 
   std::string fName;
   std::string fTitle;
@@ -80,6 +81,7 @@ class CorrectionHistogramBase {
   static const char *szYXCorrelationComponentSuffix;     ///< The suffix for the name of YX correlation component histograms
   static const char *szYYCorrelationComponentSuffix;     ///< The suffix for the name of YY correlation component histograms
   static const Int_t nMaxHarmonicNumberSupported;        ///< The maximum external harmonic number the framework support
+  static const Long64_t nMinNoOfBinsForParallelDivision; ///< The minimum number of bins for dividing histograms in parallel
   static const UInt_t harmonicNumberMask[];              ///< Mask for each external harmonic number
   static const UInt_t correlationXXmask;                 ///< Maks for XX correlation component
   static const UInt_t correlationXYmask;                 ///< Maks for XY correlation component
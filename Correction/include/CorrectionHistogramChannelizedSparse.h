@@ -49,6 +49,7 @@ class CorrectionHistogramChannelizedSparse : public CorrectionHistogramBase {
   Float_t GetBinContent(Long64_t bin);
   Float_t GetBinError(Long64_t bin);
   void Fill(Int_t nChannel, Float_t weight);
+  void FillCounts(const std::vector<Long64_t> &counts);
  private:
   THnSparseF *fValues = nullptr;              //!<! Cumulates values for each of the event classes
   Bool_t *fUsedChannel = nullptr;       //!<! array, which of the detector channels is used for this configuration
@@ -35,6 +35,7 @@ class CorrectionHistogramSparse : public CorrectionHistogramBase {
   Float_t GetBinContent(Long64_t bin);
   Float_t GetBinError(Long64_t bin);
   virtual void Fill(Float_t weight);
+  void FillCounts(const std::vector<Long64_t> &counts);
  private:
   THnSparseF *fValues = nullptr; //!<! Cumulates values for each of the event classes
   /// \cond CLASSIMP
@@ -41,11 +41,15 @@
 #include "DataContainer.h"
 #include "RunList.h"
 #include "DetectorList.h"
+#include "CalibrationInput.h"
+#include "CalibrationAccumulators.h"
+#include "CorrectionParameterFile.h"
 
 namespace Qn {
 class CorrectionManager {
   using CutCallBack =  std::function<std::unique_ptr<CutBase>(Qn::InputVariableManager *)>;
  public:
+  static constexpr auto kCorrectionListName = "CorrectionHistograms";
   CorrectionManager() = default;
   virtual ~CorrectionManager() = default;
   /**
@@ -58,6 +62,64 @@ class CorrectionManager {
     variable_manager_.CreateVariable(name, id, length);
   }
 
+  /**
+   * Add a variable to the variable manager behind all variables added so far.
+   * @param name Name of the variable
+   * @param length Length of the variable inside the array e.g. number of channels.
+   * @return Id of the variable inside the array used to pass the data into the framework.
+   */
+  unsigned int AddVariable(const std::string &name, const int length) {
+    return variable_manager_.CreateVariable(name, length);
+  }
+
+  /**
+   * Add a typed column to the variable manager.
+   * The values of each event are set with SetVariableValues, which also sets the length of the column.
+   * @tparam T type of the values: double, float or int.
+   * @param name Name of the column
+   * @param max_length maximum number of values in one event e.g. number of channels.
+   */
+  template<typename T>
+  void AddColumn(const std::string &name, const unsigned int max_length) {
+    variable_manager_.CreateColumn<T>(name, max_length);
+  }
+
+  /**
+   * Copies the values of the current event into a variable.
+   * @tparam T type of the values. They are converted to the type of the variable.
+   * @param name Name of the variable
+   * @param values pointer to the values
+   * @param n number of values. Remaining entries of the variable are set to NAN. Sets the length of a column.
+   * @param slot number of the slot
+   */
+  template<typename T>
+  void SetVariableValues(const std::string &name, const T *values, std::size_t n, unsigned int slot = 0) {
+    GetSlot(slot).variable_manager_.SetValues(name, values, n);
+  }
+
+  /**
+   * @brief Finds a variable of the variable manager.
+   * @param name Name of the variable
+   * @return Variable of the given name.
+   */
+  InputVariable FindVariable(const std::string &name) const { return variable_manager_.FindVariable(name); }
+
+  /**
+   * Creates the track columns used to fill all tracks of an event at once.
+   * @param names names of the track variables e.g. phi, weight, pT and rapidity. Each is a double column created
+   * with AddColumn, which holds the maximum number of tracks of an event.
+   * @return track columns. The arrays of each event are set with TrackColumns::Set.
+   */
+  TrackColumns CreateTrackColumns(const std::vector<std::string> &names) const {
+    for (const auto &name : names) {
+      auto variable = variable_manager_.FindVariable(name);
+      if (!variable.IsColumn() || !variable.IsType<double>()) {
+        throw std::invalid_argument("Track variable " + name + " needs to be a double column.");
+      }
+    }
+    return TrackColumns(names);
+  }
+
   /**
    * Adds a axis used for correction.
    * @param axis Axis used for correction. The name of the axis corresponds to the name of a variable.
@@ -202,11 +264,62 @@ class CorrectionManager {
     }
   }
   void SetFillOutputTree(bool tree) { fill_output_tree_ = tree; }
+  /**
+   * @brief Writes the output Q-vectors in the flat layout.
+   * Instead of one DataContainerQVector object per Q-vector, one fixed size float array branch is written for each
+   * harmonic and component plus the sum of weights and the number of contributors (see FlatQVectors).
+   * Read them with Qn::Correlation::DefineFlatQVectors.
+   * @param flat flag for the flat layout
+   */
+  void SetFlatOutputTree(bool flat) { flat_output_tree_ = flat; }
+  /**
+   * @brief Keeps the output Q-vectors in memory.
+   * The Q-vectors configured with SetOutputQVectors are available after each event through GetQVector and
+   * GetOutputQVectors. This allows to compute the correlations in the same event loop without an intermediate tree.
+   * If neither the output tree nor the in-memory output is enabled, the corrected Q-vectors are not copied.
+   * @param in_memory flag for keeping the output Q-vectors in memory.
+   */
+  void SetFillOutputInMemory(bool in_memory) { fill_output_in_memory_ = in_memory; }
   void SetFillCalibrationQA(bool calibration) { fill_qa_histos_ = calibration; }
   void SetFillValidationQA(bool validation) { fill_validation_qa_histos_ = validation; }
+  /**
+   * @brief Fills the event and detector QA histograms only for every n-th event of each slot.
+   * Only use before InitializeOnNode.
+   * @param n_events sampling of the events. 1 fills the QA histograms for all events.
+   */
+  void SetQASampling(unsigned int n_events) { qa_sampling_ = n_events; }
+  /**
+   * @brief Buffers the values of the event and detector QA histograms of each slot.
+   * The buffered values are added to the histograms in batches and completed in Finalize, so the QA histograms are
+   * only complete after Finalize. Only use before InitializeOnNode.
+   * @param n_entries number of buffered entries per histogram e.g. QAHisto1DPtr::kDefaultBufferSize.
+   * 0 fills the histograms directly, which is the default.
+   */
+  void SetQABufferSize(std::size_t n_entries) { qa_buffer_size_ = n_entries; }
+  /**
+   * @brief Starts the processing of a run.
+   * The calibration histograms are created for the first run and reused for the following runs. The histograms of
+   * the finished runs are kept as sparse histograms until Finalize converts them back.
+   * @param name name of the run
+   */
   void SetCurrentRunName(const std::string &name);
+  /**
+   * @brief Sets the order in which the runs are processed.
+   * When a run is started with SetCurrentRunName, the calibration histograms of the following run are read in the
+   * background. This requires the calibration input file to be written with WriteCorrectionList.
+   * Only use before the first run is started.
+   * @param runs names of the runs in the order of processing.
+   */
+  void SetRunList(std::vector<std::string> runs) { runs_ = RunList(std::move(runs)); }
   void SetCalibrationInputFileName(const std::string &file_name) { correction_input_file_name_ = file_name; }
   void SetCalibrationInputFile(TFile *file) { correction_input_file_.reset(file); }
+  /**
+   * @brief Reads the correction parameters from a correction parameter file instead of the calibration histograms.
+   * The file is written with ExportCorrectionParameters. No ROOT I/O is needed to initialize the corrections.
+   * Steps without parameters in the file start collecting their calibration histograms as usual.
+   * @param file_name name of the correction parameter file
+   */
+  void SetCorrectionParameterFileName(const std::string &file_name) { correction_parameter_file_name_ = file_name; }
 
   /**
    * @brief Set output tree.
@@ -215,6 +328,35 @@ class CorrectionManager {
    */
   void ConnectOutputTree(TTree *tree) { if (fill_output_tree_) out_tree_ = tree; }
 
+#ifdef QN_RNTUPLE
+  /**
+   * @brief Set output RNTuple.
+   * The output Q-vectors are written in the flat layout together with the event variables.
+   * Read them with ROOT::Experimental::MakeNTupleDataFrame and Qn::Correlation::DefineFlatQVectors.
+   * @param name name of the RNTuple
+   * @param file non-owning pointer to the output file. Lifetime is managed by the user.
+   * @param compression compression setting of the RNTuple
+   */
+  void ConnectOutputNTuple(const std::string &name, TFile *file, int compression = 505) {
+    if (fill_output_tree_) out_ntuple_ = std::make_unique<OutputNTuple>(name, file, compression);
+  }
+#endif
+
+  /**
+   * @brief Sets the number of slots used for event-parallel processing.
+   * Each slot owns a clone of the detectors, the variable container, the calibration and the QA histograms.
+   * Events of one slot have to be processed by one thread at a time. The histograms of all slots are merged in
+   * Finalize(). To be called before InitializeOnNode().
+   * @param n_slots number of slots e.g. the number of worker threads.
+   */
+  void SetNumberOfSlots(unsigned int n_slots);
+
+  /**
+   * @brief Returns the number of slots used for event-parallel processing.
+   * @return number of slots
+   */
+  unsigned int GetNumberOfSlots() const { return n_slots_; }
+
   /**
    * @brief Initializes the correction framework
    * @param in_calibration_file_ non-owning pointer to the calibration file.
@@ -222,18 +364,38 @@ class CorrectionManager {
    */
   void InitializeOnNode();
 
-  bool ProcessEvent();
+  bool ProcessEvent(unsigned int slot = 0);
 
-  double *GetVariableContainer() { return variable_manager_.GetVariableContainer(); }
+  double *GetVariableContainer(unsigned int slot = 0) { return GetSlot(slot).variable_manager_.GetVariableContainer(); }
 
-  inline void FillTrackingDetectors() { if (event_passed_cuts_) detectors_.FillTracking(); }
-  inline void FillChannelDetectors() { if (event_passed_cuts_) detectors_.FillChannel(); }
+  inline void FillTrackingDetectors(unsigned int slot = 0) {
+    auto &manager = GetSlot(slot);
+    if (manager.event_passed_cuts_) manager.detectors_.FillTracking();
+  }
+  /**
+   * @brief Fills all tracks of the event into the tracking detectors.
+   * Replaces the calls of FillTrackingDetectors() for each track. The cuts and QA histograms of the detectors are
+   * evaluated once over the columns of all tracks.
+   * @param tracks columns of the track variables of the current event. Created by CreateTrackColumns.
+   * @param slot number of the slot
+   */
+  inline void FillTrackingDetectors(const TrackColumns &tracks, unsigned int slot = 0) {
+    auto &manager = GetSlot(slot);
+    if (manager.event_passed_cuts_) {
+      tracks.CopyTo(manager.variable_manager_);
+      manager.detectors_.FillTracking(tracks);
+    }
+  }
+  inline void FillChannelDetectors(unsigned int slot = 0) {
+    auto &manager = GetSlot(slot);
+    if (manager.event_passed_cuts_) manager.detectors_.FillChannel();
+  }
 
-  void ProcessCorrections();
+  void ProcessCorrections(unsigned int slot = 0);
   /**
    * @brief Resets the correction framework. To be called before a new event is processed.
    */
-  void Reset();
+  void Reset(unsigned int slot = 0);
 
   /**
  * @brief Finalizes the correction framework. To be called after all events are processed.
@@ -250,32 +412,110 @@ class CorrectionManager {
    */
   TList *GetCorrectionList() { return correction_output.get(); }
 
+  /**
+   * @brief Writes the calibration histograms with one key per run.
+   * Used as calibration input file the histograms of each run are only read when the run is processed.
+   * @param directory directory to which the calibration histograms are written.
+   */
+  void WriteCorrectionList(TDirectory *directory) const {
+    CalibrationInput::Write(correction_output.get(), directory, kCorrectionListName);
+  }
+
+  /**
+   * @brief Writes the calibration histograms as mergeable accumulators.
+   * The files of many jobs are merged with the MergeCalibration tool, which also writes the merged calibration input
+   * file. Only use after Finalize.
+   * @param file_name name of the accumulator file
+   */
+  void WriteCalibrationAccumulators(const std::string &file_name) const {
+    CalibrationAccumulators accumulators;
+    accumulators.Add(correction_output.get());
+    accumulators.Write(file_name);
+  }
+
+  /**
+   * @brief Exports the correction parameters of all runs of the calibration input to a correction parameter file.
+   * The correction manager needs to be configured as for applying the corrections and to be initialized with
+   * InitializeOnNode. The calibration histograms of each run are attached to a copy of the detectors and the frozen
+   * parameters of the applied correction steps are written. The current run and the outputs are not changed.
+   * @param file_name name of the correction parameter file
+   */
+  void ExportCorrectionParameters(const std::string &file_name);
+
   /**
    * @brief Get the list containing the calibration QA histograms.
    * @return A pointer of the list to which the calibration QA histograms will be saved.
    */
   TList *GetCorrectionQAList() { return correction_qa_histos_.get(); }
 
+  /**
+   * @brief Get the Q-vectors of the current event of a slot.
+   * Q-vectors of correction steps, which are not configured as output, are copied from the sub-events in every event
+   * after the first request.
+   * @param detector name of the detector
+   * @param step correction step of the Q-vectors
+   * @param slot number of the slot
+   * @return A pointer to the container of Q-vectors. Lifetime is managed by the detector.
+   */
+  DataContainerQVector *GetQVector(const std::string &detector, QVector::CorrectionStep step, unsigned int slot = 0) {
+    return GetSlot(slot).detectors_.FindDetector(detector).GetQVector(step);
+  }
+
+  /**
+   * @brief Get the output Q-vectors of the current event of a slot.
+   * Available after SetCurrentRunName was called.
+   * @param slot number of the slot
+   * @return map of the output Q-vectors. The keys are "<detector name>_<correction step>".
+   */
+  std::map<std::string, const DataContainerQVector *> GetOutputQVectors(unsigned int slot = 0) {
+    return GetSlot(slot).detectors_.GetOutputQVectors();
+  }
+
  private:
+  /**
+   * @brief Creates a worker with the configuration of the other correction manager.
+   * Only use before InitializeOnNode is called.
+   * @param other correction manager which is supposed to be copied.
+   */
+  CorrectionManager(const CorrectionManager &other);
+  /**
+   * @brief Returns the correction manager which processes the events of the slot.
+   * @param slot number of the slot. Slot 0 is processed by this correction manager.
+   * @return correction manager of the slot. Throws std::out_of_range if the slot does not exist.
+   */
+  CorrectionManager &GetSlot(unsigned int slot) { return slot==0 ? *this : *workers_.at(slot - 1); }
+  void InitializeSlot();
   void InitializeCorrections();
   void AttachQAHistograms();
-  static constexpr auto kCorrectionListName = "CorrectionHistograms";
+  void PrepareRun(TList *current_input, const CorrectionParameterFile *current_parameters);
   bool fill_qa_histos_ = true; ///< Flag for filling QA histograms
   bool fill_validation_qa_histos_ = true; ///< Flag for filling calibration bin validation histograms
   bool fill_output_tree_ = false; ///< Flag for filling the output tree
+  bool fill_output_in_memory_ = false; ///< Flag for keeping the output Q-vectors in memory
+  bool flat_output_tree_ = false; ///< Flag for writing the output Q-vectors in the flat layout
   bool event_passed_cuts_ = false; ///< variable holding status if an event passed the cuts.
+  unsigned int qa_sampling_ = 1; ///< QA histograms are filled for every n-th event
+  std::size_t qa_buffer_size_ = 0; ///< number of buffered entries per QA histogram. 0 disables the buffer.
   RunList runs_; ///< list of processed runs
   DetectorList detectors_; ///< list of detectors
   InputVariableManager variable_manager_; ///< manager of the variables
   std::string correction_input_file_name_; ///< name of the calibration input file
-  std::unique_ptr<TList> correction_input_;      //!<! the list of the input calibration histograms
+  std::string correction_parameter_file_name_; ///< name of the correction parameter file
+  CalibrationInput correction_input_;            //!<! the input calibration histograms of all runs
+  CorrectionParameterFile correction_parameters_; //!<! the input correction parameters of all runs
   std::unique_ptr<TList> correction_output;      //!<! the list of the support histograms
+  TList *current_output_ = nullptr;              //!<! histograms of the current run. Owned by correction_output.
   std::unique_ptr<TList> correction_qa_histos_;  //!<! the list of QA histograms
-  std::unique_ptr<TFile> correction_input_file_; //!<! input calibration file
+  std::unique_ptr<TFile> correction_input_file_; //!<! input calibration file until it is opened by the calibration input
   CorrectionAxisSet correction_axes_; /// CorrectionCalculator correction axes
   CorrectionCuts event_cuts_; ///< Pointer to the event cuts
   QAHistograms event_histograms_; ///< event QA histograms
   TTree *out_tree_ = nullptr;  //!<! Tree of Qn Vectors and event variables. Lifetime is managed by the user.
+#ifdef QN_RNTUPLE
+  std::unique_ptr<OutputNTuple> out_ntuple_; //!<! RNTuple of Qn Vectors and event variables.
+#endif
+  unsigned int n_slots_ = 1; ///< number of slots used for event-parallel processing
+  std::vector<std::unique_ptr<CorrectionManager>> workers_; //!<! correction managers processing the slots 1..n-1
  /// \cond CLASSIMP
  ClassDef(CorrectionManager, 1);
  /// \endcond
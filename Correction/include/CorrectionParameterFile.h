@@ -0,0 +1,132 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_CORRECTIONPARAMETERFILE_H
+#define FLOW_CORRECTIONPARAMETERFILE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "CorrectionParameterTable.h"
+
+namespace Qn {
+/**
+ * @class CorrectionParameterFile
+ * @brief Compact binary file of the frozen correction parameter tables.
+ * The file contains the tables of the correction steps of all sub-events for one or more runs. It is mapped into
+ * memory when it is opened and a table is copied out of the mapping when a correction step requests it. This avoids
+ * reading and dividing the calibration histograms with ROOT I/O when a job is initialized.
+ *
+ * Layout (native byte order, all offsets in bytes from the start of the file, all sections aligned to 8 bytes):
+ * - header: char magic[8] "QnCorPar", uint32 version, uint32 number of tables.
+ * - index: one record of 64 bytes per table: uint64 offsets of the zero terminated run, sub-event and step names,
+ *   int64 number of bins, uint32 number of parameters, uint32 number of harmonic slots, uint64 mask of the harmonics,
+ *   uint64 offset of the parameters (double [bin][harmonic][parameter]), uint64 offset of the validation flags
+ *   (char [bin]).
+ * - names and data sections.
+ * The version is increased whenever the layout or the meaning of the parameters of a correction step changes.
+ * Files with a different version are rejected.
+ */
+class CorrectionParameterFile {
+ public:
+  static constexpr std::uint32_t kVersion = 3;
+
+  /**
+   * @brief Collects the tables and writes them to a file.
+   */
+  class Writer {
+   public:
+    /**
+     * @brief Adds a copy of a table.
+     * @param run name of the run
+     * @param sub_event name of the sub-event
+     * @param step name of the correction step
+     * @param table frozen correction parameters
+     */
+    void Add(const std::string &run, const std::string &sub_event, const std::string &step,
+             const CorrectionParameterTable &table) {
+      tables_[std::make_tuple(run, sub_event, step)] = table;
+    }
+    /**
+     * @brief Writes all added tables. Throws if the file cannot be written.
+     * @param file_name name of the output file.
+     */
+    void Write(const std::string &file_name) const;
+   private:
+    std::map<std::tuple<std::string, std::string, std::string>, CorrectionParameterTable> tables_; ///< added tables
+  };
+
+  CorrectionParameterFile() = default;
+  ~CorrectionParameterFile() { Close(); }
+  CorrectionParameterFile(const CorrectionParameterFile &) = delete;
+  CorrectionParameterFile &operator=(const CorrectionParameterFile &) = delete;
+
+  /**
+   * @brief Maps the file into memory and reads its index. Throws if the file is not a valid parameter file.
+   * @param file_name name of the file
+   */
+  void Open(const std::string &file_name);
+  void Close();
+  bool IsOpen() const { return data_!=nullptr; }
+
+  /**
+   * @brief Returns if the file contains tables of the sub-event in the run.
+   * @param run name of the run
+   * @param sub_event name of the sub-event
+   */
+  bool Contains(const std::string &run, const std::string &sub_event) const;
+
+  /**
+   * @brief Reads a table from the mapped file.
+   * The layout of the table in the file has to match the layout expected by the correction step. A table written
+   * with a different binning of the event classes or with different harmonics is not read.
+   * @param run name of the run
+   * @param sub_event name of the sub-event
+   * @param step name of the correction step
+   * @param n_bins expected number of event class bins
+   * @param n_parameters expected number of parameters per harmonic
+   * @param n_harmonics expected number of harmonic slots per bin
+   * @param harmonics expected mask of the harmonics
+   * @param table table receiving the parameters. It is not modified if the table is not read.
+   * @return true if the table was found and matches the expected layout.
+   */
+  bool Read(const std::string &run, const std::string &sub_event, const std::string &step,
+            Long64_t n_bins, unsigned int n_parameters, unsigned int n_harmonics, std::uint64_t harmonics,
+            CorrectionParameterTable &table) const;
+
+ private:
+  /**
+   * Position of a table inside the mapped file.
+   */
+  struct Entry {
+    Long64_t n_bins;
+    unsigned int n_parameters;
+    unsigned int n_harmonics;
+    std::uint64_t harmonics;
+    const Double_t *parameters;
+    const char *validated;
+  };
+  const char *data_ = nullptr; ///< start of the mapped file
+  std::size_t size_ = 0; ///< size of the mapped file
+  std::map<std::tuple<std::string, std::string, std::string>, Entry> entries_; ///< index of the tables
+};
+}
+
+#endif //FLOW_CORRECTIONPARAMETERFILE_H
@@ -0,0 +1,155 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_CORRECTIONPARAMETERTABLE_H
+#define FLOW_CORRECTIONPARAMETERTABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "QVector.h"
+
+namespace Qn {
+/**
+ * @class CorrectionParameterTable
+ * @brief Flat table of the correction parameters of a correction step.
+ * The parameters are stored per [event class bin][harmonic]. They are computed once from the input calibration
+ * histograms after they are attached, so applying the correction requires a single lookup per event.
+ * The harmonic is addressed by its number. By default each bin reserves space for all harmonics supported by the
+ * Q-vector. Steps without harmonics use a single slot addressed by harmonic 0. The harmonics, for which parameters
+ * are stored, are recorded as a mask, so that a table read from a file can be checked against the correction step.
+ * Next to the parameters the table counts the events, which fall into bins without validated calibration. The
+ * counters are kept when the table is filled again for the next run, because the binning does not change.
+ */
+class CorrectionParameterTable {
+ public:
+  CorrectionParameterTable() = default;
+
+  /**
+   * @brief Allocates the table. All bins are marked as not validated.
+   * @param n_bins number of event class bins including under- and overflow bins.
+   * @param n_parameters number of parameters per harmonic.
+   * @param n_harmonics number of harmonic slots per bin.
+   */
+  void Reset(Long64_t n_bins, unsigned int n_parameters, unsigned int n_harmonics = QVector::kmaxharmonics + 1) {
+    n_parameters_ = n_parameters;
+    n_harmonics_ = n_harmonics;
+    stride_ = n_harmonics*n_parameters;
+    harmonics_ = 0;
+    parameters_.assign(n_bins*stride_, 0.);
+    validated_.assign(n_bins, false);
+    failures_.resize(n_bins, 0);
+  }
+
+  /**
+   * @brief Records the harmonics, for which parameters are stored.
+   * @param harmonics mask of the harmonics. Bit h-1 is set for harmonic h.
+   */
+  void SetHarmonics(std::uint64_t harmonics) { harmonics_ = harmonics; }
+
+  /**
+   * @brief Fills the table with parameters computed elsewhere e.g. read from a correction parameter file.
+   * @param n_bins number of event class bins including under- and overflow bins.
+   * @param n_parameters number of parameters per harmonic.
+   * @param n_harmonics number of harmonic slots per bin.
+   * @param harmonics mask of the harmonics, for which parameters are stored.
+   * @param parameters n_bins*n_harmonics*n_parameters parameters [bin][harmonic][parameter]
+   * @param validated n_bins validation flags [bin]
+   */
+  void Assign(Long64_t n_bins, unsigned int n_parameters, unsigned int n_harmonics, std::uint64_t harmonics,
+              const Double_t *parameters, const char *validated) {
+    n_parameters_ = n_parameters;
+    n_harmonics_ = n_harmonics;
+    harmonics_ = harmonics;
+    stride_ = n_harmonics*n_parameters;
+    parameters_.assign(parameters, parameters + n_bins*stride_);
+    validated_.assign(validated, validated + n_bins);
+    failures_.resize(n_bins, 0);
+  }
+
+  /**
+   * @brief Releases the table. The failure counters are kept.
+   */
+  void Clear() {
+    parameters_.clear();
+    validated_.clear();
+  }
+
+  bool IsEmpty() const { return validated_.empty(); }
+  Long64_t GetNoOfBins() const { return validated_.size(); }
+  unsigned int GetNoOfParameters() const { return n_parameters_; }
+  unsigned int GetNoOfHarmonics() const { return n_harmonics_; }
+  std::uint64_t GetHarmonics() const { return harmonics_; }
+  const Double_t *GetParameterArray() const { return parameters_.data(); }
+  const char *GetValidatedArray() const { return validated_.data(); }
+
+  /**
+   * @brief Marks the calibration of the bin as validated.
+   * @param bin event class bin
+   */
+  void SetValidated(Long64_t bin) { validated_[bin] = true; }
+
+  /**
+   * @brief Returns if the calibration of the bin is validated.
+   * @param bin event class bin
+   * @return true if the bin contains validated parameters.
+   */
+  bool Validated(Long64_t bin) const { return validated_[bin]; }
+
+  /**
+   * @brief Returns the parameters of one harmonic in one bin.
+   * @param bin event class bin
+   * @param harmonic harmonic number
+   * @return pointer to the first of the n_parameters parameters of the harmonic.
+   */
+  Double_t *Parameters(Long64_t bin, int harmonic) { return &parameters_[bin*stride_ + harmonic*n_parameters_]; }
+  const Double_t *Parameters(Long64_t bin, int harmonic) const {
+    return &parameters_[bin*stride_ + harmonic*n_parameters_];
+  }
+
+  /**
+   * @brief Counts an event in a bin without validated calibration.
+   * @param bin event class bin
+   */
+  void CountFailure(Long64_t bin) { ++failures_[bin]; }
+
+  /**
+   * @brief Returns the number of events per bin without validated calibration.
+   * @return failure counters [bin]
+   */
+  const std::vector<Long64_t> &GetFailures() const { return failures_; }
+
+  /**
+   * @brief Sets all failure counters to zero e.g. after they are transferred to the QA histograms.
+   */
+  void ResetFailures() { std::fill(failures_.begin(), failures_.end(), 0); }
+
+ private:
+  unsigned int n_parameters_ = 0; ///< number of parameters per harmonic
+  unsigned int n_harmonics_ = 0; ///< number of harmonic slots per bin
+  std::size_t stride_ = 0; ///< number of parameters per bin
+  std::uint64_t harmonics_ = 0; ///< mask of the harmonics with parameters
+  std::vector<Double_t> parameters_; ///< parameters [bin][harmonic][parameter]
+  std::vector<char> validated_; ///< validation of the calibration [bin]
+  std::vector<Long64_t> failures_; ///< number of events without validated calibration [bin]
+};
+}
+
+#endif //FLOW_CORRECTIONPARAMETERTABLE_H
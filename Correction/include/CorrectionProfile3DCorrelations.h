@@ -4,6 +4,8 @@
 /// \file QnCorrectionsProfile3DCorrelations.h
 /// \brief Three detector correlation components based set of profiles with harmonic support for the Q vector correction framework
 
+#include <vector>
+
 #include "CorrectionHistogramBase.h"
 namespace Qn {
 class QVector;
@@ -45,6 +47,21 @@ class QVector;
 /// \date Jan 19, 2016
 class CorrectionProfile3DCorrelations : public CorrectionHistogramBase {
  public:
+  /// \enum Combination
+  /// \brief The correlated Qn vector combinations
+  enum class Combination {
+    AB = 0, ///< A times B
+    BC = 1, ///< B times C
+    AC = 2, ///< C times A
+  };
+  /// \enum Component
+  /// \brief The correlation components
+  enum class Component {
+    XX = 0, ///< x times x
+    XY = 1, ///< x times y
+    YX = 2, ///< y times x
+    YY = 3, ///< y times y
+  };
   CorrectionProfile3DCorrelations() = default;
   CorrectionProfile3DCorrelations(
       std::string name,
@@ -61,29 +78,30 @@ class CorrectionProfile3DCorrelations : public CorrectionHistogramBase {
       std::string nameC,
       const CorrectionAxisSet &ecvs,
       ErrorMode mode = ErrorMode::MEAN);
-  virtual ~CorrectionProfile3DCorrelations();
+  virtual ~CorrectionProfile3DCorrelations() = default;
   Bool_t CreateCorrelationComponentsProfileHistograms(TList *histogramList,
                                                       Int_t nNoOfHarmonics,
                                                       Int_t nHarmonicMultiplier = 1,
                                                       Int_t *harmonicMap = NULL);
   virtual Bool_t AttachHistograms(TList *histogramList);
   virtual Long64_t GetBin();
+  Long64_t GetNoOfBins() const { return fEntries ? fEntries->GetNbins() : 0; }
   virtual Bool_t BinContentValidated(Long64_t bin);
-  virtual Float_t GetXXBinContent(const char *comb, Int_t harmonic, Long64_t bin);
-  virtual Float_t GetXYBinContent(const char *comb, Int_t harmonic, Long64_t bin);
-  virtual Float_t GetYXBinContent(const char *comb, Int_t harmonic, Long64_t bin);
-  virtual Float_t GetYYBinContent(const char *comb, Int_t harmonic, Long64_t bin);
-  virtual Float_t GetXXBinError(const char *comb, Int_t harmonic, Long64_t bin);
-  virtual Float_t GetXYBinError(const char *comb, Int_t harmonic, Long64_t bin);
-  virtual Float_t GetYXBinError(const char *comb, Int_t harmonic, Long64_t bin);
-  virtual Float_t GetYYBinError(const char *comb, Int_t harmonic, Long64_t bin);
+  Float_t GetBinContent(Combination comb, Component component, Int_t harmonic, Long64_t bin);
+  Float_t GetBinError(Combination comb, Component component, Int_t harmonic, Long64_t bin);
   void Fill(const QVector *QnA, const QVector *QnB,
             const QVector *QnC);
  private:
-  THnF ***fXXValues = nullptr;            //!<! XX component histogram for each requested harmonic
-  THnF ***fXYValues = nullptr;            //!<! XY component histogram for each requested harmonic
-  THnF ***fYXValues = nullptr;            //!<! YX component histogram for each requested harmonic
-  THnF ***fYYValues = nullptr;            //!<! YY component histogram for each requested harmonic
+  static constexpr Int_t kNoOfComponents = 4; ///< the number of correlation components
+  /// Get the position of a component histogram in the values store
+  /// \param comb the Qn vector combination
+  /// \param component the correlation component
+  /// \param harmonic the external harmonic number
+  /// \return the index in the values store
+  static Int_t GetIndex(Int_t comb, Int_t component, Int_t harmonic) {
+    return (comb*kNoOfComponents + component)*(nMaxHarmonicNumberSupported + 1) + harmonic;
+  }
+  std::vector<THnF *> fValues;            //!<! component histograms [combination][component][harmonic]
   THnI *fEntries = nullptr;             //!<! Cumulates the number on each of the event classes
   std::string fNameA;               ///< the name of the A detector
   std::string fNameB;               ///< the name of the B detector
@@ -67,6 +67,8 @@ class CorrectionProfileChannelized : public CorrectionHistogramBase {
   virtual ~CorrectionProfileChannelized();
   Bool_t CreateProfileHistograms(TList *histogramList, const Bool_t *bUsedChannel, const Int_t *nChannelGroup);
   Long64_t GetBin(Int_t nChannel);
+  /// Number of bins including the channel axis. Zero before the histograms are created.
+  Long64_t GetNoOfBins() const { return fEntries ? fEntries->GetNbins() : 0; }
   Bool_t BinContentValidated(Long64_t bin);
   Float_t GetBinContent(Long64_t bin);
   Float_t GetBinError(Long64_t bin);
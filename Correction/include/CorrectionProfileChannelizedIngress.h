@@ -53,6 +53,9 @@ class CorrectionProfileChannelizedIngress : public CorrectionHistogramBase {
   Bool_t AttachHistograms(TList *histogramList, const Bool_t *bUsedChannel, const Int_t *nChannelGroup);
   Long64_t GetBin(Int_t nChannel);
   Long64_t GetGrpBin(Int_t nChannel);
+  Long64_t GetNoOfBins() const { return fValues->GetNbins(); }
+  Int_t GetChannel(Long64_t bin);
+  Long64_t GetGrpBinOfBin(Long64_t bin);
   Bool_t BinContentValidated(Long64_t bin);
   Float_t GetBinContent(Long64_t bin);
   Float_t GetGrpBinContent(Long64_t bin);
@@ -51,6 +51,7 @@ class CorrectionProfileComponents : public CorrectionHistogramBase {
   Bool_t CreateComponentsProfileHistograms(TList *histogramList, Int_t nNoOfHarmonics, Int_t *harmonicMap = NULL);
   Bool_t AttachHistograms(TList *histogramList);
   Long64_t GetBin();
+  Long64_t GetNoOfBins() const { return fEntries ? fEntries->GetNbins() : 0; }
   Bool_t BinContentValidated(Long64_t bin);
   Float_t GetXBinContent(Int_t harmonic, Long64_t bin);
   Float_t GetYBinContent(Int_t harmonic, Long64_t bin);
@@ -36,6 +36,7 @@ class CorrectionProfileCorrelationComponents : public CorrectionHistogramBase {
   Bool_t CreateCorrelationComponentsProfileHistograms(TList *histogramList);
   Bool_t AttachHistograms(TList *histogramList);
   Long64_t GetBin();
+  Long64_t GetNoOfBins() const { return fEntries ? fEntries->GetNbins() : 0; }
   Bool_t BinContentValidated(Long64_t bin);
   Float_t GetXXBinContent(Long64_t bin);
   Float_t GetXYBinContent(Long64_t bin);
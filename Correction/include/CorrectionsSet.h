@@ -17,6 +17,7 @@
 
 #include <list>
 #include <set>
+#include <vector>
 
 #include "CorrectionBase.h"
 #include "CorrectionOnQnVector.h"
@@ -72,6 +73,14 @@ class CorrectionsSet {
     }
   }
 
+/// Appends the correction steps in the order of application
+/// \param steps list where the correction steps are appended
+  void FillCorrectionsList(std::vector<CorrectionBase *> &steps) const {
+    for (auto &entry : list_) {
+      steps.push_back(entry.get());
+    }
+  }
+
 /// Gets the correction on Qn vector previous to the one passed as argument
 /// \param correction the correction to find the previous one
 /// \return the previous correction, NULL if none
@@ -104,7 +113,7 @@ class CorrectionsSet {
 
   bool IsLastStepApplied() const {
     if (!list_.empty()) {
-      return (*list_.end())->IsBeingApplied();
+      return list_.back()->IsBeingApplied();
     }
     return false;
   }
@@ -123,7 +132,8 @@ class CorrectionsSet {
     }
   }
 
-  void AttachInputs(TList *input_list) {
+  template<typename... INPUT>
+  void AttachInputs(const INPUT &... input) {
     T *previous_correction = nullptr;
     for (auto &correction : list_) {
       if (previous_correction) {
@@ -132,7 +142,7 @@ class CorrectionsSet {
         }
       }
       if (correction->GetState()==CorrectionBase::State::CALIBRATION) {
-        correction->AttachInput(input_list);
+        correction->AttachInput(input...);
       }
       previous_correction = correction.get();
     }
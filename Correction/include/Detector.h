@@ -18,8 +18,10 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <array>
 #include <utility>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "ROOT/RMakeUnique.hxx"
@@ -27,11 +29,18 @@
 #include "CorrectionAxisSet.h"
 #include "SubEventChannels.h"
 #include "SubEventTracks.h"
+#include "SubEventStorage.h"
 #include "InputVariableManager.h"
 #include "DataContainer.h"
 #include "QVector.h"
 #include "QAHistogram.h"
 #include "CorrectionCuts.h"
+#include "FlatQVectors.h"
+#include "TrackColumns.h"
+#include "CorrectionParameterFile.h"
+#ifdef QN_RNTUPLE
+#include "OutputNTuple.h"
+#endif
 
 namespace Qn {
 class DetectorList;
@@ -66,6 +75,8 @@ class Detector {
     for (auto &bin : sub_events_) {
       bin->Clear();
     }
+    data_vectors_.Clear();
+    data_vector_bins_.clear();
   }
   /**
    * @brief Adds a cut to the detector
@@ -115,15 +126,48 @@ class Detector {
 
   void Initialize(DetectorList &detectors, InputVariableManager &var, CorrectionAxisSet &correction_axis);
   void FillData();
-  void FillReport() {
-    int_cuts_.FillReport();
-    cuts_.FillReport();
+  void SelectTracks(std::size_t n_tracks);
+  void FillTracks(const TrackColumns &tracks);
+  /**
+   * @brief Sets the sampling of the QA histograms.
+   * @param n_events the QA histograms are filled for every n-th event.
+   */
+  void SetQASampling(unsigned int n_events) { histograms_.SetSampling(n_events); }
+  /**
+   * @brief Buffers the values of the QA histograms.
+   * @param n_entries number of buffered entries per histogram. 0 fills the histograms directly.
+   */
+  void SetQABufferSize(std::size_t n_entries) { histograms_.SetBufferSize(n_entries); }
+  void NextQAEvent() { histograms_.NextEvent(); }
+  void FlushQA() {
+    for (auto &ev : sub_events_) { ev->FillNveQAHistograms(); }
+    histograms_.Flush();
+    int_cuts_.FlushReport();
+    cuts_.FlushReport();
   }
   void CreateSupportQVectors() { for (auto &ev : sub_events_) { ev->CreateSupportQVectors(); }}
 
-  void AttachCorrectionInputs(TList *list) {
+  template<typename... INPUT>
+  void AttachCorrectionInputs(const INPUT &... input) {
     for (auto &ev : sub_events_) {
-      ev->AttachCorrectionInput(list);
+      ev->AttachCorrectionInput(input...);
+    }
+  }
+
+  /**
+   * @brief Adds the correction parameters of the applied correction steps to the writer.
+   * @param writer writer of the correction parameter file
+   * @param run name of the current run
+   */
+  void ExportCorrectionParameters(CorrectionParameterFile::Writer &writer, const std::string &run) const {
+    for (const auto &ev : sub_events_) {
+      std::set<CorrectionBase *> steps;
+      ev->FillOverallInputCorrectionStepList(steps);
+      ev->FillOverallQnVectorCorrectionStepList(steps);
+      for (auto step : steps) {
+        auto parameters = step->GetCorrectionParameters();
+        if (parameters && step->ReportUsage().second) writer.Add(run, ev->GetName(), step->GetName(), *parameters);
+      }
     }
   }
 
@@ -138,6 +182,11 @@ class Detector {
       ev->CreateCorrectionHistograms();
     }
   }
+  void EnableFirstCorrections() {
+    for (auto &ev : sub_events_) {
+      ev->EnableFirstCorrection();
+    }
+  }
   void CopyToOutputList(TList* list) {
     for (auto &ev : sub_events_) {
       ev->CopyToOutputList(list);
@@ -147,8 +196,11 @@ class Detector {
 
   bool IsIntegrated() const { return sub_events_.IsIntegrated(); }
   void ProcessCorrections();
-  void IncludeQnVectors();
-  void AttachToTree(TTree *tree);
+  void IncludeQnVectors(bool fill_output);
+  void AttachToTree(TTree *tree, bool flat);
+#ifdef QN_RNTUPLE
+  void AttachToNTuple(OutputNTuple &ntuple);
+#endif
   void ActivateHarmonic(unsigned int i) {
     harmonics_bits_.set(i - 1);
     for (auto &ev : sub_events_) {
@@ -164,12 +216,44 @@ class Detector {
   Qn::QVector::Normalization GetNormalizationMethod() const { return q_vector_normalization_method_; }
   std::string GetName() const { return name_; }
   std::string GetBinName(unsigned int id) const { return sub_events_.GetBinDescription(id); }
-  SubEvent *GetSubEvent(unsigned int ibin) { return sub_events_.At(ibin).get(); }
+  SubEvent *GetSubEvent(unsigned int ibin) { return sub_events_.At(ibin); }
   TList *CreateQAHistogramList(bool fill_qa, bool fill_validation);
 
-  DataContainerQVector *GetQVector(QVector::CorrectionStep step) { return q_vectors_.at(step).get(); }
+  DataContainerQVector *GetQVector(QVector::CorrectionStep step);
+
+  /**
+   * @brief Returns the output Q-vectors of the detector.
+   * @return map of the output Q-vectors. The keys are "<detector name>_<correction step>".
+   */
+  std::map<std::string, const DataContainerQVector *> GetOutputQVectors() const {
+    std::map<std::string, const DataContainerQVector *> output;
+    for (auto step : output_tree_q_vectors_) {
+      if (q_vectors_[step]) output.emplace(name_ + "_" + kCorrectionStepNamesArray[step], q_vectors_[step].get());
+    }
+    return output;
+  }
 
  private:
+  /**
+   * Adds a data vector to the current event.
+   * @param bin sub-event bin of the data vector
+   * @param id id of the channel
+   * @param phi azimuthal angle of the channel or track
+   * @param weight weight applied to the channel or track
+   * @param radial_offset radial offset of the channel
+   */
+  void AddDataVector(long bin, int id, float phi, float weight, float radial_offset) {
+    data_vectors_.Add(id, phi, weight, radial_offset);
+    data_vector_bins_.push_back(bin);
+  }
+  void GroupDataVectors();
+  void CollectCorrectionSteps();
+  void ApplyCorrectionSteps(const std::vector<CorrectionBase *> &steps);
+  void CollectCorrectionData(const std::vector<CorrectionBase *> &steps);
+  void AddQVectorContainer(QVector::CorrectionStep step);
+
+  static constexpr std::size_t kNCorrectionSteps = kCorrectionStepNamesArray.size(); ///< number of correction steps
+
   InputVariable phi_; /// variable holding the azimuthal angle
   InputVariable weight_; /// variable holding the weight which is used for the calculation of the Q vector.
   InputVariable radial_offset_; /// variable holding the radial offset
@@ -180,13 +264,30 @@ class Detector {
   Qn::QVector::Normalization q_vector_normalization_method_ = Qn::QVector::Normalization::NONE;
   std::vector<InputVariable> input_variables_; //!<! variables used for the binning of the Q vector.
   std::vector<float> coordinates_;  //!<!  vector holding the temporary coordinates of one track or channel.
-  std::map<QVector::CorrectionStep, std::unique_ptr<DataContainerQVector>> q_vectors_; //!<! output qvectors
+  std::vector<std::uint64_t> track_selection_; //!<! selection bits of the tracks of the current event
+  std::vector<unsigned int> selected_tracks_; //!<! indices of the selected tracks of the current event
+  std::vector<TrackColumns::Column> track_coordinates_; //!<! columns of the binning variables of the tracks
+  CorrectionDataVectors data_vectors_; //!<! data vectors of the current event in the order of filling
+  std::vector<long> data_vector_bins_; //!<! sub-event bin of each data vector
+  CorrectionDataVectors arena_; //!<! data vectors of the current event grouped by sub-event
+  std::vector<std::size_t> bin_offsets_; //!<! start of the data vectors of each sub-event in the arena
+  std::vector<std::size_t> bin_positions_; //!<! insert positions used while grouping the data vectors
+  std::vector<CorrectionBase *> input_correction_steps_; //!<! input data correction steps of all sub-events [step][bin]
+  std::vector<CorrectionBase *> q_vector_correction_steps_; //!<! Q-vector correction steps of all sub-events [step][bin]
+  std::vector<char> sub_event_applied_; //!<! all correction steps of the sub-event were applied so far [bin]
+  std::array<std::unique_ptr<DataContainerQVector>, kNCorrectionSteps> q_vectors_; //!<! output qvectors [step]
+  std::array<std::vector<const QVector *>, kNCorrectionSteps> q_vector_sources_; //!<! sub-event qvectors [step][bin]
   std::vector<QVector::CorrectionStep> output_tree_q_vectors_; /// Holds correction steps used for the output
+  std::map<QVector::CorrectionStep, FlatQVectors> flat_q_vectors_; //!<! output qvectors in the flat tree layout
+#ifdef QN_RNTUPLE
+  std::map<QVector::CorrectionStep, FlatQVectors> ntuple_q_vectors_; //!<! output qvectors of the RNTuple
+#endif
   CorrectionCuts cuts_; /// per channel selection  cuts
   CorrectionCuts int_cuts_; /// integrated selection cuts
   QAHistograms histograms_; /// QA histograms of the detector
   std::vector<Qn::AxisD> axes_; /// Holds axes till they are used to configure the subevents
-  Qn::DataContainer<std::unique_ptr<SubEvent>, AxisD> sub_events_; //!<! SubEvents of the detector
+  SubEventStorage sub_event_storage_; //!<! SubEvents of the detector in one contiguous block
+  Qn::DataContainer<SubEvent *, AxisD> sub_events_; //!<! SubEvents of the detector by bin. Owned by the storage.
   Qn::DetectorList *detectors_ = nullptr; /// Pointer to the list of detectors
   TObjArray correction_on_q_vector; /// Holds the correction steps till they are used to configure the sub events
   TObjArray correction_on_input_data; /// Holds the correction steps till they are used to configure the sub events
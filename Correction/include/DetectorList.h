@@ -18,11 +18,17 @@
 #ifndef FLOW_DETECTORLIST_H
 #define FLOW_DETECTORLIST_H
 
+#include <sstream>
+
 #include "Detector.h"
 namespace Qn {
 class DetectorList {
  public:
   DetectorList() = default;
+  /// Copies the configuration of the detectors. The copy is initialized with Initialize.
+  DetectorList(const DetectorList &other) :
+      channel_detectors_(other.channel_detectors_),
+      tracking_detectors_(other.tracking_detectors_) {}
   virtual ~DetectorList() = default;
   void AddDetector(std::string name,
                    Qn::DetectorType type,
@@ -63,17 +69,28 @@ class DetectorList {
     }
   }
 
-  void SetOutputTree(TTree *output_tree) {
+  void SetOutputTree(TTree *output_tree, bool flat) {
     if (output_tree) {
       for (auto &detector : tracking_detectors_) {
-        detector.AttachToTree(output_tree);
+        detector.AttachToTree(output_tree, flat);
       }
       for (auto &detector : channel_detectors_) {
-        detector.AttachToTree(output_tree);
+        detector.AttachToTree(output_tree, flat);
       }
     }
   }
 
+#ifdef QN_RNTUPLE
+  void SetOutputNTuple(OutputNTuple &ntuple) {
+    for (auto &detector : tracking_detectors_) {
+      detector.AttachToNTuple(ntuple);
+    }
+    for (auto &detector : channel_detectors_) {
+      detector.AttachToNTuple(ntuple);
+    }
+  }
+#endif
+
   void Initialize(DetectorList &detectors, InputVariableManager &var, CorrectionAxisSet &axes) {
     for (auto &detector : channel_detectors_) {
       all_detectors_.push_back(&detector);
@@ -91,6 +108,19 @@ class DetectorList {
     }
   }
 
+  /**
+   * @brief Fills all tracks of the event into the tracking detectors.
+   * Each detector evaluates its cuts and QA histograms once over the track columns of the variable manager and
+   * fills its selected tracks in one loop over the columns.
+   * @param tracks columns of the track variables of the current event
+   */
+  void FillTracking(const TrackColumns &tracks) {
+    for (auto &dp : tracking_detectors_) {
+      dp.SelectTracks(tracks.size());
+      dp.FillTracks(tracks);
+    }
+  }
+
   void FillChannel() {
     for (auto &dp : channel_detectors_) {
       dp.FillData();
@@ -109,15 +139,15 @@ class DetectorList {
     }
   }
 
-  void FillReport() {
+  void CreateCorrectionHistograms() {
     for (auto &d : all_detectors_) {
-      d->FillReport();
+      d->CreateCorrectionHistograms();
     }
   }
 
-  void CreateCorrectionHistograms() {
+  void EnableFirstCorrections() {
     for (auto &d : all_detectors_) {
-      d->CreateCorrectionHistograms();
+      d->EnableFirstCorrections();
     }
   }
 
@@ -127,15 +157,22 @@ class DetectorList {
     }
   }
 
-  void AttachCorrectionInput(TList *list) {
+  template<typename... INPUT>
+  void AttachCorrectionInput(const INPUT &... input) {
     for (auto &d : all_detectors_) {
-      d->AttachCorrectionInputs(list);
+      d->AttachCorrectionInputs(input...);
     }
     for (auto &d : all_detectors_) {
       d->AfterInputAttachAction();
     }
   }
 
+  void ExportCorrectionParameters(CorrectionParameterFile::Writer &writer, const std::string &run) const {
+    for (const auto &d : all_detectors_) {
+      d->ExportCorrectionParameters(writer, run);
+    }
+  }
+
   void AttachQAHistograms(TList *list, bool fill_qa, bool fill_validation) {
     for (auto &detector: all_detectors_) {
       auto detector_list = detector->CreateQAHistogramList(fill_qa, fill_validation);
@@ -143,38 +180,79 @@ class DetectorList {
     }
   }
 
+  void SetQASampling(unsigned int n_events) {
+    for (auto &d : all_detectors_) {
+      d->SetQASampling(n_events);
+    }
+  }
+
+  void SetQABufferSize(std::size_t n_entries) {
+    for (auto &d : all_detectors_) {
+      d->SetQABufferSize(n_entries);
+    }
+  }
+
+  void NextQAEvent() {
+    for (auto &d : all_detectors_) {
+      d->NextQAEvent();
+    }
+  }
+
+  void FlushQA() {
+    for (auto &d : all_detectors_) {
+      d->FlushQA();
+    }
+  }
+
   void ResetDetectors() {
     for (auto &d : all_detectors_) {
       d->ClearData();
     }
   }
 
-  void IncludeQnVectors() {
+  void IncludeQnVectors(bool fill_output) {
     for (auto &d : all_detectors_) {
-      d->IncludeQnVectors();
+      d->IncludeQnVectors(fill_output);
+    }
+  }
+
+  std::map<std::string, const DataContainerQVector *> GetOutputQVectors() const {
+    std::map<std::string, const DataContainerQVector *> output;
+    for (const auto &d : all_detectors_) {
+      auto detector_output = d->GetOutputQVectors();
+      output.insert(detector_output.begin(), detector_output.end());
     }
+    return output;
   }
 
-  void CreateReport() {
+  /**
+   * Prints the state of the correction steps of all detectors.
+   * @param only_if_changed only print the report if it differs from the previously printed report.
+   */
+  void CreateReport(bool only_if_changed = false) {
+    std::ostringstream report;
     auto iteration = CalculateProgress(all_detectors_);
-    std::cout << "iteration " << iteration.first << " of " << iteration.second << std::endl;
+    report << "iteration " << iteration.first << " of " << iteration.second << std::endl;
     for (auto &d : all_detectors_) {
       auto corrections = d->GetSubEvent(0)->ReportOnCorrections();
-      std::cout << d->GetName() << std::endl;
+      report << d->GetName() << std::endl;
       for (const auto &step : corrections) {
-        std::cout << step.first << " : ";
+        report << step.first << " : ";
         if (step.second.first) {
-          std::cout << "collecting ";
+          report << "collecting ";
         }
         if (step.second.second) {
-          std::cout << "applying";
+          report << "applying";
         }
         if (!step.second.first && !step.second.second) {
-          std::cout << "waiting";
+          report << "waiting";
         }
-        std::cout << std::endl;
+        report << std::endl;
       }
     }
+    if (only_if_changed && report.str()==last_report_) return;
+    last_report_ = report.str();
+    std::cout << last_report_;
   }
 
  private:
@@ -198,6 +276,7 @@ class DetectorList {
   std::vector<Detector> tracking_detectors_; ///< vector of tracking detectors
   std::vector<Detector> channel_detectors_; ///< vector of channel detectors
   std::vector<Detector *> all_detectors_; ///!<! storing pointers to all detectors
+  std::string last_report_; //!<! last printed report
 
   /// \cond CLASSIMP
  ClassDef(DetectorList, 1);
@@ -50,10 +50,14 @@
 /// in the calibration one, collecting data for producing, once merged in a
 /// further phase, the calibration histograms.
 
+#include <vector>
+
 #include "CorrectionOnInputData.h"
 #include "CorrectionProfileChannelizedIngress.h"
 #include "CorrectionProfileChannelized.h"
 #include "CorrectionHistogramChannelizedSparse.h"
+#include "CorrectionParameterTable.h"
+#include "CorrectionBatch.h"
 
 namespace Qn {
 
@@ -123,7 +127,8 @@ class GainEqualization : public CorrectionOnInputData {
                                                     fScale(other.fScale),
                                                     fUseChannelGroupsWeights(other.fUseChannelGroupsWeights),
                                                     fHardCodedWeights(other.fHardCodedWeights),
-                                                    fMinNoOfEntriesToValidate(other.fMinNoOfEntriesToValidate) {
+                                                    fMinNoOfEntriesToValidate(other.fMinNoOfEntriesToValidate),
+                                                    fUseGainTable(other.fUseGainTable) {
   }
 
   virtual CorrectionOnInputData *MakeCopy() const { return dynamic_cast<CorrectionOnInputData *>(new GainEqualization(*this)); }
@@ -144,24 +149,43 @@ class GainEqualization : public CorrectionOnInputData {
   /// Set the minimum number of entries for calibration histogram bin content validation
   /// \param nNoOfEntries the number of entries threshold
   void SetNoOfEntriesThreshold(Int_t nNoOfEntries) { fMinNoOfEntriesToValidate = nNoOfEntries; }
+  /// Enable or disable the per channel gain table
+  /// The equalization parameters of all channels are looked up once per event class bin
+  /// and applied as a factor and an offset to the weight of each channel.
+  /// \param enable kTRUE / kFALSE for enable / disable it
+  void SetUseGainTable(Bool_t enable) { fUseGainTable = enable; }
 
   /// Informs when the detector configuration has been attached to the framework manager
   /// Basically this allows interaction between the different framework sections at configuration time
   /// No action for input gain equalization
   virtual void AttachedToFrameworkManager() {}
   virtual void AttachInput(TList *list);
+  virtual void AttachInput(const CorrectionParameterFile &parameters, const std::string &run);
+  virtual const CorrectionParameterTable *GetCorrectionParameters() const { return &fParameters; }
   virtual void CreateSupportQVectors();
   virtual void CreateCorrectionHistograms();
   virtual void AttachQAHistograms(TList *list);
   virtual void AttachNveQAHistograms(TList *list);
+  virtual void FillNveQAHistograms();
 
   virtual Bool_t ProcessCorrections();
+  virtual void ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied);
   virtual Bool_t ProcessDataCollection();
   /// Clean the correction to accept a new event
   /// Does nothing for the time being
   virtual void ClearCorrectionStep() {}
 
  private:
+  void FreezeInput();
+  void UpdateGainTable();
+  void BuildGainTable();
+  /// The weights are equalized with the gain table built from the correction parameters
+  Bool_t UsesGainTable() const {
+    return (fUseGainTable || fParametersFromFile) && fEqualizationMethod!=Method::NONE;
+  }
+  void FillBeforeEqualization();
+  void EqualizeWithGainTable();
+  void FillAfterEqualization();
   using State = Qn::CorrectionBase::State;
   static constexpr const unsigned int szPriority =
       CorrectionOnInputData::Priority::kGainEqualization; ///< the key of the correction step for ordering purpose
@@ -189,9 +213,20 @@ class GainEqualization : public CorrectionOnInputData {
   const Float_t
       *fHardCodedWeights = nullptr;             //!<! group hard coded weights stored in the detector configuration
   Int_t fMinNoOfEntriesToValidate = 2;              ///< number of entries for bin content validation threshold
+  Bool_t fUseGainTable = false;                     ///< apply the equalization with the per channel gain table
+  Int_t fGainTableChannel = -1;     //!<! reference channel used to identify the event class bin of the gain table
+  Long64_t fGainTableBin = -1;      //!<! bin of the reference channel the gain table was built for
+  std::vector<Double_t> fGainFactors; //!<! equalization factor per channel
+  std::vector<Double_t> fGainOffsets; //!<! equalization offset per channel
+  std::vector<char> fGainValidated;   //!<! validation of the calibration per channel
+  std::vector<Long64_t> fGainBins;    //!<! bin of the correction parameters per channel
+  Bool_t fGainAllValidated = false;   //!<! the calibration of all used channels is validated
+  CorrectionParameterTable fParameters; //!<! equalization factor and offset per event class and channel
+  Bool_t fParametersFromFile = false; //!<! the parameters were read from a correction parameter file
+  std::vector<char> fBatchUsesGainTable; //!<! sub-events of the batch equalized with the gain table
 
 /// \cond CLASSIMP
- ClassDef(GainEqualization, 2);
+ ClassDef(GainEqualization, 3);
 /// \endcond
 };
 }
@@ -18,43 +18,90 @@
 #ifndef QN_INPUTVARIABLE
 #define QN_INPUTVARIABLE
 
+#include <string>
+#include <type_traits>
+
 namespace Qn {
 /**
  * Variable
+ * Span over the values of one variable of the variable manager.
+ * The values are either a range of the positional double container or a typed column (double, float or int),
+ * which is owned by the variable manager. Columns have a length which can change from event to event.
  * Constructor is private so it is only created in the variable manager
- * with the correct pointer to the values container.
+ * with the correct pointer to the values.
  */
 class InputVariable {
+ public:
+  /**
+   * Type of the values of the variable.
+   */
+  enum class Type : unsigned char {
+    kDouble,
+    kFloat,
+    kInt
+  };
  private:
   InputVariable(const unsigned int id, const unsigned int length, std::string name) :
       id_(id),
       size_(length),
       name_(std::move(name)) {}
   InputVariable(const unsigned int id, const unsigned int length) : id_(id), size_(length) {}
-  unsigned int id_{0}; /// position in the values container
-  unsigned int size_{0}; /// length in the  values container
-  double *values_container_ = nullptr; //!<! pointer to the values container
+  unsigned int id_{0}; /// position in the values container. Zero for columns.
+  unsigned int size_{0}; /// maximum number of values of the variable
+  Type type_ = Type::kDouble; /// type of the values
+  bool column_ = false; /// true if the values are a column owned by the variable manager
+  void *values_ = nullptr; //!<! pointer to the first value of the variable
+  const unsigned int *length_ = nullptr; //!<! number of values of the current event. Null if the length is fixed.
   std::string name_; /// name of the variable
   friend class InputVariableManager;
   friend class CorrectionCuts;
  public:
   InputVariable() = default;
   virtual ~InputVariable() = default;
-  inline double operator[](std::size_t i) const noexcept { return values_container_[id_ + i];}
-  inline double *begin() noexcept { return &values_container_[id_]; } /// implements begin for iteration
-  inline double *end() noexcept { return &values_container_[id_ + size_]; } /// implements end for iteration
-  const double *begin() const noexcept { return &values_container_[id_]; }  /// implements begin for iteration
-  inline double *end() const noexcept { return &values_container_[id_ + size_]; }  /// implements end for iteration
-  inline double *at(std::size_t i) noexcept { return &values_container_[id_ + i]; }
-  const inline double *Get() const noexcept { return &values_container_[id_]; }
+  /**
+   * Returns the value converted to double.
+   * @param i index of the value. Has to be smaller than size().
+   */
+  inline double operator[](std::size_t i) const noexcept {
+    switch (type_) {
+      case Type::kFloat: return static_cast<const float *>(values_)[i];
+      case Type::kInt: return static_cast<const int *>(values_)[i];
+      default: return static_cast<const double *>(values_)[i];
+    }
+  }
+  /**
+   * Returns the values with their own type.
+   * @tparam T type of the values. Has to match the type of the variable.
+   * @return pointer to the first value. Null if the type does not match.
+   */
+  template<typename T>
+  const T *Data() const noexcept { return IsType<T>() ? static_cast<const T *>(values_) : nullptr; }
+  template<typename T>
+  T *Data() noexcept { return IsType<T>() ? static_cast<T *>(values_) : nullptr; }
+  /**
+   * Checks the type of the values.
+   * @tparam T double, float or int
+   */
+  template<typename T>
+  bool IsType() const noexcept {
+    return (std::is_same<T, double>::value && type_==Type::kDouble)
+        || (std::is_same<T, float>::value && type_==Type::kFloat)
+        || (std::is_same<T, int>::value && type_==Type::kInt);
+  }
+  /**
+   * Number of values of the current event. Equal to size() if the length is fixed.
+   */
+  inline unsigned int GetLength() const noexcept { return length_ ? *length_ : size_; }
   inline unsigned int size() const noexcept { return size_; }
   inline unsigned int GetID() const noexcept { return id_; }
+  inline Type GetType() const noexcept { return type_; }
+  inline bool IsColumn() const noexcept { return column_; }
   std::string GetName() const { return name_; }
 
   /// \cond CLASSIMP
- ClassDef(InputVariable, 1);
+ ClassDef(InputVariable, 2);
 /// \endcond
 };
 }
 
-#endif
\ No newline at end of file
+#endif
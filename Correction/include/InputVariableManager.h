@@ -18,13 +18,21 @@
 #ifndef FLOW_INPUTVARIABLEMANAGER_H
 #define FLOW_INPUTVARIABLEMANAGER_H
 
+#include <algorithm>
 #include <string>
 #include <map>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include <cmath>
 #include "TTree.h"
 
 #include "InputVariable.h"
+#ifdef QN_RNTUPLE
+#include "OutputNTuple.h"
+#endif
 
 /**
  * @brief Attaches a variable to a chosen tree.
@@ -38,7 +46,7 @@ class OutputValue {
   /**
    * @brief updates the value. To be called every event.
    */
-  void UpdateValue() { value_ = (T) (*var_->begin()); }
+  void UpdateValue() { value_ = (T) ((*var_)[0]); }
   /**
    * @brief Creates a new branch in the tree.
    * @param tree output tree
@@ -46,6 +54,20 @@ class OutputValue {
   void SetToTree(TTree *tree) {
     tree->Branch(var_->GetName().data(), &value_);
   }
+#ifdef QN_RNTUPLE
+  /**
+   * @brief Creates a new field in the RNTuple.
+   * @param ntuple output RNTuple
+   */
+  void SetToNTuple(Qn::OutputNTuple &ntuple) {
+    ntuple.AddVariable(var_->GetName(), &value_);
+  }
+#endif
+  /**
+   * @brief Returns the name of the variable which is written.
+   * @return name of the variable
+   */
+  std::string GetName() const { return var_->GetName(); }
  private:
   T value_; /// value which is written
   Qn::InputVariable *var_; /// Variable to be written to the tree
@@ -55,7 +77,9 @@ namespace Qn {
 /**
  * @brief Manages the input variables for the correction step.
  * A variable consist of a name and a unsigned integer position in the value array and an unsigned integer length.
- * Different variables all access the same variable container.
+ * These positional variables all access the same double values container.
+ * Columns are variables with their own typed values (double, float or int) and a length, which is set for each event
+ * by SetValues. The values of a column are allocated when it is created and do not move afterwards.
  */
 class InputVariableManager {
  public:
@@ -67,29 +91,56 @@ class InputVariableManager {
     CreateVariableOnes();
   }
 
-  virtual ~InputVariableManager() {
-    for (auto &var : channel_variables_) {
-      delete[] var;
+  /**
+   * @brief Copy constructor. Only use before Initialize is called.
+   * Copies the configuration of the variables. The values containers are created in Initialize.
+   * Columns are copied with their values and bound to the copy.
+   * @param other variable manager which is supposed to be copied.
+   */
+  InputVariableManager(const InputVariableManager &other) :
+      container_size_(other.container_size_),
+      max_length_(other.max_length_),
+      columns_(other.columns_),
+      variable_map_(other.variable_map_) {
+    for (auto &var : variable_map_) {
+      if (var.second.column_) InitVariable(var.second);
     }
+    for (const auto &element : other.variable_output_float_) { RegisterOutputF(element.GetName()); }
+    for (const auto &element : other.variable_output_integer_) { RegisterOutputL(element.GetName()); }
   }
 
-  void Initialize() {
-    variable_values_float_ = new f_type[kMaxSize]; /// non-owning pointer to variables
-    variable_values_ones_ = new f_type[kMaxSize]; /// values container of ones.
+  virtual ~InputVariableManager() = default;
 
+  /**
+   * @brief Creates the values containers.
+   * The values container is as large as needed by the positional variables.
+   * The container of ones is as long as the longest variable.
+   */
+  void Initialize() {
+    variable_values_float_.assign(container_size_, NAN);
+    variable_values_ones_.assign(std::max(max_length_, 1u), 1.0);
     for (auto &var : variable_map_) {
-      var.second.values_container_ = variable_values_float_;
+      InitVariable(var.second);
     }
-    variable_map_["Ones"].values_container_ = variable_values_ones_;
-    for (int i = 0; i < kMaxSize; ++i) { variable_values_float_[i] = NAN; }
-    for (unsigned int i = 0; i < kMaxSize; ++i) { variable_values_ones_[i] = 1.0; }
   }
 
+  /**
+   * @brief Points the variable to its values in this variable manager.
+   * @param var variable which is bound.
+   */
   void InitVariable(InputVariable &var) {
-    if (var.name_=="Ones") {
-      var.values_container_ = variable_values_ones_;
+    if (var.column_) {
+      switch (var.type_) {
+        case InputVariable::Type::kFloat: BindColumn(var, FindColumn<float>(var.name_));
+          break;
+        case InputVariable::Type::kInt: BindColumn(var, FindColumn<int>(var.name_));
+          break;
+        default: BindColumn(var, FindColumn<double>(var.name_));
+      }
+    } else if (var.name_=="Ones") {
+      var.values_ = variable_values_ones_.data();
     } else {
-      var.values_container_ = variable_values_float_;
+      var.values_ = variable_values_float_.data() + var.id_;
     }
   }
 
@@ -102,26 +153,64 @@ class InputVariableManager {
   void CreateVariable(std::string name, const int id, const int length) {
     InputVariable var(id, length, name);
     variable_map_.emplace(name, var);
+    container_size_ = std::max(container_size_, static_cast<unsigned int>(id + length));
+    UpdateMaxLength(length);
+  }
+  /**
+   * @brief Creates a new variable behind all variables created so far.
+   * @param name Name of the new variable.
+   * @param length length of the variable in the values container.
+   * @return position of the variable in the values container.
+   */
+  unsigned int CreateVariable(std::string name, const int length) {
+    const auto id = container_size_;
+    CreateVariable(std::move(name), id, length);
+    return id;
+  }
+  /**
+   * @brief Creates a typed column.
+   * The values are initialized to NAN for floating point types and to zero for int. The length is zero until
+   * values are set with SetValues.
+   * @tparam T type of the values: double, float or int.
+   * @param name name of the column
+   * @param max_length maximum number of values of the column in one event.
+   */
+  template<typename T>
+  void CreateColumn(const std::string &name, const unsigned int max_length) {
+    if (variable_map_.find(name)!=variable_map_.end()) {
+      throw std::invalid_argument("Variable " + name + " already exists.");
+    }
+    auto &column = std::get<ColumnMap<T>>(columns_)[name];
+    column.values.assign(max_length, Padding<T>());
+    InputVariable var(0, max_length, name);
+    var.type_ = ColumnType<T>();
+    var.column_ = true;
+    BindColumn(var, column);
+    variable_map_.emplace(name, var);
+    UpdateMaxLength(max_length);
   }
   /**
    * @brief Initializes the variable container for ones.
+   * It is as long as the longest variable registered so far.
    */
   void CreateVariableOnes() {
-    InputVariable var(0, kMaxSize, "Ones");
+    InputVariable var(0, std::max(max_length_, 1u), "Ones");
     variable_map_.emplace("Ones", var);
   }
   /**
    * @brief Creates a channel variable (variables which counts from 0 to the size-1).
+   * It is a double column with a fixed length.
    * @param name name of the variable
    * @param size number of channels
    */
   void CreateChannelVariable(const std::string &name, const int size) {
-    InputVariable var(0, size, name);
-    auto *arr = new f_type[size];
-    for (int i = 0; i < size; ++i) { arr[i] = i; }
-    var.values_container_ = arr;
-    variable_map_.emplace(name, var);
-    channel_variables_.push_back(arr);
+    if (!variable_values_ones_.empty() && static_cast<std::size_t>(size) > variable_values_ones_.size()) {
+      throw std::logic_error("Channel variable " + name + " is longer than the longest variable.");
+    }
+    CreateColumn<double>(name, size);
+    auto &column = std::get<ColumnMap<double>>(columns_).at(name);
+    for (int i = 0; i < size; ++i) { column.values[i] = i; }
+    column.length = size;
   }
   /**
    * @brief Finds the variable in the variable manager.
@@ -148,10 +237,42 @@ class InputVariableManager {
    */
   int FindNum(const std::string &name) const { return variable_map_.at(name).id_; }
   /**
-   * @brief Get the values container.
+   * @brief Get the values container of the positional variables.
    * @return a pointer to the values container.
    */
-  f_type *GetVariableContainer() { return variable_values_float_; }
+  f_type *GetVariableContainer() { return variable_values_float_.data(); }
+  /**
+   * @brief Copies the values of the current event into a variable.
+   * The values are converted to the type of the variable. Entries beyond n are set to NAN or to zero for int columns.
+   * The length of a column is set to n.
+   * @tparam T type of the values e.g. float or int.
+   * @param name name of the variable
+   * @param values pointer to the values
+   * @param n number of values. Needs to be smaller or equal to the length of the variable.
+   */
+  template<typename T>
+  void SetValues(const std::string &name, const T *values, std::size_t n) {
+    auto &variable = variable_map_.at(name);
+    if (n > variable.size_) {
+      throw std::out_of_range("Variable " + name + " holds only " + std::to_string(variable.size_) + " values.");
+    }
+    switch (variable.type_) {
+      case InputVariable::Type::kFloat: CopyValues(variable.Data<float>(), variable.size_, values, n);
+        break;
+      case InputVariable::Type::kInt: CopyValues(variable.Data<int>(), variable.size_, values, n);
+        break;
+      default: CopyValues(variable.Data<double>(), variable.size_, values, n);
+    }
+    if (variable.column_) {
+      switch (variable.type_) {
+        case InputVariable::Type::kFloat: FindColumn<float>(name).length = n;
+          break;
+        case InputVariable::Type::kInt: FindColumn<int>(name).length = n;
+          break;
+        default: FindColumn<double>(name).length = n;
+      }
+    }
+  }
   /**
    * @brief Register the variable to be saved in the output tree as float.
    * Beware of conversion from double.
@@ -181,6 +302,17 @@ class InputVariableManager {
     for (auto &element : variable_output_integer_) { element.SetToTree(tree); }
   }
 
+#ifdef QN_RNTUPLE
+  /**
+   * @brief Creates fields in the RNTuple for saving the event information.
+   * @param ntuple output RNTuple to contain the event information
+   */
+  void SetOutputNTuple(OutputNTuple &ntuple) {
+    for (auto &element : variable_output_float_) { element.SetToNTuple(ntuple); }
+    for (auto &element : variable_output_integer_) { element.SetToNTuple(ntuple); }
+  }
+#endif
+
   /**
    * @brief Updates the output variables.
    */
@@ -190,15 +322,68 @@ class InputVariableManager {
   }
 
  private:
-  static constexpr int kMaxSize = 11000; /// Maximum number of variables.
-  f_type *variable_values_float_ = nullptr; //!<! non-owning pointer to variables
-  f_type *variable_values_ones_ = nullptr; //!<! values container of ones.
-  std::vector<double *> channel_variables_; //!<!
+  /**
+   * Values of a column and their number in the current event.
+   */
+  template<typename T>
+  struct Column {
+    std::vector<T> values;
+    unsigned int length = 0;
+  };
+  template<typename T>
+  using ColumnMap = std::map<std::string, Column<T>>;
+
+  template<typename T>
+  static constexpr InputVariable::Type ColumnType() {
+    static_assert(std::is_same<T, double>::value || std::is_same<T, float>::value || std::is_same<T, int>::value,
+                  "Columns are double, float or int.");
+    return std::is_same<T, float>::value ? InputVariable::Type::kFloat :
+           std::is_same<T, int>::value ? InputVariable::Type::kInt : InputVariable::Type::kDouble;
+  }
+
+  template<typename T>
+  static T Padding() {
+    if constexpr (std::is_floating_point<T>::value) {
+      return static_cast<T>(NAN);
+    } else {
+      return T{0};
+    }
+  }
+
+  /**
+   * @brief Records the length of a new variable. The variable of ones grows with the longest variable.
+   * @param length length of the new variable.
+   */
+  void UpdateMaxLength(const unsigned int length) {
+    max_length_ = std::max(max_length_, length);
+    variable_map_.at("Ones").size_ = std::max(max_length_, 1u);
+  }
+
+  template<typename T>
+  Column<T> &FindColumn(const std::string &name) { return std::get<ColumnMap<T>>(columns_).at(name); }
+
+  template<typename T>
+  static void BindColumn(InputVariable &var, Column<T> &column) {
+    var.values_ = column.values.data();
+    var.length_ = &column.length;
+  }
+
+  template<typename T, typename U>
+  static void CopyValues(T *destination, std::size_t size, const U *values, std::size_t n) {
+    std::transform(values, values + n, destination, [](const U &value) { return static_cast<T>(value); });
+    std::fill(destination + n, destination + size, Padding<T>());
+  }
+
+  unsigned int container_size_ = 0; /// size of the values container needed by the positional variables
+  unsigned int max_length_ = 0; /// length of the longest variable
+  std::vector<f_type> variable_values_float_; //!<! values container of the positional variables
+  std::vector<f_type> variable_values_ones_; //!<! values container of ones.
+  std::tuple<ColumnMap<double>, ColumnMap<float>, ColumnMap<int>> columns_; //!<! typed columns by name
   std::map<std::string, InputVariable> variable_map_; /// name to variable map
   std::vector<OutputValue<f_type>> variable_output_float_; //!<! variables registered for output as float
   std::vector<OutputValue<i_type>> variable_output_integer_; //!<! variables registered for output as long
   /// \cond CLASSIMP
- ClassDef(InputVariableManager, 1);
+ ClassDef(InputVariableManager, 3);
 /// \endcond
 };
 }
@@ -0,0 +1,97 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_OUTPUTNTUPLE_H
+#define FLOW_OUTPUTNTUPLE_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ROOT/RNTuple.hxx"
+#include "ROOT/RNTupleModel.hxx"
+#include "TFile.h"
+#include "TMap.h"
+
+#include "FlatQVectors.h"
+
+namespace Qn {
+/**
+ * @class OutputNTuple
+ * @brief Writes the corrected Q-vectors and the event variables to an RNTuple.
+ * The Q-vectors are written in the flat layout (see FlatQVectors). Each array is a std::vector field.
+ * The prototypes of the Q-vectors are written next to the RNTuple into the file as a TMap named
+ * "<ntuple name>_QVectorPrototypes". Read them with FlatQVectors::ReadPrototypes.
+ * Fields can only be added before the RNTuple is connected to the file.
+ */
+class OutputNTuple {
+ public:
+  /**
+   * Constructor
+   * @param name name of the RNTuple
+   * @param file output file. Lifetime is managed by the user.
+   * @param compression compression setting of the pages e.g. 505 for zstd level 5.
+   */
+  OutputNTuple(std::string name, TFile *file, int compression = 505);
+  ~OutputNTuple();
+
+  /**
+   * Adds a field for an event variable.
+   * @param name name of the field
+   * @param value value written in each event. It needs to stay at its position in memory.
+   */
+  void AddVariable(const std::string &name, const Double32_t *value);
+  void AddVariable(const std::string &name, const Long64_t *value);
+
+  /**
+   * Adds the fields of the Q-vectors and a copy of their prototype.
+   * @param q_vectors Q-vectors in the flat layout. They need to stay at their position in memory.
+   */
+  void AddQVectors(FlatQVectors *q_vectors);
+
+  /**
+   * Freezes the model and creates the RNTuple in the file.
+   */
+  void Connect();
+
+  bool IsConnected() const { return static_cast<bool>(writer_); }
+
+  /**
+   * Writes the current event.
+   */
+  void Fill();
+
+  /**
+   * Commits the last cluster and writes the prototypes into the file.
+   */
+  void Finalize();
+
+ private:
+  std::string name_; ///< name of the RNTuple
+  TFile *file_ = nullptr; ///< non-owning pointer to the output file
+  int compression_ = 0; ///< compression setting
+  std::unique_ptr<ROOT::Experimental::RNTupleModel> model_; ///< model until the RNTuple is connected
+  std::unique_ptr<ROOT::Experimental::RNTupleWriter> writer_; ///< writer after the RNTuple is connected
+  std::vector<std::function<void()>> copy_functions_; ///< copy the values of the current event into the fields
+  std::unique_ptr<TMap> prototypes_; ///< prototypes of the Q-vectors
+
+  void CheckNotConnected(const std::string &name) const;
+};
+}
+
+#endif //FLOW_OUTPUTNTUPLE_H
@@ -18,6 +18,8 @@
 #ifndef FLOW_QAHISTOGRAM_H
 #define FLOW_QAHISTOGRAM_H
 
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <vector>
 
@@ -34,12 +36,43 @@
 
 namespace Qn {
 namespace Impl {
+/**
+ * Staging buffer of the values of a QA histogram.
+ * @tparam N number of values per entry. The coordinates are followed by the weight.
+ */
+template<int N>
+struct QAHistoBuffer {
+  std::array<std::vector<double>, N> values; /// values of the buffered entries
+  std::size_t size() const { return values[0].size(); }
+  void clear() {
+    for (auto &value : values) value.clear();
+  }
+};
+
+/**
+ * Adds the buffered entries to the histogram and clears the buffer.
+ * Uniform axes are binned directly without the bin lookup of the histogram. The statistics and number of entries
+ * are updated as by TH1::FillN.
+ * @param histogram histogram which receives the entries.
+ * @param buffer buffered entries (x, weight).
+ */
+void FlushBuffer(TH1F *histogram, QAHistoBuffer<2> &buffer);
+/**
+ * Adds the buffered entries to the histogram and clears the buffer.
+ * @param histogram histogram which receives the entries.
+ * @param buffer buffered entries (x, y, weight).
+ */
+void FlushBuffer(TH2F *histogram, QAHistoBuffer<3> &buffer);
+
 /**
  * Base class of a QA histogram
  */
 struct QAHistoBase {
   virtual ~QAHistoBase() = default;
   virtual void Fill() = 0;
+  virtual void Fill(const std::vector<unsigned int> &entries) = 0;
+  virtual void Flush() = 0;
+  virtual void SetBufferSize(std::size_t) = 0;
   virtual void AddToList(TList *) = 0;
   static inline void FillHistogram(std::unique_ptr<QAHistoBase> &histo) { histo->Fill(); }
   virtual std::string GetName() const = 0;
@@ -47,6 +80,9 @@ struct QAHistoBase {
 };
 /**
  * Wrapper for a ROOT histogram, which allows it to be filled by the correction manager.
+ * By default the values are filled directly. Float and int columns are converted in the buffer, which is added to
+ * the histogram right away. If a buffer size is set, the values are collected in a buffer for each
+ * histogram and added to the histogram in batches. Flush has to be called before buffered histograms are read.
  * @tparam HISTO type of histogram.
  * @tparam N number of dimensions
  * @tparam VAR Type of the variable
@@ -70,12 +106,16 @@ class QAHisto : public QAHistoBase {
     } else {
       histo_.push_back(histo);
     }
+    buffers_.resize(histo_.size());
   }
   QAHisto(std::array<VAR, N> vec, HISTO histo) :
       vars_(std::move(vec)) {
     histo_.push_back(histo);
+    buffers_.resize(histo_.size());
   }
 
+  static constexpr std::size_t kDefaultBufferSize = 4096;
+
   /**
    * Implementation of the fill function
    * @tparam VARS type of array
@@ -86,11 +126,42 @@ class QAHisto : public QAHistoBase {
   void FillImpl(const VARS &variables, std::index_sequence<I...>) {
     auto bin = 0;
     if (axis_) {
-      bin = axis_->FindBin(*axisvar_.begin());
-      if (bin > -1) histo_.at(bin)->FillN(variables[0].size(), (variables[I].begin())...);
-    } else {
-      histo_.at(bin)->FillN(variables[0].size(), (variables[I].begin())...);
+      bin = axis_->FindBin(axisvar_[0]);
+      if (bin < 0) return;
     }
+    const auto n = std::min({variables[I].GetLength()...});
+    if (buffer_size_==0 && (variables[I].template IsType<double>() && ...)) {
+      histo_.at(bin)->FillN(n, (variables[I].template Data<double>())...);
+      return;
+    }
+    auto &buffer = buffers_.at(bin);
+    for (std::size_t i = 0; i < n; ++i) {
+      (buffer.values[I].push_back(variables[I][i]), ...);
+    }
+    if (buffer.size() >= buffer_size_) FlushBuffer(histo_[bin], buffer);
+  }
+  /**
+   * Implementation of the fill function for a subset of the entries of the variables.
+   * The values pass through the buffer. Variables with a single value, e.g. event variables used with track
+   * columns, are read with a stride of zero.
+   * @tparam VARS type of array
+   * @tparam I index sequence
+   * @param variables Array of variables used for filling the histogram
+   * @param entries indices of the filled entries
+   */
+  template<typename VARS, std::size_t... I>
+  void FillEntriesImpl(const VARS &variables, const std::vector<unsigned int> &entries, std::index_sequence<I...>) {
+    auto bin = 0;
+    if (axis_) {
+      bin = axis_->FindBin(axisvar_[0]);
+      if (bin < 0) return;
+    }
+    const std::array<std::size_t, N> strides{{(variables[I].GetLength() > 1 ? 1u : 0u)...}};
+    auto &buffer = buffers_.at(bin);
+    for (const auto entry : entries) {
+      (buffer.values[I].push_back(variables[I][entry*strides[I]]), ...);
+    }
+    if (buffer.size() >= buffer_size_) FlushBuffer(histo_[bin], buffer);
   }
   /**
    * Fill function.
@@ -98,6 +169,30 @@ class QAHisto : public QAHistoBase {
   void Fill() override {
     return FillImpl(vars_, std::make_index_sequence<N>{});
   };
+  /**
+   * Fills the selected entries of the variables.
+   * @param entries indices of the filled entries e.g. the selected tracks.
+   */
+  void Fill(const std::vector<unsigned int> &entries) override {
+    return FillEntriesImpl(vars_, entries, std::make_index_sequence<N>{});
+  }
+  /**
+   * Adds the buffered values to the histograms.
+   */
+  void Flush() override {
+    for (std::size_t i = 0; i < histo_.size(); ++i) {
+      FlushBuffer(histo_[i], buffers_[i]);
+    }
+  }
+  /**
+   * Sets the number of entries which are buffered before they are added to the histogram.
+   * Buffered values are added to the histogram before the size is changed.
+   * @param n_entries size of the buffer. 0 fills the histogram directly.
+   */
+  void SetBufferSize(std::size_t n_entries) override {
+    Flush();
+    buffer_size_ = n_entries;
+  }
   /**
    * Add the histogram to the list.
    * @param list pointer to the list. Lifetime of the histogram hast to be managed by the list.
@@ -121,6 +216,8 @@ class QAHisto : public QAHistoBase {
  private:
   std::array<VAR, N> vars_; /// Array of variables to be filled in the histogram.
   std::vector<HISTO> histo_; /// Histogram (e.g. TH1, TH2) which support the filling with FillN(...).
+  std::vector<QAHistoBuffer<N>> buffers_; /// buffered values of each histogram
+  std::size_t buffer_size_ = 0; /// number of buffered entries before the histogram is filled. 0 disables the buffer.
   std::unique_ptr<Qn::AxisD> axis_ = nullptr; // Creates a histogram for each bin of the axis
   VAR axisvar_;              /// input variable associated with the axis
   std::string name_;         /// name of the QA histogram
@@ -152,6 +249,9 @@ class QAHistogram {
   QAHistogram(std::string, std::vector<AxisD>, std::string, const Qn::AxisD&);
   void Initialize(InputVariableManager &var);
   void Fill() { histogram_->Fill(); }
+  void Fill(const std::vector<unsigned int> &entries) { histogram_->Fill(entries); }
+  void Flush() { if (histogram_) histogram_->Flush(); }
+  void SetBufferSize(std::size_t n_entries) { if (histogram_) histogram_->SetBufferSize(n_entries); }
   void AddToList(TList *list) { histogram_->AddToList(list); }
   std::string GetName() const {return name_;}
  private:
@@ -188,15 +288,64 @@ class QAHistograms {
       histo.Initialize(var);
     }
   }
+  /**
+   * Fills the histograms if the current event is sampled.
+   */
   void Fill() {
+    if (!fill_event_) return;
     for (auto &histo : histograms_) {
       histo.Fill();
     }
   }
+  /**
+   * Fills the selected entries of the variables if the current event is sampled.
+   * @param entries indices of the filled entries e.g. the selected tracks.
+   */
+  void Fill(const std::vector<unsigned int> &entries) {
+    if (!fill_event_) return;
+    for (auto &histo : histograms_) {
+      histo.Fill(entries);
+    }
+  }
+  /**
+   * Returns true if the histograms are filled in the current event.
+   */
+  bool IsFilled() const { return fill_event_ && !histograms_.empty(); }
+  /**
+   * Adds the buffered values to the histograms. Call before buffered histograms are read or merged.
+   */
+  void Flush() {
+    for (auto &histo : histograms_) {
+      histo.Flush();
+    }
+  }
+  /**
+   * Sets the sampling of the events.
+   * @param n_events the histograms are filled for every n-th event. 1 fills all events.
+   */
+  void SetSampling(unsigned int n_events) { sampling_ = n_events; }
+  /**
+   * Buffers the values of the initialized histograms.
+   * @param n_entries number of buffered entries per histogram. 0 fills the histograms directly.
+   */
+  void SetBufferSize(std::size_t n_entries) {
+    for (auto &histo : histograms_) {
+      histo.SetBufferSize(n_entries);
+    }
+  }
+  /**
+   * Starts a new event and decides if it is sampled.
+   */
+  void NextEvent() {
+    fill_event_ = sampling_ <= 1 || n_events_++%sampling_==0;
+  }
  private:
   std::vector<QAHistogram> histograms_;
+  unsigned int sampling_ = 1; ///< the histograms are filled for every n-th event
+  unsigned long n_events_ = 0; //!<! number of events since the start
+  bool fill_event_ = true; //!<! the current event is sampled
   /// \cond CLASSIMP
- ClassDef(QAHistograms, 1);
+ ClassDef(QAHistograms, 2);
 /// \endcond
 };
 }
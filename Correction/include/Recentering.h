@@ -52,6 +52,8 @@
 /// defined within the involved detector configuration
 
 #include "CorrectionOnQnVector.h"
+#include "CorrectionParameterTable.h"
+#include "CorrectionBatch.h"
 namespace Qn {
 /// \class QnCorrectionsQnVectorRecentering
 /// \brief Encapsulates recentering and width equalization on Q vector
@@ -121,6 +123,8 @@ class Recentering : public CorrectionOnQnVector {
   /// Basically this allows interaction between the different framework sections at configuration time
   /// No action for Qn vector recentering
   virtual void AttachInput(TList *list);
+  virtual void AttachInput(const CorrectionParameterFile &parameters, const std::string &run);
+  virtual const CorrectionParameterTable *GetCorrectionParameters() const { return &fParameters; }
   /// Perform after calibration histograms attach actions
   /// It is used to inform the different correction step that
   /// all conditions for running the network are in place so
@@ -131,11 +135,15 @@ class Recentering : public CorrectionOnQnVector {
   virtual void CreateCorrectionHistograms();
   virtual void AttachQAHistograms(TList *list);
   virtual void AttachNveQAHistograms(TList *list);
+  virtual void FillNveQAHistograms();
   virtual Bool_t ProcessCorrections();
+  virtual void ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied);
   virtual Bool_t ProcessDataCollection();
   virtual void ClearCorrectionStep();
 
  private:
+  void FreezeInput();
+  void ApplyCorrection(Long64_t &bin);
   using State = Qn::CorrectionBase::State;
   static constexpr const unsigned int
       szPriority = CorrectionOnQnVector::Step::kRecentering; ///< the key of the correction step for ordering purpose
@@ -152,6 +160,8 @@ class Recentering : public CorrectionOnQnVector {
       fQANotValidatedBin;     //!<! the histogram with non validated bin information
   std::unique_ptr<CorrectionProfileComponents>
       fQAQnAverageHistogram;  //!<! the after correction step average Qn components QA histogram
+  CorrectionParameterTable fParameters;   //!<! the correction parameters frozen from the calibration information
+  QnVectorBatch fBatch; //!<! rows of all sub-events of the detector corrected in one batch
   Bool_t fApplyWidthEqualization;               ///< apply the width equalization step
   Int_t fMinNoOfEntriesToValidate;              ///< number of entries for bin content validation threshold
 
@@ -18,6 +18,8 @@
 #ifndef FLOW_RUNLIST_H
 #define FLOW_RUNLIST_H
 
+#include <algorithm>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -38,6 +40,15 @@ class RunList {
     }
   }
   std::string GetCurrent() const { return current_run_name_; }
+  /**
+   * Returns the run following the current run in the list.
+   * @return name of the next run. Empty if the current run is the last one.
+   */
+  std::string GetNext() const {
+    auto current = std::find(run_list_.begin(), run_list_.end(), current_run_name_);
+    if (current==run_list_.end() || std::next(current)==run_list_.end()) return {};
+    return *std::next(current);
+  }
   bool empty() const { return run_list_.empty(); }
  private:
   std::string current_run_name_;
@@ -89,7 +89,7 @@ class SubEvent {
   /// Get the input data bank.
   /// Makes it available for input corrections steps.
   /// \return pointer to the input data bank
-  std::vector<Qn::CorrectionDataVector> &GetInputDataBank() { return fDataVectorBank; }
+  CorrectionDataVectorRange &GetInputDataBank() { return fDataVectorBank; }
   /// Get the event class variables set
   /// Makes it available for corrections steps
   /// \return pointer to the event class variables set
@@ -153,6 +153,12 @@ class SubEvent {
   /// \return kTRUE if everything went OK
   virtual void CreateCorrectionHistograms() = 0;
 
+  /// Enables the first correction step
+  ///
+  /// Used when the correction histograms of a previous run are reused for the next run.
+  /// Pure virtual function
+  virtual void EnableFirstCorrection() = 0;
+
   virtual void CopyToOutputList(TList* list) = 0;
 
   /// Asks for QA histograms creation
@@ -171,6 +177,12 @@ class SubEvent {
   /// \return kTRUE if everything went OK
   virtual void AttachNveQAHistograms(TList *list) = 0;
 
+  /// Fills the non validated entries QA histograms
+  ///
+  /// The request is transmitted to the different corrections.
+  /// Pure virtual function
+  virtual void FillNveQAHistograms() = 0;
+
   /// Asks for attaching the needed input information to the correction steps
   ///
   /// The request is transmitted to the different corrections.
@@ -178,6 +190,13 @@ class SubEvent {
   /// \param list list where the input information should be found
   /// \return kTRUE if everything went OK
   virtual void AttachCorrectionInput(TList *list) = 0;
+  /// Asks for attaching the frozen correction parameters to the correction steps
+  ///
+  /// The request is transmitted to the different corrections.
+  /// Pure virtual function
+  /// \param parameters file containing the correction parameter tables
+  /// \param run name of the current run
+  virtual void AttachCorrectionInput(const CorrectionParameterFile &parameters, const std::string &run) = 0;
   /// Perform after calibration histograms attach actions
   /// It is used to inform the different correction step that
   /// all conditions for running the network are in place so
@@ -207,6 +226,24 @@ class SubEvent {
   /// approach so, the built Q vectors are the ones to be used for
   /// subsequent corrections.
   void BuildQnVector();
+  /// Builds the raw Qn vector before the input data corrections
+  ///
+  /// Only channelized configurations have a raw Qn vector.
+  virtual void BuildRawQnVector() {}
+  /// Fills the own QA histograms of the configuration
+  ///
+  /// Pure virtual function
+  virtual void FillQAHistograms() = 0;
+  /// Appends the input data correction steps in the order of application
+  ///
+  /// Only channelized configurations have input data corrections.
+  /// \param steps list where the correction steps are appended
+  virtual void FillInputCorrectionSteps(std::vector<CorrectionBase *> &steps) const { (void) steps; }
+  /// Appends the Qn vector correction steps in the order of application
+  /// \param steps list where the correction steps are appended
+  void FillQnVectorCorrectionSteps(std::vector<CorrectionBase *> &steps) const {
+    fQnVectorCorrections.FillCorrectionsList(steps);
+  }
 //  /// Include the list of associated Qn vectors into the passed list
 //  ///
 //  /// Pure virtual function
@@ -231,14 +268,10 @@ class SubEvent {
   virtual std::map<std::string, Report> ReportOnCorrections() const = 0;
 
   /**
-   * Adds a data vector to the sub event.
-   * @tparam Args type of the arguments of the CorrectionDataVector constructor.
-   * @param args arguments of the CorrectionDataVector constructor.
+   * Sets the data vectors of the current event.
+   * @param data_vectors range of the data vectors in the arena of the detector.
    */
-  template<typename... Args>
-  void AddDataVector(Args &&... args) {
-    fDataVectorBank.emplace_back(std::forward<Args>(args)...);
-  }
+  void SetDataVectors(CorrectionDataVectorRange data_vectors) { fDataVectorBank = data_vectors; }
   /// Clean the configuration to accept a new event
   /// Pure virtual function
   virtual void Clear() = 0;
@@ -274,7 +307,7 @@ class SubEvent {
  protected:
   unsigned int binid_;
   Detector *fDetector = nullptr;
-  std::vector<Qn::CorrectionDataVector> fDataVectorBank; //!<! input data for the current process / event
+  CorrectionDataVectorRange fDataVectorBank; //!<! input data for the current process / event
   QVector fPlainQnVector;      ///< Qn vector from the post processed input data
   QVector fPlainQ2nVector;     ///< Q2n vector from the post processed input data
   QVector fCorrectedQnVector;  ///< Qn vector after subsequent correction steps
@@ -287,7 +320,6 @@ class SubEvent {
   std::unique_ptr<CorrectionProfileComponents> fQAQnAverageHistogram; //!<! the plain average Qn components QA histogram
   static const char *szPlainQnVectorName; ///< the name of the Qn plain, not corrected Qn vectors
   static const char *szQAQnAverageHistogramName; ///< name and title for plain Qn vector average QA histograms
-  static constexpr unsigned int INITIALSIZE = 4; ///< The default initial size of data vectors banks
 
 /// \cond CLASSIMP
  ClassDef(SubEvent, 3);
@@ -81,13 +81,19 @@ class SubEventChannels : public SubEvent {
     fQAMultiplicityMax = max;
   }
 
-  void BuildRawQnVector();
+  virtual void BuildRawQnVector();
+  virtual void FillQAHistograms();
+  virtual void FillInputCorrectionSteps(std::vector<CorrectionBase *> &steps) const {
+    fInputDataCorrections.FillCorrectionsList(steps);
+  }
 
   virtual void CreateSupportQVectors();
   virtual void CreateCorrectionHistograms();
+  virtual void EnableFirstCorrection();
   virtual void CopyToOutputList(TList* list);
   virtual void AttachQAHistograms(TList *list);
   virtual void AttachNveQAHistograms(TList *list);
+  virtual void FillNveQAHistograms();
 
   /// Activate the processing for the passed harmonic
   /// \param harmonic the desired harmonic number to activate
@@ -96,6 +102,7 @@ class SubEventChannels : public SubEvent {
     fRawQnVector.ActivateHarmonic(harmonic);
   }
   virtual void AttachCorrectionInput(TList *list);
+  virtual void AttachCorrectionInput(const CorrectionParameterFile &parameters, const std::string &run);
   virtual void AfterInputAttachAction();
   virtual Bool_t ProcessCorrections();
   virtual Bool_t ProcessDataCollection();
@@ -127,7 +134,6 @@ class SubEventChannels : public SubEvent {
   CorrectionsSetOnInputData fInputDataCorrections; ///< set of corrections to apply on input data vectors
 
   /* QA section */
-  void FillQAHistograms();
   static const char *szQAMultiplicityHistoName; ///< QA multiplicity histograms name
   Int_t fQACentralityVarId = -1;   ///< the id of the variable used for centrality in QA histograms
   Int_t fQAnBinsMultiplicity = 100; ///< number of bins for multiplicity in QA histograms
@@ -0,0 +1,96 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_SUBEVENTSTORAGE_H
+#define FLOW_SUBEVENTSTORAGE_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "SubEvent.h"
+
+namespace Qn {
+/**
+ * @class SubEventStorage
+ * @brief Owns the sub-events of one detector in a single contiguous block.
+ * All sub-events of a detector have the same type. They are constructed in place in the order of the bins, so that
+ * the loops of the detector over its sub-events walk through one block of memory instead of one heap object per bin.
+ * The sub-events do not move after they are created. They are destroyed together with the storage.
+ */
+class SubEventStorage {
+ public:
+  SubEventStorage() = default;
+  ~SubEventStorage() { Clear(); }
+  SubEventStorage(const SubEventStorage &) = delete;
+  SubEventStorage &operator=(const SubEventStorage &) = delete;
+  SubEventStorage(SubEventStorage &&other) noexcept :
+      block_(std::exchange(other.block_, nullptr)),
+      sub_events_(std::move(other.sub_events_)) {}
+  SubEventStorage &operator=(SubEventStorage &&other) noexcept {
+    if (this!=&other) {
+      Clear();
+      block_ = std::exchange(other.block_, nullptr);
+      sub_events_ = std::move(other.sub_events_);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Creates the sub-events. Previously created sub-events are destroyed.
+   * @tparam T type of the sub-events
+   * @tparam Args types of the constructor arguments following the bin id
+   * @param n_bins number of sub-events
+   * @param args constructor arguments, which are the same for all bins.
+   */
+  template<typename T, typename... Args>
+  void Create(std::size_t n_bins, const Args &... args) {
+    Clear();
+    block_ = ::operator new(n_bins*sizeof(T));
+    sub_events_.reserve(n_bins);
+    try {
+      for (std::size_t ibin = 0; ibin < n_bins; ++ibin) {
+        auto address = static_cast<char *>(block_) + ibin*sizeof(T);
+        sub_events_.push_back(new(address) T(static_cast<unsigned int>(ibin), args...));
+      }
+    } catch (...) {
+      Clear();
+      throw;
+    }
+  }
+
+  /**
+   * @brief Destroys the sub-events and releases the block.
+   */
+  void Clear() noexcept {
+    for (auto sub_event : sub_events_) { sub_event->~SubEvent(); }
+    sub_events_.clear();
+    ::operator delete(block_);
+    block_ = nullptr;
+  }
+
+  SubEvent *operator[](std::size_t ibin) const { return sub_events_[ibin]; }
+  std::size_t size() const { return sub_events_.size(); }
+
+ private:
+  void *block_ = nullptr; ///< memory of all sub-events
+  std::vector<SubEvent *> sub_events_; ///< sub-events in the order of the bins
+};
+}
+
+#endif //FLOW_SUBEVENTSTORAGE_H
@@ -50,14 +50,18 @@ class SubEventTracks : public SubEvent {
 
   virtual void CreateSupportQVectors();
   virtual void CreateCorrectionHistograms();
+  virtual void EnableFirstCorrection();
   virtual void CopyToOutputList(TList* list);
   virtual void AttachQAHistograms(TList *list);
   virtual void AttachNveQAHistograms(TList *list);
+  virtual void FillNveQAHistograms();
   virtual void AttachCorrectionInput(TList *list);
+  virtual void AttachCorrectionInput(const CorrectionParameterFile &parameters, const std::string &run);
   virtual void AfterInputAttachAction();
 
   virtual Bool_t ProcessCorrections();
   virtual Bool_t ProcessDataCollection();
+  virtual void FillQAHistograms();
 
   virtual void IncludeQnVectors();
   virtual void FillOverallInputCorrectionStepList(std::set<CorrectionBase *> &set) const;
@@ -67,10 +71,6 @@ class SubEventTracks : public SubEvent {
     return fQnVectorCorrections.ReportOnUsage();
   }
   
- private:
-  /* QA section */
-  void FillQAHistograms();
-
 /// \cond CLASSIMP
  ClassDef(SubEventTracks, 2);
 /// \endcond
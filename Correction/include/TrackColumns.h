@@ -0,0 +1,96 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_TRACKCOLUMNS_H
+#define FLOW_TRACKCOLUMNS_H
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "InputVariableManager.h"
+
+namespace Qn {
+/**
+ * @class TrackColumns
+ * @brief Non-owning view of the track variables of one event.
+ * Each track variable is given as one contiguous array with one entry per track e.g. phi, weight, pT, rapidity.
+ * The arrays are copied in bulk into double columns of the variable manager, so that the cuts and QA histograms of
+ * the tracking detectors are evaluated once over all tracks.
+ * Created by CorrectionManager::CreateTrackColumns and passed to CorrectionManager::FillTrackingDetectors.
+ */
+class TrackColumns {
+ public:
+  /**
+   * @brief Strided access to the values of one variable for all tracks.
+   * Variables, which are not a track column, are constant for the event and are read with a stride of zero.
+   */
+  struct Column {
+    const double *values;
+    std::size_t stride;
+    double operator[](std::size_t i) const { return values[i*stride]; }
+  };
+
+  TrackColumns() = default;
+  explicit TrackColumns(std::vector<std::string> names) : names_(std::move(names)), columns_(names_.size(), nullptr) {}
+
+  /**
+   * @brief Sets the columns of the current event.
+   * @param n_tracks number of tracks of the event.
+   * @param columns arrays of the track values in the order of the variables. Each holds at least n_tracks entries.
+   */
+  void Set(std::size_t n_tracks, const std::vector<const double *> &columns) {
+    if (columns.size()!=names_.size()) {
+      throw std::invalid_argument("The number of columns must match the number of track variables.");
+    }
+    n_tracks_ = n_tracks;
+    columns_ = columns;
+  }
+
+  /**
+   * @brief Returns the values of a variable for all tracks.
+   * @param variable variable of the variable manager
+   * @return values of the variable if it is a track column, otherwise the event value with a stride of zero.
+   * The variables have to be of type double.
+   */
+  static Column Find(const InputVariable &variable) {
+    if (!variable.IsType<double>()) {
+      throw std::invalid_argument("Variable " + variable.GetName() + " needs to be of type double.");
+    }
+    return Column{variable.Data<double>(), variable.IsColumn() ? 1u : 0u};
+  }
+
+  /**
+   * @brief Copies the track arrays of the current event into the columns of the variable manager.
+   * @param variable_manager variable manager of the slot which processes the event.
+   */
+  void CopyTo(InputVariableManager &variable_manager) const {
+    for (std::size_t i = 0; i < names_.size(); ++i) {
+      variable_manager.SetValues(names_[i], columns_[i], n_tracks_);
+    }
+  }
+
+  std::size_t size() const { return n_tracks_; }
+
+ private:
+  std::vector<std::string> names_; ///< names of the columns of the variable manager
+  std::vector<const double *> columns_; ///< non-owning pointers to the columns of the current event
+  std::size_t n_tracks_ = 0; ///< number of tracks of the current event
+};
+}
+
+#endif //FLOW_TRACKCOLUMNS_H
@@ -83,6 +83,8 @@
 /* harmonic multiplier */
 
 #include "CorrectionOnQnVector.h"
+#include "CorrectionParameterTable.h"
+#include "CorrectionBatch.h"
 namespace Qn {
 /// \class QnCorrectionsQnVectorTwistAndRescale
 /// \brief Encapsulates twist and rescale on Q vector
@@ -178,12 +180,16 @@ class TwistAndRescale : public CorrectionOnQnVector {
   /// \param nNoOfEntries the number of entries threshold
   void SetNoOfEntriesThreshold(Int_t nNoOfEntries) { fMinNoOfEntriesToValidate = nNoOfEntries; }
   virtual void AttachInput(TList *list);
+  virtual void AttachInput(const CorrectionParameterFile &parameters, const std::string &run);
+  virtual const CorrectionParameterTable *GetCorrectionParameters() const { return &fParameters; }
   virtual void AfterInputAttachAction();
   virtual void CreateSupportQVectors();
   virtual void CreateCorrectionHistograms();
   virtual void AttachQAHistograms(TList *list);
   virtual void AttachNveQAHistograms(TList *list);
+  virtual void FillNveQAHistograms();
   virtual Bool_t ProcessCorrections();
+  virtual void ProcessCorrectionsBatch(CorrectionBase *const *steps, std::size_t n, char *applied);
   virtual Bool_t ProcessDataCollection();
   virtual void ClearCorrectionStep();
   virtual void IncludeCorrectedQnVector(std::map<QVector::CorrectionStep, QVector *> &qvectors) const;
@@ -197,6 +203,8 @@ class TwistAndRescale : public CorrectionOnQnVector {
   }
 
  private:
+  void FreezeInput();
+  void ApplyCorrection(const Double_t *parameters, Int_t harmonic, Double_t Qx, Double_t Qy);
   using State = Qn::CorrectionBase::State;
   static constexpr const unsigned int szPriority =
       CorrectionOnQnVector::Step::kTwistAndRescale; ///< the key of the correction step for ordering purpose
@@ -231,6 +239,10 @@ class TwistAndRescale : public CorrectionOnQnVector {
       fQATwistQnAverageHistogram; //!<! the after twist correction step average Qn components QA histogram
   std::unique_ptr<CorrectionProfileComponents>
       fQARescaleQnAverageHistogram; //!<! the after rescale correction step average Qn components QA histogram
+  CorrectionParameterTable fParameters; //!<! the correction parameters frozen from the calibration information
+  QnVectorBatch fBatch; //!<! rows of all sub-events of the detector corrected in one batch
+  std::vector<Double_t> fRescaledX; //!<! rescaled x components of the rows of the batch
+  std::vector<Double_t> fRescaledY; //!<! rescaled y components of the rows of the batch
 
   Method fTwistAndRescaleMethod;  ///< the chosen method for extracting twist and rescale correction parameters
   Bool_t fApplyTwist;              ///< apply the twist step
@@ -18,6 +18,7 @@
 #define FLOW_DATAFRAMECORRELATION_H
 
 #include <functional>
+#include <map>
 #include <cstring>
 #include <type_traits>
 
@@ -31,6 +32,13 @@
 
 namespace Qn {
 namespace Correlation {
+namespace Details {
+/**
+ * Returns the address of the Q-vectors of an input column, which holds either the Q-vectors or a pointer to them.
+ */
+inline const DataContainerQVector *AddressOf(const DataContainerQVector &q_vectors) { return &q_vectors; }
+inline const DataContainerQVector *AddressOf(const DataContainerQVector *q_vectors) { return q_vectors; }
+}
 
 template<typename Function, typename Qvectors, typename InputDataContainers>
 class Correlation;
@@ -51,6 +59,7 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
       input_data.emplace_back(reader, name.data());
     }
     reader.SetLocalEntry(1);
+    std::vector<const DataContainerQVector *> prototypes;
     for (std::size_t i = 0; i < input_data.size(); ++i) {
       auto &i_data = input_data[i];
       if (i_data.GetSetupStatus() < 0) {
@@ -58,14 +67,28 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
             i_data.GetBranchName() + "in the tree is not valid. Cannot setup the correlation";
         throw std::runtime_error(message);
       }
-      if (!i_data->IsIntegrated()) {
-        AddAxes(input_data, i);
-      }
+      prototypes.push_back(i_data.Get());
     }
-    correlation_result_.resize(data_container_correlation_.size());
+    InitializeAxes(prototypes);
     reader.Restart();
   }
 
+  /**
+   * @brief Initializes the correlation using Q-vectors kept in memory e.g. by the correction step.
+   * @param q_vectors map of the available Q-vectors. Names correspond to the input names.
+   */
+  void Initialize(const std::map<std::string, const DataContainerQVector *> &q_vectors) {
+    std::vector<const DataContainerQVector *> prototypes;
+    for (const auto &name : input_names_) {
+      auto q_vector = q_vectors.find(name);
+      if (q_vector==q_vectors.end()) {
+        throw std::runtime_error("The Q-Vector " + name + " is not available. Cannot setup the correlation");
+      }
+      prototypes.push_back(q_vector->second);
+    }
+    InitializeAxes(prototypes);
+  }
+
   template<typename ...Names>
   void SetInputNames(Names ...names) {
     static_assert(sizeof...(names)==NInputs,
@@ -87,11 +110,11 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
     return std::any_of(std::begin(use_weights_), std::end(use_weights_),[](bool a){return a;});
   }
 
-  const CollelationHolder &Correlate(InputDataContainers... input) {
+  const CollelationHolder &Correlate(const InputDataContainers &... input) {
     for (auto &bin : correlation_result_) { bin.validity = false; }
     std::size_t output_bin = 0;
     std::array<const Qn::QVector *, NInputs> q_vectors;
-    std::array<DataContainerQVector, NInputs> input_array = {input...};
+    std::array<const DataContainerQVector *, NInputs> input_array = {Details::AddressOf(input)...};
     IterateOverBins(output_bin, q_vectors, input_array, 0);
     return correlation_result_;
   }
@@ -107,6 +130,19 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
 
  private:
 
+  /**
+   * @brief Adds the axes of the input Q-vectors to the correlation.
+   * @param input_data prototypes of the input Q-vectors in the order of the input names.
+   */
+  void InitializeAxes(const std::vector<const DataContainerQVector *> &input_data) {
+    for (std::size_t i = 0; i < input_data.size(); ++i) {
+      if (!input_data[i]->IsIntegrated()) {
+        AddAxes(input_data, i);
+      }
+    }
+    correlation_result_.resize(data_container_correlation_.size());
+  }
+
   double CalculateWeights(const std::array<const Qn::QVector *, NInputs> &q_array) const {
     int i = 0;
     double weight = 1.0;
@@ -119,12 +155,12 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
 
   void IterateOverBins(std::size_t &output_bin,
                        std::array<const Qn::QVector *, NInputs> &q_array,
-                       const std::array<DataContainerQVector, NInputs> &input_array,
+                       const std::array<const DataContainerQVector *, NInputs> &input_array,
                        std::size_t iteration) {
     // ends recursive iteration over the data inputs
     if (iteration + 1==NInputs) {
       // iterates over all bins of the input data
-      for (const auto &bin : input_array[iteration]) {
+      for (const auto &bin : *input_array[iteration]) {
         // skips empty bins
         if (bin.n() < 1) {
           ++output_bin;
@@ -145,7 +181,7 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
     }
     // starts the recursion over the input data.
     // iterates over all bins of the input data.
-    for (const auto &bin : input_array[iteration]) {
+    for (const auto &bin : *input_array[iteration]) {
       // skips empty bins
       if (bin.n() < 1) {
         ++output_bin;
@@ -158,7 +194,7 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
     }
   }
 
-  void AddAxes(std::vector<TTreeReaderValue<DataContainerQVector>> &data_containers, std::size_t i) {
+  void AddAxes(const std::vector<const DataContainerQVector *> &data_containers, std::size_t i) {
     for (auto axis :data_containers[i]->GetAxes()) {
       // default name of the axis.
       std::string name = axis.Name();
@@ -170,13 +206,13 @@ class Correlation<Function, std::tuple<Qvectors...>, std::tuple<InputDataContain
           if (!other->IsIntegrated()) {
             for (const auto &other_axis :other->GetAxes()) {
               if (axis==other_axis) {
-                auto input_name = data_containers[i].GetBranchName();
-                if (std::strcmp(input_name, other.GetBranchName())==0) {
+                const auto &input_name = input_names_[i];
+                if (input_name==input_names_[j]) {
                   // Prepends the input position and name to the axis name if another identical input is present.
                   name = std::to_string(i) + "_" + input_name + "_" + axis.Name();
                 } else {
                   // Prepends the input name to the axis name if another input with an identical axis name is present.
-                  name = std::string(input_name) + "_" + axis.Name();
+                  name = input_name + "_" + axis.Name();
                 }
               }
             }
@@ -104,8 +104,16 @@ class CorrelationHelper<State,
     return {std::move(*this)};
   }
 
-  void Configure(TTreeReader &reader, const std::size_t n_resamples) {
-    correlation_.Initialize(reader);
+  /**
+   * @brief Configures the output of the correlation.
+   * @tparam INPUT type of the input description.
+   * @param input Either a TTreeReader of the tree of Q-vectors or a map of the Q-vectors kept in memory
+   * (e.g. CorrectionManager::GetOutputQVectors()).
+   * @param n_resamples number of resamples
+   */
+  template<typename INPUT>
+  void Configure(INPUT &&input, const std::size_t n_resamples) {
+    correlation_.Initialize(input);
     auto correlation_axes = correlation_.GetCorrelationAxes();
     auto event_axes = event_axes_config_.GetVector();
     // Initialize output data containers
@@ -127,10 +135,20 @@ class CorrelationHelper<State,
     stride_ = temp_correlation.size();
   }
 
-  template<typename DATAFRAME>
-  ROOT::RDF::RResultPtr<Result_t> BookMe(DATAFRAME &df, TTreeReader &reader, const std::size_t n_resamples) {
+  /**
+   * @brief Books the correlation on the data frame.
+   * @tparam DATAFRAME type of the data frame
+   * @tparam INPUT type of the input description.
+   * @param df data frame containing the Q-vectors as columns.
+   * @param input Either a TTreeReader of the tree of Q-vectors or a map of the Q-vectors kept in memory.
+   * The latter allows to correlate the Q-vectors defined by the CorrectionHelper in the same event loop.
+   * @param n_resamples number of resamples
+   * @return Result pointer to the correlation.
+   */
+  template<typename DATAFRAME, typename INPUT>
+  ROOT::RDF::RResultPtr<Result_t> BookMe(DATAFRAME &df, INPUT &&input, const std::size_t n_resamples) {
     static_assert(State==ConfigurationState::Weight, "Configure weights first");
-    Configure(reader, n_resamples);
+    Configure(std::forward<INPUT>(input), n_resamples);
     std::vector<std::string> columns;
     columns.emplace_back("Samples");
     auto input_names = correlation_.GetInputNames();
@@ -146,7 +164,7 @@ class CorrelationHelper<State,
 
   void Exec(unsigned int slot,
             const ROOT::RVec<ULong64_t> sample_ids,
-            DataContainers... data_containers,
+            const DataContainers &... data_containers,
             EventParameters... coordinates) {
     const auto &per_event_correlation = correlation_.Correlate(data_containers...);
     auto event_bin = event_axes_config_.GetLinearIndexFromCoordinates(coordinates...);
@@ -185,18 +203,26 @@ class CorrelationHelper<State,
   }
 };
 
-template<typename F, typename AxisConfig>
+/**
+ * @brief Creates a correlation of Q-vectors.
+ * @tparam Input type of the Q-vector columns. Either Qn::DataContainerQVector or const Qn::DataContainerQVector *
+ * for the columns defined by CorrectionHelper::DefineQVectors.
+ * @param name name of the correlation
+ * @param function correlation function taking one Qn::QVector per input
+ * @param event_axes event axes of the correlation
+ * @return helper to configure and book the correlation.
+ */
+template<typename Input = Qn::DataContainerQVector, typename F, typename AxisConfig>
 CorrelationHelper<ConfigurationState::Start,
                   AxisConfig,
                   Correlation<F, TemplateHelpers::TupleOf<TemplateHelpers::FunctionTraits<F>::Arity, Qn::QVector>,
-                              TemplateHelpers::TupleOf<TemplateHelpers::FunctionTraits<F>::Arity,
-                                                       Qn::DataContainerQVector>>,
+                              TemplateHelpers::TupleOf<TemplateHelpers::FunctionTraits<F>::Arity, Input>>,
                   typename AxisConfig::AxisValueTypeTuple,
-                  TemplateHelpers::TupleOf<TemplateHelpers::FunctionTraits<F>::Arity, Qn::DataContainerQVector>>
+                  TemplateHelpers::TupleOf<TemplateHelpers::FunctionTraits<F>::Arity, Input>>
 MakeCorrelation(const std::string &name, F function, AxisConfig event_axes) {
   auto constexpr n_parameters = TemplateHelpers::FunctionTraits<decltype(function)>::Arity;
   using QVectorTuple = TemplateHelpers::TupleOf<n_parameters, Qn::QVector>;
-  using DataContainerTuple = TemplateHelpers::TupleOf<n_parameters, Qn::DataContainerQVector>;
+  using DataContainerTuple = TemplateHelpers::TupleOf<n_parameters, Input>;
   auto correlation = Correlation<F, QVectorTuple, DataContainerTuple>(function);
   using EventParameterTuple = typename AxisConfig::AxisValueTypeTuple;
   using CorrelationType = decltype(correlation);
@@ -0,0 +1,124 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FLOW_FLATQVECTORSREADER_H
+#define FLOW_FLATQVECTORSREADER_H
+
+#include <array>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RVec.hxx"
+
+#include "DataContainer.h"
+#include "FlatQVectors.h"
+
+namespace Qn {
+namespace Correlation {
+namespace Details {
+template<std::size_t, typename T>
+using Repeat = T;
+
+template<typename Sequence, typename FloatArray, typename IntArray>
+class FlatQVectorsReader;
+
+/**
+ * Reconstructs a DataContainerQVector from the arrays of the flat layout.
+ * The data frame passes the arrays by reference. The returned container is a copy of the prototype, which is filled
+ * with the values of the event.
+ * @tparam I index sequence of the component arrays (x and y of each harmonic).
+ * @tparam FloatArray type of the float array columns e.g. ROOT::RVec<float> for trees.
+ * @tparam IntArray type of the integer array column.
+ */
+template<std::size_t... I, typename FloatArray, typename IntArray>
+class FlatQVectorsReader<std::index_sequence<I...>, FloatArray, IntArray> {
+ public:
+  FlatQVectorsReader(const DataContainerQVector &prototype, std::vector<unsigned int> harmonics) :
+      prototype_(prototype), harmonics_(std::move(harmonics)) {}
+
+  DataContainerQVector operator()(const FloatArray &sum_weights,
+                                  const IntArray &n,
+                                  const Repeat<I, FloatArray> &... components) const {
+    std::array<const FloatArray *, sizeof...(I)> component_array{{&components...}};
+    auto q_vectors = prototype_;
+    for (std::size_t ibin = 0; ibin < q_vectors.size(); ++ibin) {
+      auto &q_vector = q_vectors[ibin];
+      q_vector.SetNumberOfContributors(n[ibin], sum_weights[ibin]);
+      for (std::size_t ih = 0; ih < harmonics_.size(); ++ih) {
+        q_vector.SetX(harmonics_[ih], (*component_array[2*ih])[ibin]);
+        q_vector.SetY(harmonics_[ih], (*component_array[2*ih + 1])[ibin]);
+      }
+    }
+    return q_vectors;
+  }
+
+ private:
+  DataContainerQVector prototype_; /// container providing axes, harmonics and normalization
+  std::vector<unsigned int> harmonics_; /// activated harmonics
+};
+
+/**
+ * Defines the column using a reader with the matching number of harmonics.
+ * @tparam FloatArray type of the float array columns.
+ * @tparam IntArray type of the integer array column.
+ * @tparam NHarmonics number of harmonics tried in this step of the recursion.
+ */
+template<typename FloatArray, typename IntArray, std::size_t NHarmonics = 1>
+ROOT::RDF::RNode DefineFlatQVector(ROOT::RDF::RNode df,
+                                   const std::string &name,
+                                   const DataContainerQVector &prototype,
+                                   const std::vector<unsigned int> &harmonics) {
+  if constexpr (NHarmonics > QVector::kmaxharmonics) {
+    throw std::out_of_range("Q-vector " + name + " has more harmonics than supported.");
+  } else {
+    if (harmonics.size()==NHarmonics) {
+      using Reader = FlatQVectorsReader<std::make_index_sequence<2*NHarmonics>, FloatArray, IntArray>;
+      return df.Define(name, Reader(prototype, harmonics), FlatQVectors::GetBranchNames(name, prototype));
+    }
+    return DefineFlatQVector<FloatArray, IntArray, NHarmonics + 1>(df, name, prototype, harmonics);
+  }
+}
+}
+
+/**
+ * @brief Defines the Q-vectors saved in the flat layout as DataContainerQVector columns.
+ * The columns have the same names as the branches of the object layout. Afterwards the correlations are booked with
+ * CorrelationHelper::BookMe(df, prototypes, n_samples).
+ * For an RNTuple written by CorrectionManager::ConnectOutputNTuple the arrays are read as std::vectors:
+ * DefineFlatQVectors<std::vector<float>, std::vector<Int_t>>(df, prototypes) with the prototypes read from the TMap
+ * "<ntuple name>_QVectorPrototypes" in the file.
+ * @tparam FloatArray type of the float array columns.
+ * @tparam IntArray type of the integer array column.
+ * @param df data frame reading the tree or RNTuple with the flat layout.
+ * @param prototypes prototypes of the Q-vectors as returned by FlatQVectors::ReadPrototypes.
+ * @return data frame containing the Q-vector columns.
+ */
+template<typename FloatArray = ROOT::RVec<float>, typename IntArray = ROOT::RVec<Int_t>>
+ROOT::RDF::RNode DefineFlatQVectors(ROOT::RDF::RNode df,
+                                    const std::map<std::string, const DataContainerQVector *> &prototypes) {
+  for (const auto &prototype : prototypes) {
+    auto harmonics = FlatQVectors::GetHarmonics(*prototype.second);
+    df = Details::DefineFlatQVector<FloatArray, IntArray>(df, prototype.first, *prototype.second, harmonics);
+  }
+  return df;
+}
+}
+}
+#endif //FLOW_FLATQVECTORSREADER_H
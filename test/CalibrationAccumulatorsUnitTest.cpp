@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <THn.h>
+#include <TList.h>
+
+#include "CalibrationAccumulators.h"
+
+namespace {
+/**
+ * Fills the calibration histograms of one run with the events [first, last).
+ * The weights are exactly representable, so that the sums do not depend on the order of the additions.
+ */
+std::unique_ptr<TList> FillCalibration(int first, int last) {
+  int n_bins[2] = {5, 4};
+  double minimum[2] = {0., -1.};
+  double maximum[2] = {5., 1.};
+  auto recentering = new THnF("rec", "recentering", 2, n_bins, minimum, maximum);
+  recentering->Sumw2();
+  auto entries = new THnF("rec_entries", "entries", 2, n_bins, minimum, maximum);
+  for (int event = first; event < last; ++event) {
+    std::mt19937 generator(event);
+    std::uniform_real_distribution<double> distribution(-0.5, 5.5);
+    std::uniform_int_distribution<int> weight(-8, 8);
+    double values[2] = {distribution(generator), distribution(generator)/5. - 0.1};
+    recentering->Fill(values, weight(generator)*0.25);
+    entries->Fill(values);
+  }
+  auto sub_event = new TList();
+  sub_event->SetName("FMD");
+  sub_event->SetOwner(true);
+  sub_event->Add(recentering);
+  sub_event->Add(entries);
+  auto run = new TList();
+  run->SetName("run1");
+  run->SetOwner(true);
+  run->Add(sub_event);
+  auto list = std::make_unique<TList>();
+  list->SetOwner(true);
+  list->Add(run);
+  return list;
+}
+
+THn *Find(const TList *list, const char *histogram) {
+  auto run = dynamic_cast<TList *>(list->FindObject("run1"));
+  if (!run) return nullptr;
+  auto sub_event = dynamic_cast<TList *>(run->FindObject("FMD"));
+  if (!sub_event) return nullptr;
+  return dynamic_cast<THn *>(sub_event->FindObject(histogram));
+}
+
+void ExpectEqualLists(const TList *expected, const TList *merged) {
+  for (auto name : {"rec", "rec_entries"}) {
+    auto a = Find(expected, name);
+    auto b = Find(merged, name);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_EQ(a->GetNbins(), b->GetNbins());
+    EXPECT_EQ(a->GetCalculateErrors(), b->GetCalculateErrors());
+    EXPECT_DOUBLE_EQ(a->GetEntries(), b->GetEntries());
+    for (Long64_t bin = 0; bin < a->GetNbins(); ++bin) {
+      EXPECT_DOUBLE_EQ(a->GetBinContent(bin), b->GetBinContent(bin));
+      EXPECT_DOUBLE_EQ(a->GetBinError2(bin), b->GetBinError2(bin));
+    }
+  }
+}
+}
+
+TEST(CalibrationAccumulatorsTest, MergeEqualsSinglePass) {
+  auto all = FillCalibration(0, 1000);
+  Qn::CalibrationAccumulators first;
+  first.Add(FillCalibration(0, 400).get());
+  Qn::CalibrationAccumulators second;
+  second.Add(FillCalibration(400, 1000).get());
+  first.Add(std::move(second));
+  EXPECT_EQ(first.size(), 2u);
+  auto merged = first.CreateList();
+  ExpectEqualLists(all.get(), merged.get());
+}
+
+TEST(CalibrationAccumulatorsTest, MergeIsOrderIndependent) {
+  const std::vector<std::string> names = {"accumulators_a.qn", "accumulators_b.qn", "accumulators_c.qn"};
+  const int events[4] = {0, 300, 450, 1000};
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    Qn::CalibrationAccumulators accumulators;
+    accumulators.Add(FillCalibration(events[i], events[i + 1]).get());
+    accumulators.Write(names[i]);
+  }
+  auto all = FillCalibration(0, 1000);
+  auto forward = Qn::CalibrationAccumulators::Merge(names, 1).CreateList();
+  ExpectEqualLists(all.get(), forward.get());
+  auto backward = Qn::CalibrationAccumulators::Merge({names[2], names[0], names[1]}, 2).CreateList();
+  ExpectEqualLists(all.get(), backward.get());
+  auto threads = Qn::CalibrationAccumulators::Merge(names, 0).CreateList();
+  ExpectEqualLists(all.get(), threads.get());
+  for (const auto &name : names) std::remove(name.data());
+}
+
+TEST(CalibrationAccumulatorsTest, RejectsDifferentBinning) {
+  Qn::CalibrationAccumulators accumulators;
+  accumulators.Add(FillCalibration(0, 10).get());
+  int n_bins[2] = {6, 4};
+  double minimum[2] = {0., -1.};
+  double maximum[2] = {5., 1.};
+  TList run;
+  run.SetName("run1");
+  run.SetOwner(true);
+  auto sub_event = new TList();
+  sub_event->SetName("FMD");
+  sub_event->SetOwner(true);
+  sub_event->Add(new THnF("rec_entries", "entries", 2, n_bins, minimum, maximum));
+  run.Add(sub_event);
+  TList list;
+  list.Add(&run);
+  EXPECT_THROW(accumulators.Add(&list), std::runtime_error);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <TFile.h>
+#include <TH1.h>
+#include <TList.h>
+#include <TROOT.h>
+
+#include "CalibrationInput.h"
+
+namespace {
+/**
+ * Writes three runs in the indexed layout. Each run holds one histogram whose content is the number of the run.
+ */
+void WriteRuns(const std::string &file_name) {
+  TList corrections;
+  corrections.SetOwner(true);
+  for (int run = 1; run <= 3; ++run) {
+    auto list = new TList();
+    list->SetName(("run" + std::to_string(run)).data());
+    list->SetOwner(true);
+    auto histogram = new TH1F("FMD_rec", "", 4, 0., 4.);
+    histogram->SetDirectory(nullptr);
+    histogram->SetBinContent(1, run);
+    list->Add(histogram);
+    corrections.Add(list);
+  }
+  TFile file(file_name.data(), "RECREATE");
+  Qn::CalibrationInput::Write(&corrections, &file, "CorrectionHistograms");
+  file.Close();
+}
+
+double Content(TList *list) {
+  if (!list) return -1.;
+  auto histogram = dynamic_cast<TH1 *>(list->FindObject("FMD_rec"));
+  return histogram ? histogram->GetBinContent(1) : -1.;
+}
+}
+
+TEST(CalibrationInputTest, ReadsRunsOnRequest) {
+  const std::string file_name = "calibrationinput_test.root";
+  WriteRuns(file_name);
+  ROOT::EnableThreadSafety();
+  Qn::CalibrationInput input;
+  input.Open(std::unique_ptr<TFile>(TFile::Open(file_name.data(), "READ")), "CorrectionHistograms");
+  EXPECT_EQ(input.GetRunNames(), (std::vector<std::string>{"run1", "run2", "run3"}));
+  EXPECT_DOUBLE_EQ(Content(input.Get("run1")), 1.);
+  input.Prefetch("run2");
+  EXPECT_DOUBLE_EQ(Content(input.Get("run2")), 2.);
+  input.Prefetch("run3");
+  EXPECT_DOUBLE_EQ(Content(input.Get("run3")), 3.);
+  // a released run is read again.
+  EXPECT_DOUBLE_EQ(Content(input.Get("run1")), 1.);
+  EXPECT_EQ(input.Get("run4"), nullptr);
+  std::remove(file_name.data());
+}
+
+TEST(CalibrationInputTest, KeepsPrefetchedRunsUntilTheyAreRequested) {
+  const std::string file_name = "calibrationinput_prefetch_test.root";
+  WriteRuns(file_name);
+  ROOT::EnableThreadSafety();
+  Qn::CalibrationInput input;
+  auto file = TFile::Open(file_name.data(), "READ");
+  input.Open(std::unique_ptr<TFile>(file), "CorrectionHistograms");
+  EXPECT_DOUBLE_EQ(Content(input.Get("run1")), 1.);
+  // the second request replaces the first one, which is kept in memory.
+  input.Prefetch("run2");
+  input.Prefetch("run3");
+  EXPECT_DOUBLE_EQ(Content(input.Get("run3")), 3.);
+  // run2 was read in the background, so it is returned without reading the file again.
+  const auto read_calls = file->GetReadCalls();
+  EXPECT_DOUBLE_EQ(Content(input.Get("run2")), 2.);
+  EXPECT_EQ(file->GetReadCalls(), read_calls);
+  // the released run1 is read again.
+  EXPECT_DOUBLE_EQ(Content(input.Get("run1")), 1.);
+  EXPECT_GT(file->GetReadCalls(), read_calls);
+  std::remove(file_name.data());
+}
+
+TEST(CalibrationInputTest, MissingFileHasNoRuns) {
+  Qn::CalibrationInput input;
+  input.Open(nullptr, "CorrectionHistograms");
+  EXPECT_TRUE(input.GetRunNames().empty());
+  EXPECT_EQ(input.Get("run1"), nullptr);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "CorrectionBatch.h"
+
+TEST(CorrectionBatchTest, GatherRows) {
+  Qn::QnVectorBatch batch;
+  const Double_t first[4] = {1., 2., 3., 4.};
+  const Double_t second[4] = {5., 6., 7., 8.};
+  batch.Reset(4);
+  batch.Add(0, 1, 0.5, -0.5, first);
+  batch.Add(3, 2, 1.5, -1.5, second);
+  ASSERT_EQ(2u, batch.size());
+  EXPECT_EQ(3u, batch.Owner(1));
+  EXPECT_EQ(2, batch.Harmonic(1));
+  EXPECT_DOUBLE_EQ(1.5, batch.X()[1]);
+  EXPECT_DOUBLE_EQ(-1.5, batch.Y()[1]);
+  EXPECT_DOUBLE_EQ(5., batch.Parameters(1)[0]);
+  EXPECT_DOUBLE_EQ(4., batch.Parameters()[3]);
+  batch.Reset(3);
+  EXPECT_EQ(0u, batch.size());
+}
+
+TEST(CorrectionBatchTest, RecenterMatchesScalar) {
+  const std::vector<Double_t> parameters = {1., -0.1, 1., 0.2, 2., 0.5, 0.5, -0.3};
+  std::vector<double> x = {0.3, -0.7};
+  std::vector<double> y = {-0.4, 0.9};
+  const auto x0 = x;
+  const auto y0 = y;
+  Qn::CorrectionKernels::Recenter(x.size(), parameters.data(), x.data(), y.data());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    const auto p = &parameters[4*i];
+    EXPECT_DOUBLE_EQ(p[0]*x0[i] + p[1], x[i]);
+    EXPECT_DOUBLE_EQ(p[2]*y0[i] + p[3], y[i]);
+  }
+}
+
+TEST(CorrectionBatchTest, AlignRotates) {
+  const Double_t angle = 0.3;
+  const std::vector<Double_t> parameters = {std::cos(angle), std::sin(angle), 1.};
+  std::vector<double> x = {std::cos(0.5)};
+  std::vector<double> y = {std::sin(0.5)};
+  Qn::CorrectionKernels::Align(1, parameters.data(), x.data(), y.data());
+  EXPECT_NEAR(std::cos(0.2), x[0], 1e-6);
+  EXPECT_NEAR(std::sin(0.2), y[0], 1e-6);
+}
+
+TEST(CorrectionBatchTest, TwistAndRescaleMatchesScalar) {
+  const std::vector<Double_t> parameters = {0.1, -0.2, 1.05, 0.8, 1.25, 2.,
+                                            0.3, 0.05, 0.9, 1.1, 0.7, 1.};
+  std::vector<double> x = {0.3, -0.7};
+  std::vector<double> y = {-0.4, 0.9};
+  const auto x0 = x;
+  const auto y0 = y;
+  std::vector<double> rescaled_x(2), rescaled_y(2);
+  Qn::CorrectionKernels::TwistAndRescale(x.size(), parameters.data(), x.data(), y.data(),
+                                         rescaled_x.data(), rescaled_y.data());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    const auto p = &parameters[6*i];
+    const double twisted_x = (x0[i] - p[1]*y0[i])*p[2];
+    const double twisted_y = (y0[i] - p[0]*x0[i])*p[2];
+    EXPECT_DOUBLE_EQ(twisted_x, x[i]);
+    EXPECT_DOUBLE_EQ(twisted_y, y[i]);
+    EXPECT_DOUBLE_EQ(twisted_x*p[3], rescaled_x[i]);
+    EXPECT_DOUBLE_EQ(twisted_y*p[4], rescaled_y[i]);
+  }
+}
+
+TEST(CorrectionBatchTest, EqualizeUsesChannelTable) {
+  const std::vector<int> ids = {2, 0, 2};
+  const std::vector<Double_t> factors = {2., 0., 0.5};
+  const std::vector<Double_t> offsets = {1., 0., -1.};
+  std::vector<float> weights = {4., 3., 8.};
+  Qn::CorrectionKernels::Equalize(ids.size(), ids.data(), factors.data(), offsets.data(), weights.data());
+  EXPECT_FLOAT_EQ(1., weights[0]);
+  EXPECT_FLOAT_EQ(7., weights[1]);
+  EXPECT_FLOAT_EQ(3., weights[2]);
+}
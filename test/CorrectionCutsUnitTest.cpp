@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <TH1.h>
+#include <TH2.h>
+#include <TList.h>
+
+#include "CorrectionCuts.h"
+#include "InputVariableManager.h"
+
+namespace {
+constexpr int kChannels = 150;
+
+/**
+ * Sets up a variable x with values 0..kChannels-1 and a variable y alternating between 0 and 1.
+ */
+void Configure(Qn::InputVariableManager &manager) {
+  manager.CreateVariable("x", 0, kChannels);
+  manager.CreateVariable("y", kChannels, kChannels);
+  manager.Initialize();
+  auto values = manager.GetVariableContainer();
+  for (int i = 0; i < kChannels; ++i) {
+    values[i] = i;
+    values[kChannels + i] = i%2;
+  }
+}
+
+Qn::CorrectionCuts MakeCuts() {
+  Qn::CorrectionCuts cuts;
+  cuts.AddCut(Qn::CallBacks::MakeCut({"x"}, [](const double &x) { return x < 70. || x >= 130.; }, "x"));
+  cuts.AddCut(Qn::CallBacks::MakeCut({"y"}, [](const double &y) { return y < 0.5; }, "y"));
+  return cuts;
+}
+}
+
+TEST(CorrectionCutsTest, EvaluateMatchesSingleChannelCheck) {
+  Qn::InputVariableManager manager;
+  Configure(manager);
+  auto bulk = MakeCuts();
+  auto single = MakeCuts();
+  bulk.Initialize(manager);
+  single.Initialize(manager);
+  std::vector<unsigned int> expected;
+  for (int i = 0; i < kChannels; ++i) {
+    if (single.CheckCuts(i)) expected.push_back(i);
+  }
+  const auto &selected = bulk.Evaluate(kChannels);
+  EXPECT_EQ(expected, selected);
+  EXPECT_EQ(45u, selected.size());
+  EXPECT_EQ(130u, selected[35]);
+}
+
+TEST(CorrectionCutsTest, SelectionWords) {
+  Qn::InputVariableManager manager;
+  Configure(manager);
+  auto cuts = MakeCuts();
+  cuts.Initialize(manager);
+  std::vector<std::uint64_t> selection;
+  cuts.CheckCuts(kChannels, selection);
+  ASSERT_EQ(3u, selection.size());
+  const std::uint64_t even = 0x5555555555555555ull;
+  EXPECT_EQ(even, selection[0]);
+  EXPECT_EQ(even & ((std::uint64_t{1} << 6) - 1), selection[1]);
+  EXPECT_EQ(even & ~((std::uint64_t{1} << 2) - 1) & ((std::uint64_t{1} << 22) - 1), selection[2]);
+  Qn::CorrectionCuts no_cuts;
+  no_cuts.CheckCuts(kChannels, selection);
+  ASSERT_EQ(3u, selection.size());
+  EXPECT_EQ(~std::uint64_t{0}, selection[1]);
+  EXPECT_EQ((std::uint64_t{1} << 22) - 1, selection[2]);
+  EXPECT_EQ(kChannels, static_cast<int>(no_cuts.Evaluate(kChannels).size()));
+}
+
+TEST(CorrectionCutsTest, ReportCountsEqualSingleChannelCheck) {
+  Qn::InputVariableManager manager;
+  Configure(manager);
+  auto bulk = MakeCuts();
+  auto single = MakeCuts();
+  bulk.Initialize(manager);
+  single.Initialize(manager);
+  bulk.CreateCutReport("bulk", kChannels);
+  single.CreateCutReport("single", kChannels);
+  TList list;
+  list.SetOwner(true);
+  bulk.AddToList(&list);
+  single.AddToList(&list);
+  for (int event = 0; event < 3; ++event) {
+    bulk.Evaluate(kChannels);
+    for (int i = 0; i < kChannels; ++i) single.CheckCuts(i);
+  }
+  bulk.FlushReport();
+  single.FlushReport();
+  auto bulk_report = dynamic_cast<TH2D *>(list.FindObject("bulkCut_Report"));
+  auto single_report = dynamic_cast<TH2D *>(list.FindObject("singleCut_Report"));
+  ASSERT_NE(nullptr, bulk_report);
+  ASSERT_NE(nullptr, single_report);
+  for (int bin = 0; bin < bulk_report->GetNcells(); ++bin) {
+    EXPECT_EQ(single_report->GetBinContent(bin), bulk_report->GetBinContent(bin));
+  }
+  EXPECT_EQ(3., bulk_report->GetBinContent(1, 100));
+  EXPECT_EQ(0., bulk_report->GetBinContent(2, 100));
+  EXPECT_EQ(3., bulk_report->GetBinContent(3, 131));
+  EXPECT_EQ(0., bulk_report->GetBinContent(3, 132));
+}
+
+TEST(CorrectionCutsTest, TrackReportCountsTheSelectedEntries) {
+  Qn::InputVariableManager manager;
+  Configure(manager);
+  auto cuts = MakeCuts();
+  cuts.Initialize(manager);
+  cuts.CreateCutReport("tracks");
+  TList list;
+  list.SetOwner(true);
+  cuts.AddToList(&list);
+  auto report = dynamic_cast<TH1D *>(list.FindObject("tracksCut_Report"));
+  ASSERT_NE(nullptr, report);
+  std::vector<std::uint64_t> selection;
+  for (int event = 0; event < 2; ++event) cuts.CheckCuts(kChannels, selection);
+  EXPECT_EQ(0., report->GetEntries());
+  // flushing twice must not add the counters again.
+  cuts.FlushReport();
+  cuts.FlushReport();
+  EXPECT_EQ(2.*kChannels, report->GetBinContent(1));
+  EXPECT_EQ(2.*90, report->GetBinContent(2));
+  EXPECT_EQ(2.*45, report->GetBinContent(3));
+  EXPECT_EQ(2.*(kChannels + 90 + 45), report->GetEntries());
+  EXPECT_STREQ("all", report->GetXaxis()->GetBinLabel(1));
+  EXPECT_STREQ("x", report->GetXaxis()->GetBinLabel(2));
+  cuts.CheckCuts(kChannels, selection);
+  cuts.FlushReport();
+  EXPECT_EQ(3.*kChannels, report->GetBinContent(1));
+  EXPECT_EQ(3.*45, report->GetBinContent(3));
+}
+
+TEST(CorrectionCutsTest, CheckAllOfTypedColumnsMatchesTheirValues) {
+  Qn::InputVariableManager manager;
+  manager.CreateColumn<float>("pt", 2*kChannels);
+  manager.CreateColumn<int>("charge", 2*kChannels);
+  manager.CreateVariable("centrality", 1);
+  manager.Initialize();
+  std::vector<float> pt(kChannels);
+  std::vector<int> charge(kChannels);
+  for (int i = 0; i < kChannels; ++i) {
+    pt[i] = 0.02f*i;
+    charge[i] = i%3 - 1;
+  }
+  manager.SetValues("pt", pt.data(), pt.size());
+  manager.SetValues("charge", charge.data(), charge.size());
+  Qn::CorrectionCuts cuts;
+  cuts.AddCut(Qn::CallBacks::MakeCut({"pt", "charge"},
+                                     [](const double &p, const double &q) { return p > 0.5 && q!=0; }, "pt"));
+  cuts.AddCut(Qn::CallBacks::MakeCut({"centrality", "pt"},
+                                     [](const double &c, const double &p) { return c < 50. || p > 2.; }, "central"));
+  cuts.Initialize(manager);
+  for (const double centrality : {20., 80.}) {
+    manager.SetValues("centrality", &centrality, 1);
+    std::vector<unsigned int> expected;
+    for (int i = 0; i < kChannels; ++i) {
+      if (pt[i] > 0.5f && charge[i]!=0 && (centrality < 50. || pt[i] > 2.f)) expected.push_back(i);
+    }
+    EXPECT_EQ(expected, cuts.Evaluate(kChannels));
+  }
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "CorrectionDataVector.h"
+
+TEST(CorrectionDataVectorTest, StructureOfArrays) {
+  Qn::CorrectionDataVectors vectors;
+  vectors.Add(3, 0.5, 2., 0.1);
+  vectors.Add(7, 1.5, 4., 0.2);
+  ASSERT_EQ(2u, vectors.size());
+  EXPECT_EQ(7, vectors.Ids()[1]);
+  EXPECT_FLOAT_EQ(1.5, vectors.Phis()[1]);
+  EXPECT_FLOAT_EQ(0.2, vectors.RadialOffsets()[1]);
+  EXPECT_FLOAT_EQ(4., vectors.Weights()[1]);
+  EXPECT_FLOAT_EQ(4., vectors.EqualizedWeights()[1]);
+  vectors.Clear();
+  EXPECT_EQ(0u, vectors.size());
+}
+
+TEST(CorrectionDataVectorTest, GroupKeepsOrderOfFilling) {
+  Qn::CorrectionDataVectors filled;
+  const std::vector<long> bins = {2, 0, 2, 1, 0, 2};
+  for (std::size_t i = 0; i < bins.size(); ++i) {
+    filled.Add(static_cast<int>(i), 0.1f*i, 1.f + i, 0.f);
+  }
+  Qn::CorrectionDataVectors arena;
+  std::vector<std::size_t> offsets;
+  std::vector<std::size_t> positions;
+  arena.Group(filled, bins.data(), 4, offsets, positions);
+  ASSERT_EQ(filled.size(), arena.size());
+  EXPECT_EQ((std::vector<std::size_t>{0, 2, 3, 6, 6}), offsets);
+  const std::vector<int> expected_ids = {1, 4, 3, 0, 2, 5};
+  for (std::size_t i = 0; i < arena.size(); ++i) {
+    const auto id = expected_ids[i];
+    EXPECT_EQ(id, arena.Ids()[i]);
+    EXPECT_FLOAT_EQ(0.1f*id, arena.Phis()[i]);
+    EXPECT_FLOAT_EQ(1.f + id, arena.Weights()[i]);
+  }
+  Qn::CorrectionDataVectorRange range(arena, offsets[2], offsets[3]);
+  ASSERT_EQ(3u, range.size());
+  EXPECT_EQ(5, range.GetId(2));
+  range.SetEqualizedWeight(0, 10.f);
+  EXPECT_FLOAT_EQ(10.f, arena.EqualizedWeights()[3]);
+  EXPECT_TRUE(Qn::CorrectionDataVectorRange(arena, offsets[3], offsets[4]).empty());
+}
+
+TEST(CorrectionDataVectorTest, GroupReusesBuffers) {
+  Qn::CorrectionDataVectors filled;
+  const std::vector<long> bins = {1, 0, 1};
+  for (std::size_t i = 0; i < bins.size(); ++i) { filled.Add(static_cast<int>(i), 0.f, 1.f, 0.f); }
+  Qn::CorrectionDataVectors arena;
+  std::vector<std::size_t> offsets;
+  std::vector<std::size_t> positions;
+  arena.Group(filled, bins.data(), 2, offsets, positions);
+  const auto ids = arena.Ids();
+  filled.Clear();
+  const std::vector<long> next_bins = {0, 1};
+  for (std::size_t i = 0; i < next_bins.size(); ++i) { filled.Add(10 + static_cast<int>(i), 0.f, 1.f, 0.f); }
+  arena.Group(filled, next_bins.data(), 2, offsets, positions);
+  EXPECT_EQ(ids, arena.Ids());
+  ASSERT_EQ(2u, arena.size());
+  EXPECT_EQ(10, arena.Ids()[0]);
+  EXPECT_EQ(11, arena.Ids()[1]);
+  EXPECT_EQ((std::vector<std::size_t>{0, 1, 2}), offsets);
+}
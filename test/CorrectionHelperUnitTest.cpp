@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RVec.hxx>
+
+#include "CorrectionHelper.h"
+#include "HistogramComparison.h"
+
+namespace {
+constexpr int kNPtBins = 3;
+constexpr int kNEvents = 300;
+enum Variables { kCentrality = 0, kPhi, kPt, kEta, kWeight };
+
+/**
+ * Configures a manager with one differential tracking detector, which is recentered. The detector has a cut on a
+ * track variable and a QA histogram.
+ */
+std::unique_ptr<Qn::CorrectionManager> Configure() {
+  auto manager = std::make_unique<Qn::CorrectionManager>();
+  manager->SetFillCalibrationQA(true);
+  manager->AddVariable("Centrality", kCentrality, 1);
+  manager->AddVariable("phi", kPhi, 1);
+  manager->AddVariable("pt", kPt, 1);
+  manager->AddVariable("eta", kEta, 1);
+  manager->AddVariable("weight", kWeight, 1);
+  manager->AddCorrectionAxis({"Centrality", 4, 0., 100.});
+  manager->AddDetector("TPC", Qn::DetectorType::TRACK, "phi", "weight", {{"pt", kNPtBins, 0., 3.}}, {1, 2});
+  manager->AddCutOnDetector("TPC", {"eta"}, [](const double &eta) { return std::abs(eta) < 0.8; }, "eta");
+  manager->AddCorrectionOnQnVector("TPC", Qn::Recentering());
+  manager->AddHisto1D("TPC", {"pt", 30, 0., 3.});
+  manager->SetOutputQVectors("TPC", {Qn::QVector::CorrectionStep::PLAIN, Qn::QVector::CorrectionStep::RECENTERED});
+  manager->SetFillOutputInMemory(true);
+  manager->InitializeOnNode();
+  manager->SetCurrentRunName("run1");
+  return manager;
+}
+
+/**
+ * Tracks of one event.
+ */
+struct Tracks {
+  double centrality = 0.;
+  ROOT::RVec<double> phi, pt, eta, weight;
+};
+
+Tracks Generate(ULong64_t event) {
+  std::mt19937 generator(event);
+  std::uniform_real_distribution<double> centrality(0., 100.);
+  std::uniform_real_distribution<double> phi(0., 2*M_PI);
+  std::uniform_real_distribution<double> pt(0., 3.);
+  std::uniform_real_distribution<double> eta(-1., 1.);
+  std::uniform_real_distribution<double> weight(0.5, 1.5);
+  Tracks tracks;
+  tracks.centrality = centrality(generator);
+  const auto n_tracks = 20 + event%50;
+  for (ULong64_t track = 0; track < n_tracks; ++track) {
+    tracks.phi.push_back(phi(generator));
+    tracks.pt.push_back(pt(generator));
+    tracks.eta.push_back(eta(generator));
+    tracks.weight.push_back(weight(generator));
+  }
+  return tracks;
+}
+
+void ExpectEqualQVectors(const Qn::DataContainerQVector &expected, const Qn::DataContainerQVector &actual,
+                         const std::string &what) {
+  ASSERT_EQ(expected.size(), actual.size()) << what;
+  for (std::size_t bin = 0; bin < expected.size(); ++bin) {
+    const auto &a = expected.At(bin);
+    const auto &b = actual.At(bin);
+    const auto name = what + " bin " + std::to_string(bin);
+    EXPECT_EQ(a.n(), b.n()) << name;
+    QnTest::ExpectClose(a.sumweights(), b.sumweights(), name + " sum of weights");
+    for (int h = 1; h <= 2; ++h) {
+      QnTest::ExpectClose(a.x(h), b.x(h), name + " x" + std::to_string(h));
+      QnTest::ExpectClose(a.y(h), b.y(h), name + " y" + std::to_string(h));
+    }
+  }
+}
+}
+
+TEST(CorrectionHelperTest, DataFrameEqualsEventLoop) {
+  const std::vector<Qn::QVector::CorrectionStep> steps{Qn::QVector::CorrectionStep::PLAIN,
+                                                       Qn::QVector::CorrectionStep::RECENTERED};
+  auto baseline = Configure();
+  std::vector<std::vector<Qn::DataContainerQVector>> expected(steps.size());
+  for (ULong64_t event = 0; event < kNEvents; ++event) {
+    const auto tracks = Generate(event);
+    baseline->Reset();
+    auto values = baseline->GetVariableContainer();
+    values[kCentrality] = tracks.centrality;
+    if (baseline->ProcessEvent()) {
+      for (std::size_t track = 0; track < tracks.phi.size(); ++track) {
+        values[kPhi] = tracks.phi[track];
+        values[kPt] = tracks.pt[track];
+        values[kEta] = tracks.eta[track];
+        values[kWeight] = tracks.weight[track];
+        baseline->FillTrackingDetectors();
+      }
+    }
+    baseline->ProcessCorrections();
+    for (std::size_t i = 0; i < steps.size(); ++i) expected[i].push_back(*baseline->GetQVector("TPC", steps[i]));
+  }
+  baseline->Finalize();
+
+  auto manager = Configure();
+  ROOT::RDataFrame data_frame(kNEvents);
+  auto df = data_frame.Define("Tracks", Generate, {"rdfentry_"})
+      .Define("Centrality", [](const Tracks &tracks) { return tracks.centrality; }, {"Tracks"})
+      .Define("phi", [](const Tracks &tracks) { return tracks.phi; }, {"Tracks"})
+      .Define("pt", [](const Tracks &tracks) { return tracks.pt; }, {"Tracks"})
+      .Define("eta", [](const Tracks &tracks) { return tracks.eta; }, {"Tracks"})
+      .Define("weight", [](const Tracks &tracks) { return tracks.weight; }, {"Tracks"});
+  using RVecD = ROOT::RVec<double>;
+  Qn::CorrectionHelper<double, RVecD, RVecD, RVecD, RVecD> helper(manager.get(),
+                                                                   {"Centrality", "phi", "pt", "eta", "weight"});
+  auto df_q_vectors = helper.DefineQVectors(df);
+  auto corrections = helper.BookMe(df_q_vectors);
+  std::vector<std::vector<Qn::DataContainerQVector>> actual(steps.size());
+  df_q_vectors.Foreach([&actual](const Qn::DataContainerQVector *plain, const Qn::DataContainerQVector *recentered) {
+    actual[0].push_back(*plain);
+    actual[1].push_back(*recentered);
+  }, {"TPC_PLAIN", "TPC_RECENTERED"});
+
+  for (std::size_t i = 0; i < steps.size(); ++i) {
+    ASSERT_EQ(expected[i].size(), actual[i].size());
+    for (std::size_t event = 0; event < expected[i].size(); ++event) {
+      ExpectEqualQVectors(expected[i][event], actual[i][event],
+                          std::string(Qn::kCorrectionStepNamesArray[steps[i]]) + " event " + std::to_string(event));
+    }
+  }
+  QnTest::ExpectEqualLists(baseline->GetCorrectionList(), corrections.GetPtr());
+  QnTest::ExpectEqualLists(baseline->GetCorrectionQAList(), manager->GetCorrectionQAList());
+}
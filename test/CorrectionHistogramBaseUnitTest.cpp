@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include <THn.h>
+#include <RConfigure.h>
+#include <TROOT.h>
+
+#include "CorrectionHistogramBase.h"
+#include "HistogramComparison.h"
+
+namespace {
+/**
+ * Exposes the division of the calibration histograms.
+ */
+class DivisionHistogram : public Qn::CorrectionHistogramBase {
+ public:
+  DivisionHistogram(ErrorMode mode, Int_t min_entries) :
+      Qn::CorrectionHistogramBase("division", "division", Qn::CorrectionAxisSet(), mode) {
+    SetNoOfEntriesThreshold(min_entries);
+  }
+  using Qn::CorrectionHistogramBase::DivideTHnF;
+};
+
+struct Accumulated {
+  std::unique_ptr<THnF> values;
+  std::unique_ptr<THnI> entries;
+};
+
+/**
+ * Fills the sums of the values and of the squared values together with the number of entries of each bin.
+ * The bin number determines the number of entries, so that some bins are below the validation threshold.
+ */
+Accumulated Accumulate(int n_bins_per_axis) {
+  int n_bins[2] = {n_bins_per_axis, n_bins_per_axis};
+  double min[2] = {0., 0.};
+  double max[2] = {1., 1.};
+  Accumulated accumulated;
+  accumulated.values = std::make_unique<THnF>("values", "values", 2, n_bins, min, max);
+  accumulated.entries = std::make_unique<THnI>("entries", "entries", 2, n_bins, min, max);
+  accumulated.values->Sumw2();
+  for (Long64_t bin = 0; bin < accumulated.values->GetNbins(); ++bin) {
+    const int n = bin%5;
+    double sum = 0.;
+    double sum2 = 0.;
+    for (int i = 0; i < n; ++i) {
+      const double value = 0.25*(bin%7) + 0.5*i;
+      sum += value;
+      sum2 += value*value;
+    }
+    accumulated.values->SetBinContent(bin, sum);
+    accumulated.values->SetBinError2(bin, sum2);
+    accumulated.entries->SetBinContent(bin, n);
+  }
+  accumulated.values->SetEntries(42);
+  return accumulated;
+}
+
+/**
+ * Compares the division with the definition of the average and its error bin by bin.
+ */
+void ExpectDivision(const Accumulated &accumulated, Qn::CorrectionHistogramBase::ErrorMode mode, int min_entries) {
+  DivisionHistogram histogram(mode, min_entries);
+  auto valid = std::unique_ptr<THnC>(
+      static_cast<THnC *>(THn::CreateHn("valid", "valid", accumulated.entries.get())));
+  std::unique_ptr<THnF> result(histogram.DivideTHnF(accumulated.values.get(), accumulated.entries.get(), valid.get()));
+  ASSERT_EQ(accumulated.values->GetNbins(), result->GetNbins());
+  EXPECT_DOUBLE_EQ(42., result->GetEntries());
+  for (Long64_t bin = 0; bin < result->GetNbins(); ++bin) {
+    const auto what = "bin " + std::to_string(bin);
+    const auto n = accumulated.entries->GetBinContent(bin);
+    if (n < min_entries) {
+      EXPECT_EQ(0., result->GetBinContent(bin)) << what;
+      EXPECT_EQ(0., result->GetBinError2(bin)) << what;
+      EXPECT_EQ(0., valid->GetBinContent(bin)) << what;
+      continue;
+    }
+    const double average = accumulated.values->GetBinContent(bin)/n;
+    const double spread = std::sqrt(std::abs(accumulated.values->GetBinError2(bin)/n - average*average));
+    const double error = mode==Qn::CorrectionHistogramBase::ErrorMode::MEAN ? spread/std::sqrt(n) : spread;
+    QnTest::ExpectClose(average, result->GetBinContent(bin), what + " content");
+    QnTest::ExpectClose(error*error, result->GetBinError2(bin), what + " error");
+    EXPECT_EQ(1., valid->GetBinContent(bin)) << what;
+  }
+}
+}
+
+TEST(CorrectionHistogramBaseTest, DivideErrorOnMean) {
+  auto accumulated = Accumulate(6);
+  ExpectDivision(accumulated, Qn::CorrectionHistogramBase::ErrorMode::MEAN, 2);
+}
+
+TEST(CorrectionHistogramBaseTest, DivideSpread) {
+  auto accumulated = Accumulate(6);
+  ExpectDivision(accumulated, Qn::CorrectionHistogramBase::ErrorMode::SPREAD, 3);
+}
+
+TEST(CorrectionHistogramBaseTest, DivideWithoutValidationHistogram) {
+  auto accumulated = Accumulate(4);
+  DivisionHistogram histogram(Qn::CorrectionHistogramBase::ErrorMode::MEAN, 2);
+  std::unique_ptr<THnF> result(histogram.DivideTHnF(accumulated.values.get(), accumulated.entries.get()));
+  for (Long64_t bin = 0; bin < result->GetNbins(); ++bin) {
+    const auto n = accumulated.entries->GetBinContent(bin);
+    const double expected = n < 2 ? 0. : accumulated.values->GetBinContent(bin)/n;
+    QnTest::ExpectClose(expected, result->GetBinContent(bin), "bin " + std::to_string(bin));
+  }
+}
+
+#ifdef R__USE_IMT
+TEST(CorrectionHistogramBaseTest, DivideInParallel) {
+  /* enough bins to divide the histogram in chunks */
+  auto accumulated = Accumulate(300);
+  ROOT::EnableImplicitMT(4);
+  ExpectDivision(accumulated, Qn::CorrectionHistogramBase::ErrorMode::MEAN, 2);
+  ROOT::DisableImplicitMT();
+}
+#endif
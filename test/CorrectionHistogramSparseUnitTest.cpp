@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+
+#include <THnSparse.h>
+#include <TList.h>
+
+#include "CorrectionHistogramChannelizedSparse.h"
+#include "CorrectionHistogramSparse.h"
+#include "CorrectionParameterTable.h"
+#include "CorrectionProfileChannelized.h"
+#include "CorrectionProfileComponents.h"
+#include "HistogramComparison.h"
+#include "InputVariableManager.h"
+
+namespace {
+constexpr int kNChannels = 6;
+constexpr int kNEvents = 500;
+/* the channels 1 and 4 are not used, so that the channel axis differs from the detector channels. */
+const Bool_t kUsedChannels[kNChannels] = {kTRUE, kFALSE, kTRUE, kTRUE, kFALSE, kTRUE};
+
+/**
+ * Sets up the event class variables with values in and outside of the range of the axes.
+ */
+struct EventClasses {
+  EventClasses() {
+    variables.CreateVariable("Centrality", 1);
+    variables.CreateVariable("Vz", 1);
+    variables.Initialize();
+    axes.Add(Qn::AxisD{"Centrality", 4, 0., 100.});
+    axes.Add(Qn::AxisD{"Vz", 3, -10., 10.});
+    axes.Initialize(variables);
+  }
+  void SetEvent(int event) {
+    auto values = variables.GetVariableContainer();
+    values[variables.FindVariable("Centrality").GetID()] = -10. + (event*37)%120;
+    values[variables.FindVariable("Vz").GetID()] = -12. + (event*13)%25;
+  }
+  Qn::InputVariableManager variables;
+  Qn::CorrectionAxisSet axes;
+};
+
+/**
+ * Marks the events and channels without validated calibration.
+ */
+bool Fails(int event, int channel = 0) { return (event + channel)%3==0; }
+
+/**
+ * Compares the histograms in both directions, so that neither contains bins which are missing in the other one.
+ */
+void ExpectEqualSparse(const THnBase *expected, const THnBase *actual) {
+  QnTest::ExpectEqualHistograms(expected, actual, "expected");
+  QnTest::ExpectEqualHistograms(actual, expected, "actual");
+  EXPECT_EQ(expected->GetNbins(), actual->GetNbins());
+}
+}
+
+TEST(CorrectionHistogramSparseTest, FillCountsMatchesFillingEachFailure) {
+  EventClasses classes;
+  TList list;
+  list.SetOwner(true);
+  Qn::CorrectionProfileComponents calibration("calibration", classes.axes);
+  ASSERT_TRUE(calibration.CreateComponentsProfileHistograms(&list, 1));
+  Qn::CorrectionHistogramSparse filled("filled", classes.axes);
+  Qn::CorrectionHistogramSparse counted("counted", classes.axes);
+  ASSERT_TRUE(filled.CreateHistogram(&list));
+  ASSERT_TRUE(counted.CreateHistogram(&list));
+  Qn::CorrectionParameterTable table;
+  table.Reset(calibration.GetNoOfBins(), 4);
+  std::set<Long64_t> failed_bins;
+  for (int event = 0; event < kNEvents; ++event) {
+    classes.SetEvent(event);
+    if (!Fails(event)) continue;
+    filled.Fill(1.);
+    table.CountFailure(calibration.GetBin());
+    failed_bins.insert(calibration.GetBin());
+  }
+  counted.FillCounts(table.GetFailures());
+  auto filled_values = static_cast<THnSparseF *>(list.FindObject("filled"));
+  auto counted_values = static_cast<THnSparseF *>(list.FindObject("counted"));
+  ASSERT_NE(filled_values, nullptr);
+  ASSERT_NE(counted_values, nullptr);
+  ExpectEqualSparse(filled_values, counted_values);
+  EXPECT_EQ(static_cast<Long64_t>(failed_bins.size()), counted_values->GetNbins());
+  /* the bins outside of the axes are counted in the under- and overflow bins. */
+  Int_t coordinates[2] = {5, 0};
+  EXPECT_LT(0., counted_values->GetBinContent(coordinates));
+  /* a second flush adds only the failures counted since the reset. */
+  const auto entries = counted_values->GetEntries();
+  table.ResetFailures();
+  counted.FillCounts(table.GetFailures());
+  EXPECT_EQ(entries, counted_values->GetEntries());
+  EXPECT_EQ(static_cast<Long64_t>(failed_bins.size()), counted_values->GetNbins());
+}
+
+TEST(CorrectionHistogramSparseTest, ChannelizedFillCountsMatchesFillingEachFailure) {
+  EventClasses classes;
+  TList list;
+  list.SetOwner(true);
+  Qn::CorrectionProfileChannelized calibration("calibration", classes.axes, kNChannels);
+  ASSERT_TRUE(calibration.CreateProfileHistograms(&list, kUsedChannels, nullptr));
+  Qn::CorrectionHistogramChannelizedSparse filled("filled", classes.axes, kNChannels);
+  Qn::CorrectionHistogramChannelizedSparse counted("counted", classes.axes, kNChannels);
+  ASSERT_TRUE(filled.CreateChannelizedHistogram(&list, kUsedChannels));
+  ASSERT_TRUE(counted.CreateChannelizedHistogram(&list, kUsedChannels));
+  Qn::CorrectionParameterTable table;
+  table.Reset(calibration.GetNoOfBins(), 1);
+  Long64_t n_failures = 0;
+  for (int event = 0; event < kNEvents; ++event) {
+    classes.SetEvent(event);
+    for (int channel = 0; channel < kNChannels; ++channel) {
+      if (!kUsedChannels[channel] || !Fails(event, channel)) continue;
+      filled.Fill(channel, 1.);
+      table.CountFailure(calibration.GetBin(channel));
+      ++n_failures;
+    }
+  }
+  counted.FillCounts(table.GetFailures());
+  auto filled_values = static_cast<THnSparseF *>(list.FindObject("filled"));
+  auto counted_values = static_cast<THnSparseF *>(list.FindObject("counted"));
+  ASSERT_NE(filled_values, nullptr);
+  ASSERT_NE(counted_values, nullptr);
+  ASSERT_EQ(3, counted_values->GetNdimensions());
+  EXPECT_EQ(4, counted_values->GetAxis(2)->GetNbins());
+  ExpectEqualSparse(filled_values, counted_values);
+  EXPECT_EQ(static_cast<double>(n_failures), counted_values->GetEntries());
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CorrectionManager.h"
+#include "HistogramComparison.h"
+
+namespace {
+constexpr int kNChannels = 8;
+constexpr int kNEventsPerRun = 1000;
+enum Variables { kCentrality = 0, kPhi, kWeight = kPhi + kNChannels };
+
+/**
+ * Configures a manager with one channel detector, which is corrected with the gain equalization and the recentering
+ * step.
+ */
+std::unique_ptr<Qn::CorrectionManager> Configure() {
+  auto manager = std::make_unique<Qn::CorrectionManager>();
+  manager->AddVariable("Centrality", kCentrality, 1);
+  manager->AddVariable("phi", kPhi, kNChannels);
+  manager->AddVariable("weight", kWeight, kNChannels);
+  manager->AddCorrectionAxis({"Centrality", 4, 0., 100.});
+  manager->AddDetector("FMD", Qn::DetectorType::CHANNEL, "phi", "weight", {}, {1, 2});
+  Qn::GainEqualization equalization;
+  equalization.SetEqualizationMethod(Qn::GainEqualization::Method::AVERAGE);
+  manager->AddCorrectionOnInputData("FMD", equalization);
+  manager->AddCorrectionOnQnVector("FMD", Qn::Recentering());
+  manager->InitializeOnNode();
+  return manager;
+}
+
+/**
+ * Processes the events of one run. Each event is generated from its own seed, so that the same events can be
+ * processed by different managers.
+ */
+void ProcessRun(Qn::CorrectionManager &manager, const std::string &run, int first_event) {
+  manager.SetCurrentRunName(run);
+  for (int event = first_event; event < first_event + kNEventsPerRun; ++event) {
+    std::mt19937 generator(event);
+    std::uniform_real_distribution<double> centrality(0., 100.);
+    std::uniform_real_distribution<double> gain(0.5, 1.5);
+    manager.Reset();
+    auto values = manager.GetVariableContainer();
+    values[kCentrality] = centrality(generator);
+    for (int channel = 0; channel < kNChannels; ++channel) {
+      values[kPhi + channel] = (channel + 0.5)*2*M_PI/kNChannels;
+      values[kWeight + channel] = gain(generator)*(1. + 0.1*channel);
+    }
+    if (manager.ProcessEvent()) manager.FillChannelDetectors();
+    manager.ProcessCorrections();
+  }
+}
+
+/**
+ * Collects the histograms of a nested list.
+ */
+void CollectHistograms(TList *list, std::vector<TObject *> &histograms) {
+  for (auto object : *list) {
+    if (auto sub_list = dynamic_cast<TList *>(object)) {
+      CollectHistograms(sub_list, histograms);
+    } else {
+      histograms.push_back(object);
+    }
+  }
+}
+}
+
+TEST(CorrectionManagerRunSwitchTest, RunsEqualSeparateProcessing) {
+  auto manager = Configure();
+  ProcessRun(*manager, "run1", 0);
+  ProcessRun(*manager, "run2", kNEventsPerRun);
+  manager->Finalize();
+  auto output = manager->GetCorrectionList();
+  EXPECT_EQ(2, output->GetEntries());
+  int first_event = 0;
+  for (auto run : {"run1", "run2"}) {
+    auto separate = Configure();
+    ProcessRun(*separate, run, first_event);
+    separate->Finalize();
+    QnTest::ExpectEqualLists(static_cast<TList *>(separate->GetCorrectionList()->FindObject(run)),
+                             static_cast<TList *>(output->FindObject(run)), run);
+    first_event += kNEventsPerRun;
+  }
+}
+
+TEST(CorrectionManagerRunSwitchTest, HistogramsAreReused) {
+  auto manager = Configure();
+  ProcessRun(*manager, "run1", 0);
+  auto first_run = static_cast<TList *>(manager->GetCorrectionList()->FindObject("run1"));
+  ASSERT_NE(nullptr, first_run);
+  std::vector<TObject *> first_histograms;
+  CollectHistograms(first_run, first_histograms);
+  ASSERT_FALSE(first_histograms.empty());
+  ProcessRun(*manager, "run2", kNEventsPerRun);
+  auto second_run = static_cast<TList *>(manager->GetCorrectionList()->FindObject("run2"));
+  EXPECT_EQ(first_run, second_run);
+  std::vector<TObject *> second_histograms;
+  CollectHistograms(second_run, second_histograms);
+  EXPECT_EQ(first_histograms, second_histograms);
+  auto compact_run = static_cast<TList *>(manager->GetCorrectionList()->FindObject("run1"));
+  ASSERT_NE(nullptr, compact_run);
+  EXPECT_NE(first_run, compact_run);
+  manager->Finalize();
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <TH1.h>
+#include <TH2.h>
+#include <TList.h>
+
+#include "CorrectionManager.h"
+#include "HistogramComparison.h"
+
+namespace {
+constexpr int kNChannels = 8;
+enum Variables { kCentrality = 0, kPhi, kWeight = kPhi + kNChannels };
+
+/**
+ * Configures a manager with one channel detector, which is corrected with the gain equalization, the recentering and
+ * the twist and rescale step.
+ * @param n_slots number of slots
+ * @param grouped if true, the gain equalization is done in two groups of channels.
+ * @param cuts if true, the events are selected in centrality and the channels of the detector by their weight.
+ */
+std::unique_ptr<Qn::CorrectionManager> Configure(unsigned int n_slots, bool grouped = false, bool cuts = false) {
+  auto manager = std::make_unique<Qn::CorrectionManager>();
+  manager->SetFillCalibrationQA(true);
+  manager->SetFillValidationQA(true);
+  manager->SetNumberOfSlots(n_slots);
+  manager->AddVariable("Centrality", kCentrality, 1);
+  manager->AddVariable("phi", kPhi, kNChannels);
+  manager->AddVariable("weight", kWeight, kNChannels);
+  manager->AddCorrectionAxis({"Centrality", 4, 0., 100.});
+  manager->AddDetector("FMD", Qn::DetectorType::CHANNEL, "phi", "weight", {}, {1, 2});
+  if (grouped) manager->SetChannelGroups("FMD", {0, 0, 0, 0, 1, 1, 1, 1});
+  Qn::GainEqualization equalization;
+  equalization.SetEqualizationMethod(Qn::GainEqualization::Method::AVERAGE);
+  manager->AddCorrectionOnInputData("FMD", equalization);
+  manager->AddCorrectionOnQnVector("FMD", Qn::Recentering());
+  Qn::TwistAndRescale twist_and_rescale;
+  twist_and_rescale.SetTwistAndRescaleMethod(Qn::TwistAndRescale::Method::DOUBLE_HARMONIC);
+  manager->AddCorrectionOnQnVector("FMD", twist_and_rescale);
+  manager->AddHisto1D("FMD", {"phi", kNChannels, 0., 2*M_PI}, "weight");
+  manager->AddEventHisto1D({"Centrality", 20, 0., 100.});
+  if (cuts) {
+    manager->AddEventCut({"Centrality"}, [](const double &c) { return c < 80.; }, "centrality");
+    manager->AddCutOnDetector("FMD", {"weight"}, [](const double &w) { return w > 0.8; }, "weight");
+  }
+  manager->InitializeOnNode();
+  return manager;
+}
+
+/**
+ * Processes the events of two runs. The events are distributed over the slots in a round robin. Each event is generated
+ * from its own seed, so that the events do not depend on the slot which processes them.
+ */
+void Process(Qn::CorrectionManager &manager) {
+  const unsigned int n_slots = manager.GetNumberOfSlots();
+  int event = 0;
+  for (auto run : {"run1", "run2"}) {
+    manager.SetCurrentRunName(run);
+    for (int i = 0; i < 2000; ++i, ++event) {
+      const auto slot = event%n_slots;
+      std::mt19937 generator(event);
+      std::uniform_real_distribution<double> centrality(0., 100.);
+      std::uniform_real_distribution<double> gain(0.5, 1.5);
+      manager.Reset(slot);
+      auto values = manager.GetVariableContainer(slot);
+      values[kCentrality] = centrality(generator);
+      for (int channel = 0; channel < kNChannels; ++channel) {
+        values[kPhi + channel] = (channel + 0.5)*2*M_PI/kNChannels;
+        values[kWeight + channel] = gain(generator)*(1. + 0.1*channel);
+      }
+      if (manager.ProcessEvent(slot)) manager.FillChannelDetectors(slot);
+      manager.ProcessCorrections(slot);
+    }
+  }
+  manager.Finalize();
+}
+}
+
+TEST(CorrectionManagerSlotsTest, MergedSlotsEqualSingleSlot) {
+  auto single = Configure(1);
+  Process(*single);
+  for (unsigned int n_slots : {2u, 3u}) {
+    auto parallel = Configure(n_slots);
+    EXPECT_EQ(parallel->GetNumberOfSlots(), n_slots);
+    Process(*parallel);
+    QnTest::ExpectEqualLists(single->GetCorrectionList(), parallel->GetCorrectionList());
+    QnTest::ExpectEqualLists(single->GetCorrectionQAList(), parallel->GetCorrectionQAList());
+  }
+}
+
+TEST(CorrectionManagerSlotsTest, WorkersKeepTheChannelGroups) {
+  auto single = Configure(1, true);
+  Process(*single);
+  auto parallel = Configure(3, true);
+  Process(*parallel);
+  QnTest::ExpectEqualLists(single->GetCorrectionList(), parallel->GetCorrectionList());
+  QnTest::ExpectEqualLists(single->GetCorrectionQAList(), parallel->GetCorrectionQAList());
+}
+
+TEST(CorrectionManagerSlotsTest, CutReportsCountTheSelectionOfAllSlots) {
+  // the expected counts follow from the same seeds as the events in Process.
+  double events = 0., selected_events = 0.;
+  std::vector<double> selected_channels(kNChannels, 0.);
+  for (int event = 0; event < 4000; ++event) {
+    std::mt19937 generator(event);
+    std::uniform_real_distribution<double> centrality(0., 100.);
+    std::uniform_real_distribution<double> gain(0.5, 1.5);
+    ++events;
+    const bool selected = centrality(generator) < 80.;
+    selected_events += selected;
+    for (int channel = 0; channel < kNChannels; ++channel) {
+      const auto weight = gain(generator)*(1. + 0.1*channel);
+      if (selected && weight > 0.8) ++selected_channels[channel];
+    }
+  }
+  for (unsigned int n_slots : {1u, 3u}) {
+    auto manager = Configure(n_slots, false, true);
+    Process(*manager);
+    auto qa = manager->GetCorrectionQAList();
+    auto event_qa = dynamic_cast<TList *>(qa->FindObject("event_QA"));
+    ASSERT_NE(event_qa, nullptr);
+    auto event_report = dynamic_cast<TH1D *>(event_qa->FindObject("Cut_Report:Cut_Report"));
+    ASSERT_NE(event_report, nullptr);
+    EXPECT_EQ(events, event_report->GetBinContent(1));
+    EXPECT_EQ(selected_events, event_report->GetBinContent(2));
+    EXPECT_EQ(events + selected_events, event_report->GetEntries());
+    auto detector_qa = dynamic_cast<TList *>(static_cast<TList *>(qa->FindObject("FMD"))->FindObject("detector_QA"));
+    ASSERT_NE(detector_qa, nullptr);
+    auto detector_report = dynamic_cast<TH2D *>(detector_qa->FindObject("FMD:Cut_Report"));
+    ASSERT_NE(detector_report, nullptr);
+    for (int channel = 0; channel < kNChannels; ++channel) {
+      EXPECT_EQ(selected_events, detector_report->GetBinContent(1, channel + 1));
+      EXPECT_EQ(selected_channels[channel], detector_report->GetBinContent(2, channel + 1));
+    }
+  }
+}
+
+TEST(CorrectionManagerSlotsTest, RejectsSlotsBeyondTheNumberOfSlots) {
+  auto manager = Configure(2);
+  EXPECT_NO_THROW(manager->GetVariableContainer(1));
+  EXPECT_THROW(manager->GetVariableContainer(2), std::out_of_range);
+}
+
+TEST(CorrectionManagerSlotsTest, RejectsZeroSlots) {
+  Qn::CorrectionManager manager;
+  EXPECT_THROW(manager.SetNumberOfSlots(0), std::invalid_argument);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CorrectionParameterFile.h"
+
+namespace {
+Qn::CorrectionParameterTable MakeTable(Long64_t n_bins, unsigned int n_parameters, float offset) {
+  Qn::CorrectionParameterTable table;
+  table.Reset(n_bins, n_parameters);
+  table.SetHarmonics(0b101);
+  for (Long64_t bin = 0; bin < n_bins; ++bin) {
+    for (unsigned int h = 0; h < table.GetNoOfHarmonics(); ++h) {
+      auto parameters = table.Parameters(bin, h);
+      for (unsigned int p = 0; p < n_parameters; ++p) parameters[p] = offset + bin*100.f + h*10.f + p;
+    }
+    if (bin%3!=0) table.SetValidated(bin);
+  }
+  return table;
+}
+
+bool Read(const Qn::CorrectionParameterFile &file, const std::string &run, const std::string &sub_event,
+          const std::string &step, const Qn::CorrectionParameterTable &layout, Qn::CorrectionParameterTable &table) {
+  return file.Read(run, sub_event, step, layout.GetNoOfBins(), layout.GetNoOfParameters(), layout.GetNoOfHarmonics(),
+                   layout.GetHarmonics(), table);
+}
+
+void ExpectEqualTables(const Qn::CorrectionParameterTable &a, const Qn::CorrectionParameterTable &b) {
+  ASSERT_EQ(a.GetNoOfBins(), b.GetNoOfBins());
+  ASSERT_EQ(a.GetNoOfParameters(), b.GetNoOfParameters());
+  ASSERT_EQ(a.GetNoOfHarmonics(), b.GetNoOfHarmonics());
+  EXPECT_EQ(a.GetHarmonics(), b.GetHarmonics());
+  for (Long64_t bin = 0; bin < a.GetNoOfBins(); ++bin) {
+    EXPECT_EQ(a.Validated(bin), b.Validated(bin));
+    for (unsigned int h = 0; h < a.GetNoOfHarmonics(); ++h) {
+      for (unsigned int p = 0; p < a.GetNoOfParameters(); ++p) {
+        EXPECT_FLOAT_EQ(a.Parameters(bin, h)[p], b.Parameters(bin, h)[p]);
+      }
+    }
+  }
+}
+
+std::vector<char> ReadBytes(const std::string &name) {
+  std::ifstream file(name, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void WriteBytes(const std::string &name, const std::vector<char> &bytes) {
+  std::ofstream file(name, std::ios::binary | std::ios::trunc);
+  file.write(bytes.data(), bytes.size());
+}
+}
+
+TEST(CorrectionParameterFileTest, WriteAndRead) {
+  const std::string name = "correctionparameters_test.bin";
+  auto recentering = MakeTable(12, 2, 0.f);
+  auto twist = MakeTable(7, 4, 0.5f);
+  Qn::CorrectionParameterFile::Writer writer;
+  writer.Add("run1", "FMD", "Recentering", recentering);
+  writer.Add("run1", "FMD", "TwistAndRescale", twist);
+  writer.Add("run2", "TPC", "Recentering", twist);
+  writer.Write(name);
+
+  Qn::CorrectionParameterFile file;
+  file.Open(name);
+  ASSERT_TRUE(file.IsOpen());
+  EXPECT_TRUE(file.Contains("run1", "FMD"));
+  EXPECT_TRUE(file.Contains("run2", "TPC"));
+  EXPECT_FALSE(file.Contains("run2", "FMD"));
+  Qn::CorrectionParameterTable table;
+  ASSERT_TRUE(Read(file, "run1", "FMD", "Recentering", recentering, table));
+  ExpectEqualTables(recentering, table);
+  ASSERT_TRUE(Read(file, "run1", "FMD", "TwistAndRescale", twist, table));
+  ExpectEqualTables(twist, table);
+  ASSERT_TRUE(Read(file, "run2", "TPC", "Recentering", twist, table));
+  ExpectEqualTables(twist, table);
+  EXPECT_FALSE(Read(file, "run2", "TPC", "Alignment", twist, table));
+  file.Close();
+  std::remove(name.data());
+}
+
+TEST(CorrectionParameterFileTest, RejectsInvalidFiles) {
+  const std::string name = "correctionparameters_test.bin";
+  const std::string broken = "correctionparameters_broken.bin";
+  Qn::CorrectionParameterFile::Writer writer;
+  writer.Add("run1", "FMD", "Recentering", MakeTable(12, 2, 0.f));
+  writer.Write(name);
+  const auto bytes = ReadBytes(name);
+  Qn::CorrectionParameterFile file;
+
+  // truncated inside the data section.
+  WriteBytes(broken, std::vector<char>(bytes.begin(), bytes.end() - 16));
+  EXPECT_THROW(file.Open(broken), std::runtime_error);
+  EXPECT_FALSE(file.IsOpen());
+  // truncated inside the header.
+  WriteBytes(broken, std::vector<char>(bytes.begin(), bytes.begin() + 4));
+  EXPECT_THROW(file.Open(broken), std::runtime_error);
+  // wrong magic.
+  auto modified = bytes;
+  modified[0] = 'X';
+  WriteBytes(broken, modified);
+  EXPECT_THROW(file.Open(broken), std::runtime_error);
+  // wrong version.
+  modified = bytes;
+  modified[8] = static_cast<char>(Qn::CorrectionParameterFile::kVersion + 1);
+  WriteBytes(broken, modified);
+  EXPECT_THROW(file.Open(broken), std::runtime_error);
+  // missing file.
+  EXPECT_THROW(file.Open("correctionparameters_missing.bin"), std::runtime_error);
+  std::remove(name.data());
+  std::remove(broken.data());
+}
+
+TEST(CorrectionParameterFileTest, RejectsMismatchedLayout) {
+  const std::string name = "correctionparameters_test.bin";
+  const auto recentering = MakeTable(12, 2, 0.f);
+  Qn::CorrectionParameterFile::Writer writer;
+  writer.Add("run1", "FMD", "Recentering", recentering);
+  writer.Write(name);
+  Qn::CorrectionParameterFile file;
+  file.Open(name);
+  const auto unchanged = MakeTable(3, 1, 7.f);
+  auto table = unchanged;
+  // different number of event class bins.
+  EXPECT_FALSE(file.Read("run1", "FMD", "Recentering", 13, 2, recentering.GetNoOfHarmonics(), 0b101, table));
+  // different number of parameters.
+  EXPECT_FALSE(file.Read("run1", "FMD", "Recentering", 12, 4, recentering.GetNoOfHarmonics(), 0b101, table));
+  // different number of harmonics.
+  EXPECT_FALSE(file.Read("run1", "FMD", "Recentering", 12, 2, 1, 0b101, table));
+  // different harmonics.
+  EXPECT_FALSE(file.Read("run1", "FMD", "Recentering", 12, 2, recentering.GetNoOfHarmonics(), 0b110, table));
+  ExpectEqualTables(unchanged, table);
+  EXPECT_TRUE(Read(file, "run1", "FMD", "Recentering", recentering, table));
+  ExpectEqualTables(recentering, table);
+  file.Close();
+  std::remove(name.data());
+}
+
+TEST(CorrectionParameterFileTest, RejectsOffsetsBeyondTheFile) {
+  const std::string name = "correctionparameters_test.bin";
+  const std::string broken = "correctionparameters_broken.bin";
+  Qn::CorrectionParameterFile::Writer writer;
+  writer.Add("run1", "FMD", "Recentering", MakeTable(12, 2, 0.f));
+  writer.Write(name);
+  const auto bytes = ReadBytes(name);
+  Qn::CorrectionParameterFile file;
+  // offsets of the parameters and of the validation flags in the first index record.
+  const std::size_t parameters_offset = 16 + 48;
+  const std::size_t validated_offset = 16 + 56;
+  for (auto offset : {parameters_offset, validated_offset}) {
+    // offsets close to the maximum would wrap around when the size of the table is added.
+    for (std::uint64_t value : {std::uint64_t(bytes.size()) + 8, ~std::uint64_t(0) - 4}) {
+      auto modified = bytes;
+      std::memcpy(modified.data() + offset, &value, sizeof(value));
+      WriteBytes(broken, modified);
+      EXPECT_THROW(file.Open(broken), std::runtime_error);
+      EXPECT_FALSE(file.IsOpen());
+    }
+  }
+  std::remove(name.data());
+  std::remove(broken.data());
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "CorrectionParameterTable.h"
+
+TEST(CorrectionParameterTableTest, ParametersPerBinAndHarmonic) {
+  Qn::CorrectionParameterTable table;
+  table.Reset(3, 4);
+  EXPECT_EQ(3, table.GetNoOfBins());
+  EXPECT_EQ(4u, table.GetNoOfParameters());
+  EXPECT_EQ(static_cast<unsigned int>(Qn::QVector::kmaxharmonics + 1), table.GetNoOfHarmonics());
+  for (Long64_t bin = 0; bin < 3; ++bin) { EXPECT_FALSE(table.Validated(bin)); }
+  table.SetValidated(1);
+  for (int harmonic = 1; harmonic <= Qn::QVector::kmaxharmonics; ++harmonic) {
+    auto parameters = table.Parameters(1, harmonic);
+    for (int i = 0; i < 4; ++i) { parameters[i] = 10*harmonic + i; }
+  }
+  EXPECT_TRUE(table.Validated(1));
+  EXPECT_FALSE(table.Validated(2));
+  const auto &const_table = table;
+  EXPECT_FLOAT_EQ(32., const_table.Parameters(1, 3)[2]);
+  EXPECT_FLOAT_EQ(0., const_table.Parameters(0, 3)[2]);
+  EXPECT_FLOAT_EQ(0., const_table.Parameters(2, 3)[2]);
+  const auto stride = table.GetNoOfHarmonics()*table.GetNoOfParameters();
+  EXPECT_FLOAT_EQ(81., table.GetParameterArray()[stride + 8*4 + 1]);
+}
+
+TEST(CorrectionParameterTableTest, AssignCopiesTable) {
+  const std::vector<Double_t> parameters = {1., 2., 3., 4., 5., 6.};
+  const std::vector<char> validated = {true, false, true};
+  Qn::CorrectionParameterTable table;
+  table.Assign(3, 2, 1, 0, parameters.data(), validated.data());
+  EXPECT_EQ(3, table.GetNoOfBins());
+  EXPECT_TRUE(table.Validated(0));
+  EXPECT_FALSE(table.Validated(1));
+  EXPECT_FLOAT_EQ(6., table.Parameters(2, 0)[1]);
+  EXPECT_NE(parameters.data(), table.GetParameterArray());
+  table.Clear();
+  EXPECT_TRUE(table.IsEmpty());
+}
+
+TEST(CorrectionParameterTableTest, FailuresSurviveRefill) {
+  Qn::CorrectionParameterTable table;
+  table.Reset(4, 1, 1);
+  const auto &failures = table.GetFailures();
+  for (const auto count : failures) { EXPECT_EQ(0, count); }
+  table.CountFailure(2);
+  table.CountFailure(2);
+  table.CountFailure(0);
+  table.Clear();
+  table.Reset(4, 1, 1);
+  ASSERT_EQ(4u, failures.size());
+  EXPECT_EQ(1, failures[0]);
+  EXPECT_EQ(0, failures[1]);
+  EXPECT_EQ(2, failures[2]);
+  table.ResetFailures();
+  for (const auto count : table.GetFailures()) { EXPECT_EQ(0, count); }
+}
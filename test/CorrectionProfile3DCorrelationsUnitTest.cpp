@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <bitset>
+#include <string>
+
+#include <THn.h>
+#include <TList.h>
+
+#include "CorrectionProfile3DCorrelations.h"
+#include "CorrectionProfileComponents.h"
+#include "CorrectionProfileCorrelationComponents.h"
+#include "HistogramComparison.h"
+#include "InputVariableManager.h"
+
+namespace {
+using Combination = Qn::CorrectionProfile3DCorrelations::Combination;
+using Component = Qn::CorrectionProfile3DCorrelations::Component;
+
+Qn::QVector MakeQVector(double phi) {
+  Qn::QVector q_vector(std::bitset<Qn::QVector::kmaxharmonics>("11"), Qn::QVector::CorrectionStep::PLAIN);
+  q_vector.Add(phi, 1.);
+  q_vector.Add(phi + 0.4, 0.5);
+  q_vector.CheckQuality();
+  return q_vector;
+}
+
+double Product(const Qn::QVector &first, const Qn::QVector &second, Component component, int harmonic) {
+  const double first_value = component==Component::XX || component==Component::XY ? first.x(harmonic)
+                                                                                     : first.y(harmonic);
+  const double second_value = component==Component::XX || component==Component::YX ? second.x(harmonic)
+                                                                                      : second.y(harmonic);
+  return first_value*second_value;
+}
+}
+
+TEST(CorrectionProfile3DCorrelationsTest, CombinationsAndComponentsMapToTheirHistograms) {
+  Qn::InputVariableManager variables;
+  variables.CreateVariable("Centrality", 1);
+  variables.Initialize();
+  Qn::CorrectionAxisSet axes;
+  axes.Add(Qn::AxisD{"Centrality", 2, 0., 100.});
+  axes.Initialize(variables);
+  Qn::CorrectionProfile3DCorrelations profile("corr", "A", "B", "C", axes);
+  profile.SetNoOfEntriesThreshold(1);
+  TList list;
+  list.SetOwner(true);
+  ASSERT_TRUE(profile.CreateCorrelationComponentsProfileHistograms(&list, 2));
+  // three combinations with four components of two harmonics and the entries.
+  EXPECT_EQ(3*4*2 + 1, list.GetEntries());
+  variables.GetVariableContainer()[variables.FindVariable("Centrality").GetID()] = 75.;
+  const auto a = MakeQVector(0.3);
+  const auto b = MakeQVector(1.1);
+  const auto c = MakeQVector(2.5);
+  profile.Fill(&a, &b, &c);
+  const auto bin = profile.GetBin();
+  ASSERT_EQ(profile.GetNoOfBins(), 4);
+  ASSERT_TRUE(profile.BinContentValidated(bin));
+  // AB correlates A with B, BC correlates B with C and AC correlates C with A.
+  const struct {
+    Combination combination;
+    const Qn::QVector *first;
+    const Qn::QVector *second;
+    std::string name;
+  } combinations[] = {{Combination::AB, &a, &b, "AxB"}, {Combination::BC, &b, &c, "BxC"},
+                      {Combination::AC, &c, &a, "CxA"}};
+  const struct {
+    Component component;
+    std::string name;
+  } components[] = {{Component::XX, "XX"}, {Component::XY, "XY"}, {Component::YX, "YX"}, {Component::YY, "YY"}};
+  for (const auto &combination : combinations) {
+    for (const auto &component : components) {
+      for (int harmonic = 1; harmonic <= 2; ++harmonic) {
+        const auto name = "corr " + combination.name + component.name + "_h" + std::to_string(harmonic);
+        const auto expected = Product(*combination.first, *combination.second, component.component, harmonic);
+        auto histogram = dynamic_cast<THnF *>(list.FindObject(name.data()));
+        ASSERT_NE(histogram, nullptr) << name;
+        QnTest::ExpectClose(expected, histogram->GetBinContent(bin), name);
+        QnTest::ExpectClose(expected, profile.GetBinContent(combination.combination, component.component, harmonic,
+                                                            bin), name);
+      }
+    }
+  }
+}
+
+TEST(CorrectionProfile3DCorrelationsTest, ProfilesWithoutHistogramsHaveNoBins) {
+  Qn::CorrectionProfile3DCorrelations correlations;
+  EXPECT_EQ(correlations.GetNoOfBins(), 0);
+  EXPECT_EQ(correlations.GetBinContent(Combination::AC, Component::XY, 1, 0), 0.);
+  Qn::CorrectionProfileComponents components;
+  EXPECT_EQ(components.GetNoOfBins(), 0);
+  Qn::CorrectionProfileCorrelationComponents correlation_components;
+  EXPECT_EQ(correlation_components.GetNoOfBins(), 0);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CorrectionManager.h"
+#include "HistogramComparison.h"
+
+namespace {
+constexpr int kNPtBins = 3;
+constexpr int kNHarmonics = 2;
+enum Variables { kPhi = 0, kPt, kWeight, kNVariables };
+
+/**
+ * Sums of the tracks of one pt bin.
+ */
+struct Sums {
+  double x[kNHarmonics] = {0., 0.};
+  double y[kNHarmonics] = {0., 0.};
+  double sum_weights = 0.;
+};
+
+/**
+ * Configures a manager with one differential tracking detector without corrections. The plain Q-vectors are not
+ * normalized, so that they are the sums over the tracks.
+ * @param output if true, the plain Q-vectors are configured as output.
+ */
+std::unique_ptr<Qn::CorrectionManager> Configure(bool output = true) {
+  auto manager = std::make_unique<Qn::CorrectionManager>();
+  manager->AddVariable("phi", kPhi, 1);
+  manager->AddVariable("pt", kPt, 1);
+  manager->AddVariable("weight", kWeight, 1);
+  manager->AddDetector("TPC", Qn::DetectorType::TRACK, "phi", "weight", {{"pt", kNPtBins, 0., 3.}}, {1, 2},
+                       Qn::QVector::Normalization::NONE);
+  if (output) manager->SetOutputQVectors("TPC", {Qn::QVector::CorrectionStep::PLAIN});
+  manager->SetFillOutputInMemory(true);
+  manager->InitializeOnNode();
+  return manager;
+}
+
+/**
+ * Fills the tracks of one event and returns their sums per pt bin. Every pt bin receives tracks.
+ */
+std::vector<Sums> FillEvent(Qn::CorrectionManager &manager, int event) {
+  std::mt19937 generator(event);
+  std::uniform_real_distribution<double> phi(0., 2*M_PI);
+  std::uniform_real_distribution<double> weight(0.5, 1.5);
+  std::vector<Sums> sums(kNPtBins);
+  manager.Reset();
+  manager.ProcessEvent();
+  auto values = manager.GetVariableContainer();
+  const int n_tracks = 20 + event%7;
+  for (int track = 0; track < n_tracks; ++track) {
+    const int bin = track%kNPtBins;
+    values[kPhi] = phi(generator);
+    values[kPt] = bin + 0.5;
+    values[kWeight] = weight(generator);
+    manager.FillTrackingDetectors();
+    auto &sum = sums[bin];
+    for (int h = 0; h < kNHarmonics; ++h) {
+      sum.x[h] += values[kWeight]*std::cos((h + 1)*values[kPhi]);
+      sum.y[h] += values[kWeight]*std::sin((h + 1)*values[kPhi]);
+    }
+    sum.sum_weights += values[kWeight];
+  }
+  manager.ProcessCorrections();
+  return sums;
+}
+
+void ExpectOutput(const Qn::DataContainerQVector &output, const std::vector<Sums> &sums, const std::string &what) {
+  ASSERT_EQ(static_cast<std::size_t>(kNPtBins), output.size()) << what;
+  for (int bin = 0; bin < kNPtBins; ++bin) {
+    const auto &q = output.At(bin);
+    const auto name = what + " bin " + std::to_string(bin);
+    QnTest::ExpectClose(sums[bin].sum_weights, q.sumweights(), name + " sum of weights", 1e-4);
+    for (int h = 0; h < kNHarmonics; ++h) {
+      QnTest::ExpectClose(sums[bin].x[h], q.x(h + 1), name + " x" + std::to_string(h + 1), 1e-4);
+      QnTest::ExpectClose(sums[bin].y[h], q.y(h + 1), name + " y" + std::to_string(h + 1), 1e-4);
+    }
+  }
+}
+}
+
+TEST(DetectorOutputTest, OutputFollowsEachEvent) {
+  auto manager = Configure();
+  manager->SetCurrentRunName("run1");
+  for (int event = 0; event < 10; ++event) {
+    const auto sums = FillEvent(*manager, event);
+    ExpectOutput(*manager->GetQVector("TPC", Qn::QVector::CorrectionStep::PLAIN), sums,
+                 "event " + std::to_string(event));
+  }
+  manager->Finalize();
+}
+
+TEST(DetectorOutputTest, OutputContainersSurviveRunSwitch) {
+  auto manager = Configure();
+  manager->SetCurrentRunName("run1");
+  FillEvent(*manager, 0);
+  const auto output = manager->GetQVector("TPC", Qn::QVector::CorrectionStep::PLAIN);
+  const auto first_q_vector = &output->At(0);
+  manager->SetCurrentRunName("run2");
+  EXPECT_EQ(output, manager->GetQVector("TPC", Qn::QVector::CorrectionStep::PLAIN));
+  EXPECT_EQ(first_q_vector, &output->At(0));
+  const auto sums = FillEvent(*manager, 1);
+  ExpectOutput(*output, sums, "run2");
+  EXPECT_EQ(output, manager->GetOutputQVectors().at("TPC_PLAIN"));
+  EXPECT_THROW(manager->GetQVector("TPC", Qn::QVector::CorrectionStep::RECENTERED), std::out_of_range);
+  manager->Finalize();
+}
+
+TEST(DetectorOutputTest, StepsWhichAreNoOutputFollowEachEventAfterTheFirstRequest) {
+  auto manager = Configure(false);
+  manager->SetCurrentRunName("run1");
+  EXPECT_TRUE(manager->GetOutputQVectors().empty());
+  FillEvent(*manager, 0);
+  const auto q_vectors = manager->GetQVector("TPC", Qn::QVector::CorrectionStep::PLAIN);
+  for (int event = 1; event < 5; ++event) {
+    const auto sums = FillEvent(*manager, event);
+    EXPECT_EQ(q_vectors, manager->GetQVector("TPC", Qn::QVector::CorrectionStep::PLAIN));
+    ExpectOutput(*q_vectors, sums, "event " + std::to_string(event));
+  }
+  EXPECT_TRUE(manager->GetOutputQVectors().empty());
+  manager->Finalize();
+}
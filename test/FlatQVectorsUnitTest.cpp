@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "FlatQVectors.h"
+
+TEST(FlatQVectorsTest, FillsArraysPerBin) {
+  const std::bitset<Qn::QVector::kmaxharmonics> harmonics("1010");
+  Qn::DataContainerQVector q_vectors({{"pT", 3, 0., 3.}});
+  for (std::size_t bin = 0; bin < q_vectors.size(); ++bin) {
+    q_vectors[bin] = Qn::QVector(harmonics, Qn::QVector::CorrectionStep::PLAIN);
+    for (std::size_t i = 0; i <= bin; ++i) q_vectors[bin].Add(0.3*i + bin, 1. + i);
+  }
+  Qn::FlatQVectors flat("TPC", q_vectors, harmonics);
+  flat.Fill(q_vectors);
+  ASSERT_EQ(flat.GetHarmonics(), (std::vector<unsigned int>{2, 4}));
+  for (std::size_t bin = 0; bin < q_vectors.size(); ++bin) {
+    EXPECT_FLOAT_EQ(flat.GetSumWeights()[bin], q_vectors[bin].sumweights());
+    EXPECT_EQ(flat.GetN()[bin], static_cast<Int_t>(q_vectors[bin].n()));
+    for (std::size_t ih = 0; ih < flat.GetHarmonics().size(); ++ih) {
+      const auto harmonic = flat.GetHarmonics()[ih];
+      EXPECT_FLOAT_EQ(flat.GetX(ih)[bin], q_vectors[bin].x(harmonic));
+      EXPECT_FLOAT_EQ(flat.GetY(ih)[bin], q_vectors[bin].y(harmonic));
+    }
+  }
+}
+
+TEST(FlatQVectorsTest, OutputPrototypesReceiveTheFirstEvent) {
+  const std::bitset<Qn::QVector::kmaxharmonics> harmonics("11");
+  Qn::DataContainerQVector q_vectors({{"pT", 2, 0., 2.}});
+  for (auto &q_vector : q_vectors) {
+    q_vector = Qn::QVector(harmonics, Qn::QVector::CorrectionStep::RECENTERED, Qn::QVector::Normalization::M);
+  }
+  Qn::FlatQVectors flat("TPC", Qn::DataContainerQVector({{"pT", 2, 0., 2.}}), harmonics);
+  // each output owns its copy of the prototype.
+  std::unique_ptr<Qn::DataContainerQVector> tree_prototype(flat.CreateOutputPrototype());
+  std::unique_ptr<Qn::DataContainerQVector> ntuple_prototype(flat.CreateOutputPrototype());
+  ASSERT_NE(tree_prototype.get(), ntuple_prototype.get());
+  ASSERT_NE(tree_prototype.get(), &flat.GetPrototype());
+  flat.Fill(q_vectors);
+  const std::vector<const Qn::DataContainerQVector *> prototypes{&flat.GetPrototype(), tree_prototype.get(),
+                                                                  ntuple_prototype.get()};
+  for (const auto prototype : prototypes) {
+    ASSERT_EQ(prototype->size(), q_vectors.size());
+    for (std::size_t bin = 0; bin < q_vectors.size(); ++bin) {
+      EXPECT_EQ((*prototype)[bin].GetHarmonics(), harmonics);
+      EXPECT_EQ((*prototype)[bin].GetNorm(), Qn::QVector::Normalization::M);
+    }
+  }
+}
+
+TEST(FlatQVectorsTest, BranchNamesFollowThePrototype) {
+  const std::bitset<Qn::QVector::kmaxharmonics> harmonics("11");
+  Qn::DataContainerQVector prototype;
+  prototype[0] = Qn::QVector(harmonics, Qn::QVector::CorrectionStep::PLAIN);
+  EXPECT_EQ(Qn::FlatQVectors::GetBranchNames("FMD", prototype),
+            (std::vector<std::string>{"FMD_sumweights", "FMD_n", "FMD_x1", "FMD_y1", "FMD_x2", "FMD_y2"}));
+}
+
+TEST(FlatQVectorsTest, EmptyPrototypeHasNoHarmonics) {
+  Qn::DataContainerQVector empty(std::vector<Qn::AxisD>{});
+  ASSERT_EQ(empty.size(), 0u);
+  EXPECT_TRUE(Qn::FlatQVectors::GetHarmonics(empty).empty());
+  EXPECT_EQ(Qn::FlatQVectors::GetBranchNames("FMD", empty), (std::vector<std::string>{"FMD_sumweights", "FMD_n"}));
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+
+#include <TFile.h>
+
+#include "CorrectionManager.h"
+#include "HistogramComparison.h"
+
+namespace {
+constexpr int kNChannels = 8;
+constexpr int kNEvents = 1000;
+enum Variables { kCentrality = 0, kPhi, kWeight = kPhi + kNChannels };
+
+/**
+ * Configures a manager with one channel detector, which is corrected with the gain equalization. The channels are
+ * equalized in two groups with the weights of the groups.
+ * @param method equalization method
+ * @param gain_table if true, the weights are equalized with the per channel gain table.
+ * @param input_file_name name of the calibration input file
+ */
+std::unique_ptr<Qn::CorrectionManager> Configure(Qn::GainEqualization::Method method, bool gain_table,
+                                                 const std::string &input_file_name) {
+  auto manager = std::make_unique<Qn::CorrectionManager>();
+  manager->SetCalibrationInputFileName(input_file_name);
+  manager->AddVariable("Centrality", kCentrality, 1);
+  manager->AddVariable("phi", kPhi, kNChannels);
+  manager->AddVariable("weight", kWeight, kNChannels);
+  manager->AddCorrectionAxis({"Centrality", 4, 0., 100.});
+  manager->AddDetector("FMD", Qn::DetectorType::CHANNEL, "phi", "weight", {}, {1, 2});
+  manager->SetChannelGroups("FMD", {0, 0, 0, 0, 1, 1, 1, 1});
+  Qn::GainEqualization equalization;
+  equalization.SetEqualizationMethod(method);
+  equalization.SetShift(1.);
+  equalization.SetScale(0.1);
+  equalization.SetUseChannelGroupsWeights(true);
+  equalization.SetUseGainTable(gain_table);
+  manager->AddCorrectionOnInputData("FMD", equalization);
+  manager->SetOutputQVectors("FMD", {Qn::QVector::CorrectionStep::PLAIN});
+  manager->SetFillOutputInMemory(true);
+  manager->InitializeOnNode();
+  return manager;
+}
+
+/**
+ * Fills one event. Each event is generated from its own seed, so that the same events are processed by all managers.
+ */
+void FillEvent(Qn::CorrectionManager &manager, int event) {
+  std::mt19937 generator(event);
+  std::uniform_real_distribution<double> centrality(0., 100.);
+  std::uniform_real_distribution<double> gain(0.5, 1.5);
+  manager.Reset();
+  auto values = manager.GetVariableContainer();
+  values[kCentrality] = centrality(generator);
+  for (int channel = 0; channel < kNChannels; ++channel) {
+    values[kPhi + channel] = (channel + 0.5)*2*M_PI/kNChannels;
+    values[kWeight + channel] = gain(generator)*(1. + 0.1*channel);
+  }
+  if (manager.ProcessEvent()) manager.FillChannelDetectors();
+  manager.ProcessCorrections();
+}
+
+/**
+ * Writes the calibration histograms of one run, which is processed without calibration input.
+ */
+void WriteCalibration(const std::string &file_name) {
+  auto manager = Configure(Qn::GainEqualization::Method::AVERAGE, false, "");
+  manager->SetCurrentRunName("run1");
+  for (int event = 0; event < kNEvents; ++event) FillEvent(*manager, event);
+  manager->Finalize();
+  TFile file(file_name.data(), "RECREATE");
+  manager->WriteCorrectionList(&file);
+  file.Close();
+}
+
+/**
+ * Processes the same events with the equalization computed from the calibration histograms in every event and with
+ * the gain table, and compares the plain Q-vectors, which are built from the equalized weights.
+ */
+void ExpectGainTableEqualsHistograms(Qn::GainEqualization::Method method, const std::string &what) {
+  const std::string file_name = "gainequalization_" + what + "_test.root";
+  WriteCalibration(file_name);
+  auto baseline = Configure(method, false, file_name);
+  auto table = Configure(method, true, file_name);
+  baseline->SetCurrentRunName("run1");
+  table->SetCurrentRunName("run1");
+  for (int event = 0; event < kNEvents; ++event) {
+    FillEvent(*baseline, event);
+    FillEvent(*table, event);
+    const auto &expected = baseline->GetQVector("FMD", Qn::QVector::CorrectionStep::PLAIN)->At(0);
+    const auto &actual = table->GetQVector("FMD", Qn::QVector::CorrectionStep::PLAIN)->At(0);
+    const auto name = what + " event " + std::to_string(event);
+    EXPECT_EQ(expected.n(), actual.n()) << name;
+    QnTest::ExpectClose(expected.sumweights(), actual.sumweights(), name + " sum of weights", 1e-4);
+    for (int h = 1; h <= 2; ++h) {
+      QnTest::ExpectClose(expected.x(h), actual.x(h), name + " x" + std::to_string(h), 1e-4);
+      QnTest::ExpectClose(expected.y(h), actual.y(h), name + " y" + std::to_string(h), 1e-4);
+    }
+  }
+  baseline->Finalize();
+  table->Finalize();
+  std::remove(file_name.data());
+}
+}
+
+TEST(GainEqualizationTest, GainTableEqualsAverageEqualization) {
+  ExpectGainTableEqualsHistograms(Qn::GainEqualization::Method::AVERAGE, "average");
+}
+
+TEST(GainEqualizationTest, GainTableEqualsWidthEqualization) {
+  ExpectGainTableEqualsHistograms(Qn::GainEqualization::Method::WIDTH, "width");
+}
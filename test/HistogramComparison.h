@@ -0,0 +1,75 @@
+#ifndef FLOW_TEST_HISTOGRAMCOMPARISON_H
+#define FLOW_TEST_HISTOGRAMCOMPARISON_H
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <TH1.h>
+#include <THnBase.h>
+#include <TList.h>
+
+namespace QnTest {
+/**
+ * Checks that two values agree within a relative tolerance.
+ * The tolerance allows for the different order of the additions when histograms are merged.
+ */
+inline void ExpectClose(double expected, double actual, const std::string &what, double tolerance = 1e-5) {
+  EXPECT_NEAR(expected, actual, tolerance*std::max(1., std::abs(expected))) << what;
+}
+
+inline void ExpectEqualHistograms(const TH1 *expected, const TH1 *actual, const std::string &path) {
+  ASSERT_EQ(expected->GetNcells(), actual->GetNcells()) << path;
+  ExpectClose(expected->GetEntries(), actual->GetEntries(), path + " entries");
+  for (Int_t bin = 0; bin < expected->GetNcells(); ++bin) {
+    ExpectClose(expected->GetBinContent(bin), actual->GetBinContent(bin), path + " bin " + std::to_string(bin));
+  }
+}
+
+inline void ExpectEqualHistograms(const THnBase *expected, const THnBase *actual, const std::string &path) {
+  ASSERT_EQ(expected->GetNdimensions(), actual->GetNdimensions()) << path;
+  ExpectClose(expected->GetEntries(), actual->GetEntries(), path + " entries");
+  std::vector<Int_t> coordinates(expected->GetNdimensions());
+  for (Long64_t bin = 0; bin < expected->GetNbins(); ++bin) {
+    const auto content = expected->GetBinContent(bin, coordinates.data());
+    const auto other = actual->GetBin(coordinates.data());
+    const auto what = path + " bin " + std::to_string(bin);
+    if (other < 0) {
+      EXPECT_EQ(content, 0.) << what;
+      continue;
+    }
+    ExpectClose(content, actual->GetBinContent(other), what);
+    if (expected->GetCalculateErrors()) ExpectClose(expected->GetBinError2(bin), actual->GetBinError2(other), what);
+  }
+}
+
+/**
+ * Compares two nested lists of histograms. The objects are matched by their names.
+ */
+inline void ExpectEqualLists(const TList *expected, const TList *actual, const std::string &path = "") {
+  ASSERT_NE(expected, nullptr) << path;
+  ASSERT_NE(actual, nullptr) << path;
+  EXPECT_EQ(expected->GetEntries(), actual->GetEntries()) << path;
+  for (auto object : *expected) {
+    const auto name = path + "/" + object->GetName();
+    auto other = actual->FindObject(object->GetName());
+    ASSERT_NE(other, nullptr) << name << " is missing.";
+    if (auto list = dynamic_cast<const TList *>(object)) {
+      ExpectEqualLists(list, dynamic_cast<const TList *>(other), name);
+    } else if (auto histogram = dynamic_cast<const TH1 *>(object)) {
+      auto other_histogram = dynamic_cast<const TH1 *>(other);
+      ASSERT_NE(other_histogram, nullptr) << name;
+      ExpectEqualHistograms(histogram, other_histogram, name);
+    } else if (auto histogram = dynamic_cast<const THnBase *>(object)) {
+      auto other_histogram = dynamic_cast<const THnBase *>(other);
+      ASSERT_NE(other_histogram, nullptr) << name;
+      ExpectEqualHistograms(histogram, other_histogram, name);
+    }
+  }
+}
+}
+
+#endif //FLOW_TEST_HISTOGRAMCOMPARISON_H
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#include <TH1.h>
+
+#include "InputVariableManager.h"
+#include "QAHistogram.h"
+
+TEST(InputVariableManagerTest, PositionalVariablesAreSizedExactly) {
+  Qn::InputVariableManager manager;
+  EXPECT_EQ(4u, manager.CreateVariable("a", 4));
+  EXPECT_EQ(4u, manager.CreateVariable("b", 3));
+  manager.Initialize();
+  auto values = manager.GetVariableContainer();
+  values[5] = 2.;
+  const auto b = manager.FindVariable("b");
+  EXPECT_EQ(3u, b.GetLength());
+  EXPECT_DOUBLE_EQ(2., b[1]);
+  EXPECT_EQ(4u, manager.FindVariable("Ones").size());
+  const double new_values[] = {1., 3.};
+  manager.SetValues("b", new_values, 2);
+  EXPECT_DOUBLE_EQ(3., b[1]);
+  EXPECT_TRUE(std::isnan(b[2]));
+  EXPECT_THROW(manager.SetValues("b", new_values, 4), std::out_of_range);
+}
+
+TEST(InputVariableManagerTest, OnesAreRegisteredWithTheLongestLength) {
+  Qn::InputVariableManager manager;
+  EXPECT_EQ(1u, manager.FindVariable("Ones").size());
+  manager.CreateVariable("a", 3);
+  EXPECT_EQ(3u, manager.FindVariable("Ones").size());
+  manager.CreateColumn<float>("pt", 7);
+  manager.CreateVariable("b", 2);
+  EXPECT_EQ(7u, manager.FindVariable("Ones").size());
+  Qn::InputVariableManager copy(manager);
+  copy.Initialize();
+  const auto ones = copy.FindVariable("Ones");
+  EXPECT_EQ(7u, ones.size());
+  EXPECT_DOUBLE_EQ(1., ones[6]);
+}
+
+TEST(InputVariableManagerTest, TypedColumnsHaveAnEventLength) {
+  Qn::InputVariableManager manager;
+  manager.CreateColumn<float>("pt", 20000);
+  manager.CreateColumn<int>("charge", 20000);
+  EXPECT_THROW(manager.CreateColumn<double>("pt", 1), std::invalid_argument);
+  manager.Initialize();
+  const auto pt = manager.FindVariable("pt");
+  const auto charge = manager.FindVariable("charge");
+  EXPECT_TRUE(pt.IsColumn());
+  EXPECT_TRUE(pt.IsType<float>());
+  EXPECT_EQ(nullptr, pt.Data<double>());
+  EXPECT_EQ(0u, pt.GetLength());
+  EXPECT_EQ(20000u, pt.size());
+  const double pt_values[] = {0.5, 1.5, 2.5};
+  const int charge_values[] = {1, -1};
+  manager.SetValues("pt", pt_values, 3);
+  manager.SetValues("charge", charge_values, 2);
+  EXPECT_EQ(3u, pt.GetLength());
+  EXPECT_FLOAT_EQ(1.5f, pt.Data<float>()[1]);
+  EXPECT_DOUBLE_EQ(2.5, pt[2]);
+  EXPECT_TRUE(std::isnan(pt[3]));
+  EXPECT_EQ(2u, charge.GetLength());
+  EXPECT_DOUBLE_EQ(-1., charge[1]);
+  EXPECT_DOUBLE_EQ(0., charge[2]);
+  manager.SetValues("pt", pt_values, 1);
+  EXPECT_EQ(1u, pt.GetLength());
+}
+
+TEST(InputVariableManagerTest, CopiesOwnTheirColumns) {
+  Qn::InputVariableManager manager;
+  manager.CreateColumn<float>("pt", 4);
+  Qn::InputVariableManager copy(manager);
+  manager.Initialize();
+  copy.Initialize();
+  const float values[] = {1.f, 2.f};
+  manager.SetValues("pt", values, 2);
+  copy.SetValues("pt", values + 1, 1);
+  EXPECT_EQ(2u, manager.FindVariable("pt").GetLength());
+  EXPECT_EQ(1u, copy.FindVariable("pt").GetLength());
+  EXPECT_DOUBLE_EQ(1., manager.FindVariable("pt")[0]);
+  EXPECT_DOUBLE_EQ(2., copy.FindVariable("pt")[0]);
+}
+
+TEST(InputVariableManagerTest, ChannelVariables) {
+  Qn::InputVariableManager manager;
+  manager.CreateVariable("phi", 0, 8);
+  manager.Initialize();
+  manager.CreateChannelVariable("channel", 8);
+  const auto channel = manager.FindVariable("channel");
+  EXPECT_EQ(8u, channel.GetLength());
+  EXPECT_DOUBLE_EQ(7., channel[7]);
+  EXPECT_THROW(manager.CreateChannelVariable("long", 9), std::logic_error);
+}
+
+TEST(InputVariableManagerTest, QAHistogramOfColumnUsesEventLength) {
+  Qn::InputVariableManager manager;
+  manager.CreateColumn<float>("pt", 10);
+  manager.CreateVariable("pt_double", 0, 10);
+  manager.Initialize();
+  const float pt[] = {0.5f, 1.5f, 1.5f, 3.5f};
+  manager.SetValues("pt", pt, 4);
+  manager.SetValues("pt_double", pt, 4);
+  const auto ones = manager.FindVariable("Ones");
+  Qn::QAHisto1DPtr column({manager.FindVariable("pt"), ones}, new TH1F("column", "", 5, 0., 5.));
+  Qn::QAHisto1DPtr positional({manager.FindVariable("pt_double"), ones}, new TH1F("positional", "", 5, 0., 5.));
+  column.Fill();
+  positional.Fill();
+  TList list;
+  list.SetOwner(true);
+  column.AddToList(&list);
+  positional.AddToList(&list);
+  auto column_histo = dynamic_cast<TH1 *>(list.FindObject("column"));
+  auto positional_histo = dynamic_cast<TH1 *>(list.FindObject("positional"));
+  EXPECT_DOUBLE_EQ(4., column_histo->GetEntries());
+  EXPECT_DOUBLE_EQ(2., column_histo->GetBinContent(2));
+  // entries beyond the length are NAN in the positional variable and end up in the overflow bin.
+  for (int bin = 1; bin <= column_histo->GetNbinsX(); ++bin) {
+    EXPECT_DOUBLE_EQ(positional_histo->GetBinContent(bin), column_histo->GetBinContent(bin));
+  }
+}
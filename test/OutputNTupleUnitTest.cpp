@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#ifdef QN_RNTUPLE
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ROOT/RNTuple.hxx>
+#include <TFile.h>
+#include <TMap.h>
+
+#include "FlatQVectors.h"
+#include "OutputNTuple.h"
+
+namespace {
+constexpr int kNEvents = 4;
+
+Qn::DataContainerQVector MakeEvent(const std::bitset<Qn::QVector::kmaxharmonics> &harmonics, int event) {
+  Qn::DataContainerQVector q_vectors({{"pT", 3, 0., 3.}});
+  for (std::size_t bin = 0; bin < q_vectors.size(); ++bin) {
+    q_vectors[bin] = Qn::QVector(harmonics, Qn::QVector::CorrectionStep::RECENTERED);
+    for (std::size_t i = 0; i <= bin + event; ++i) q_vectors[bin].Add(0.4*i + bin - event, 1. + 0.5*i);
+  }
+  return q_vectors;
+}
+}
+
+TEST(OutputNTupleTest, ReadsBackTheWrittenEvents) {
+  const std::string file_name = "outputntuple_test.root";
+  const std::bitset<Qn::QVector::kmaxharmonics> harmonics("101");
+  std::vector<Qn::DataContainerQVector> events;
+  for (int event = 0; event < kNEvents; ++event) events.push_back(MakeEvent(harmonics, event));
+  {
+    auto file = std::unique_ptr<TFile>(TFile::Open(file_name.data(), "RECREATE"));
+    Qn::FlatQVectors flat("TPC_RECENTERED", events.front(), harmonics);
+    Double32_t centrality = 0.;
+    Long64_t run = 0;
+    Qn::OutputNTuple ntuple("tree", file.get());
+    ntuple.AddVariable("Centrality", &centrality);
+    ntuple.AddVariable("RunNumber", &run);
+    ntuple.AddQVectors(&flat);
+    ntuple.Connect();
+    ASSERT_TRUE(ntuple.IsConnected());
+    EXPECT_THROW(ntuple.AddVariable("Late", &centrality), std::logic_error);
+    for (int event = 0; event < kNEvents; ++event) {
+      centrality = 10.*event;
+      run = 1000 + event;
+      flat.Fill(events[event]);
+      ntuple.Fill();
+    }
+    ntuple.Finalize();
+    file->Close();
+  }
+  auto file = std::unique_ptr<TFile>(TFile::Open(file_name.data(), "READ"));
+  auto prototype_map = file->Get<TMap>("tree_QVectorPrototypes");
+  ASSERT_NE(prototype_map, nullptr);
+  auto prototypes = Qn::FlatQVectors::ReadPrototypes(prototype_map);
+  ASSERT_EQ(prototypes.size(), 1u);
+  const auto &prototype = *prototypes.at("TPC_RECENTERED");
+  ASSERT_EQ(prototype.size(), events.front().size());
+  for (const auto &q_vector : prototype) EXPECT_EQ(q_vector.GetHarmonics(), harmonics);
+
+  auto reader = ROOT::Experimental::RNTupleReader::Open("tree", file_name);
+  ASSERT_EQ(reader->GetNEntries(), static_cast<std::uint64_t>(kNEvents));
+  auto centrality = reader->GetView<double>("Centrality");
+  auto run = reader->GetView<std::int64_t>("RunNumber");
+  auto sum_weights = reader->GetView<std::vector<float>>("TPC_RECENTERED_sumweights");
+  auto n = reader->GetView<std::vector<Int_t>>("TPC_RECENTERED_n");
+  auto x1 = reader->GetView<std::vector<float>>("TPC_RECENTERED_x1");
+  auto y3 = reader->GetView<std::vector<float>>("TPC_RECENTERED_y3");
+  for (int event = 0; event < kNEvents; ++event) {
+    EXPECT_DOUBLE_EQ(centrality(event), 10.*event);
+    EXPECT_EQ(run(event), 1000 + event);
+    const auto &expected = events[event];
+    ASSERT_EQ(sum_weights(event).size(), expected.size());
+    for (std::size_t bin = 0; bin < expected.size(); ++bin) {
+      EXPECT_FLOAT_EQ(sum_weights(event)[bin], expected[bin].sumweights());
+      EXPECT_EQ(n(event)[bin], static_cast<Int_t>(expected[bin].n()));
+      EXPECT_FLOAT_EQ(x1(event)[bin], expected[bin].x(1));
+      EXPECT_FLOAT_EQ(y3(event)[bin], expected[bin].y(3));
+    }
+  }
+  reader.reset();
+  file.reset();
+  std::remove(file_name.data());
+}
+#endif
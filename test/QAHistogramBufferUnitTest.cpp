@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include <TH1.h>
+#include <TH2.h>
+#include <TList.h>
+
+#include "QAHistogram.h"
+#include "InputVariableManager.h"
+
+namespace {
+void ExpectEqual(const TH1 *expected, const TH1 *actual) {
+  ASSERT_EQ(expected->GetNcells(), actual->GetNcells());
+  EXPECT_DOUBLE_EQ(expected->GetEntries(), actual->GetEntries());
+  for (Int_t bin = 0; bin < expected->GetNcells(); ++bin) {
+    EXPECT_FLOAT_EQ(expected->GetBinContent(bin), actual->GetBinContent(bin));
+    EXPECT_FLOAT_EQ(expected->GetBinError(bin), actual->GetBinError(bin));
+  }
+  Double_t expected_stats[TH1::kNstat] = {};
+  Double_t actual_stats[TH1::kNstat] = {};
+  expected->GetStats(expected_stats);
+  actual->GetStats(actual_stats);
+  for (int i = 0; i < TH1::kNstat; ++i) EXPECT_NEAR(expected_stats[i], actual_stats[i], 1e-9*std::abs(expected_stats[i]));
+}
+}
+
+TEST(QAHistogramBufferTest, BufferedEqualsDirect) {
+  Qn::InputVariableManager manager;
+  manager.CreateVariable("x", 0, 4);
+  manager.CreateVariable("y", 4, 4);
+  manager.CreateVariable("w", 8, 4);
+  manager.Initialize();
+  auto values = manager.GetVariableContainer();
+  const auto x = manager.FindVariable("x");
+  const auto y = manager.FindVariable("y");
+  const auto w = manager.FindVariable("w");
+  Qn::QAHisto1DPtr direct_1d({x, w}, new TH1F("direct_1d", "", 10, 0., 10.));
+  Qn::QAHisto1DPtr buffered_1d({x, w}, new TH1F("buffered_1d", "", 10, 0., 10.));
+  Qn::QAHisto2DPtr direct_2d({x, y, w}, new TH2F("direct_2d", "", 10, 0., 10., 5, -1., 1.));
+  Qn::QAHisto2DPtr buffered_2d({x, y, w}, new TH2F("buffered_2d", "", 10, 0., 10., 5, -1., 1.));
+  buffered_1d.SetBufferSize(7);
+  buffered_2d.SetBufferSize(7);
+  TList list;
+  list.SetOwner(true);
+  for (auto histogram : {static_cast<Qn::Impl::QAHistoBase *>(&direct_1d), static_cast<Qn::Impl::QAHistoBase *>(&buffered_1d),
+                         static_cast<Qn::Impl::QAHistoBase *>(&direct_2d), static_cast<Qn::Impl::QAHistoBase *>(&buffered_2d)}) {
+    histogram->AddToList(&list);
+  }
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> x_distribution(-1., 11.);
+  std::uniform_real_distribution<double> y_distribution(-1.2, 1.2);
+  std::uniform_real_distribution<double> w_distribution(0.5, 2.);
+  for (int event = 0; event < 1000; ++event) {
+    for (int i = 0; i < 4; ++i) {
+      values[i] = x_distribution(generator);
+      values[4 + i] = y_distribution(generator);
+      values[8 + i] = w_distribution(generator);
+    }
+    direct_1d.Fill();
+    buffered_1d.Fill();
+    direct_2d.Fill();
+    buffered_2d.Fill();
+  }
+  // the direct histograms are complete without a flush.
+  EXPECT_DOUBLE_EQ(static_cast<TH1 *>(list.FindObject("direct_1d"))->GetEntries(), 4000.);
+  buffered_1d.Flush();
+  buffered_2d.Flush();
+  ExpectEqual(static_cast<TH1 *>(list.FindObject("direct_1d")), static_cast<TH1 *>(list.FindObject("buffered_1d")));
+  ExpectEqual(static_cast<TH1 *>(list.FindObject("direct_2d")), static_cast<TH1 *>(list.FindObject("buffered_2d")));
+}
+
+TEST(QAHistogramBufferTest, SamplingFillsEveryNthEvent) {
+  Qn::InputVariableManager manager;
+  manager.CreateVariable("x", 0, 1);
+  Qn::QAHistograms direct;
+  direct.Add("Event", Qn::AxisD("x", 10, 0., 10.), "Ones");
+  Qn::QAHistograms buffered;
+  buffered.Add("Buffered", Qn::AxisD("x", 10, 0., 10.), "Ones");
+  manager.Initialize();
+  direct.Initialize(manager);
+  buffered.Initialize(manager);
+  direct.SetSampling(3);
+  buffered.SetSampling(3);
+  buffered.SetBufferSize(16);
+  TList list;
+  list.SetOwner(true);
+  direct.AddToList(&list);
+  buffered.AddToList(&list);
+  auto values = manager.GetVariableContainer();
+  for (int event = 0; event < 100; ++event) {
+    values[0] = event%10 + 0.5;
+    direct.NextEvent();
+    direct.Fill();
+    buffered.NextEvent();
+    buffered.Fill();
+  }
+  buffered.Flush();
+  ASSERT_EQ(list.GetEntries(), 2);
+  auto direct_histogram = static_cast<TH1 *>(list.At(0));
+  auto buffered_histogram = static_cast<TH1 *>(list.At(1));
+  // events 0, 3, ..., 99 are sampled.
+  EXPECT_DOUBLE_EQ(direct_histogram->GetEntries(), 34.);
+  EXPECT_DOUBLE_EQ(direct_histogram->GetBinContent(1), 4.);
+  ExpectEqual(direct_histogram, buffered_histogram);
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "CorrectionAxisSet.h"
+#include "SubEventChannels.h"
+#include "SubEventStorage.h"
+#include "SubEventTracks.h"
+
+TEST(SubEventStorageTest, SubEventsAreContiguous) {
+  Qn::CorrectionAxisSet axes;
+  std::bitset<Qn::QVector::kmaxharmonics> harmonics("110");
+  Qn::SubEventStorage storage;
+  storage.Create<Qn::SubEventTracks>(4, &axes, harmonics);
+  ASSERT_EQ(4u, storage.size());
+  for (std::size_t ibin = 0; ibin < storage.size(); ++ibin) {
+    auto sub_event = dynamic_cast<Qn::SubEventTracks *>(storage[ibin]);
+    ASSERT_NE(nullptr, sub_event);
+    EXPECT_EQ(dynamic_cast<Qn::SubEventTracks *>(storage[0]) + ibin, sub_event);
+    EXPECT_TRUE(sub_event->GetIsTrackingDetector());
+    EXPECT_EQ(harmonics, sub_event->GetHarmonics());
+  }
+}
+
+TEST(SubEventStorageTest, RecreateAndMove) {
+  Qn::CorrectionAxisSet axes;
+  std::bitset<Qn::QVector::kmaxharmonics> harmonics("10");
+  Qn::SubEventStorage storage;
+  storage.Create<Qn::SubEventTracks>(2, &axes, harmonics);
+  storage.Create<Qn::SubEventChannels>(3, &axes, 8, harmonics);
+  ASSERT_EQ(3u, storage.size());
+  EXPECT_FALSE(storage[2]->GetIsTrackingDetector());
+  const auto first = storage[0];
+  Qn::SubEventStorage moved(std::move(storage));
+  EXPECT_EQ(0u, storage.size());
+  ASSERT_EQ(3u, moved.size());
+  EXPECT_EQ(first, moved[0]);
+  moved.Clear();
+  EXPECT_EQ(0u, moved.size());
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CorrectionManager.h"
+#include "HistogramComparison.h"
+
+namespace {
+constexpr int kNPtBins = 3;
+constexpr int kMaxTracks = 200;
+enum Variables { kCentrality = 0, kPhi, kPt, kEta, kWeight };
+
+/**
+ * Configures a manager with one differential tracking detector, which is recentered. The track variables are either
+ * variables with a length of one, which are filled track by track, or columns, which are filled with TrackColumns.
+ * The detector has cuts on one and on two track variables and one and two dimensional QA histograms.
+ */
+std::unique_ptr<Qn::CorrectionManager> Configure(bool columns) {
+  auto manager = std::make_unique<Qn::CorrectionManager>();
+  manager->SetFillCalibrationQA(true);
+  manager->AddVariable("Centrality", kCentrality, 1);
+  if (columns) {
+    for (auto name : {"phi", "pt", "eta", "weight"}) manager->AddColumn<double>(name, kMaxTracks);
+  } else {
+    manager->AddVariable("phi", kPhi, 1);
+    manager->AddVariable("pt", kPt, 1);
+    manager->AddVariable("eta", kEta, 1);
+    manager->AddVariable("weight", kWeight, 1);
+  }
+  manager->AddCorrectionAxis({"Centrality", 4, 0., 100.});
+  manager->AddDetector("TPC", Qn::DetectorType::TRACK, "phi", "weight", {{"pt", kNPtBins, 0., 3.}}, {1, 2});
+  manager->AddCutOnDetector("TPC", {"eta"}, [](const double &eta) { return std::abs(eta) < 0.8; }, "eta");
+  manager->AddCutOnDetector("TPC", {"pt", "weight"}, [](const double &pt, const double &weight) {
+    return pt > 0.2 && weight < 1.4;
+  }, "pt_weight");
+  manager->AddCorrectionOnQnVector("TPC", Qn::Recentering());
+  manager->AddHisto1D("TPC", {"pt", 30, 0., 3.});
+  manager->AddHisto2D("TPC", {{"eta", 20, -1., 1.}, {"phi", 20, 0., 2*M_PI}}, "weight");
+  manager->SetOutputQVectors("TPC", {Qn::QVector::CorrectionStep::PLAIN, Qn::QVector::CorrectionStep::RECENTERED});
+  manager->SetFillOutputInMemory(true);
+  manager->InitializeOnNode();
+  return manager;
+}
+
+/**
+ * Tracks of one event in columns.
+ */
+struct Tracks {
+  double centrality = 0.;
+  std::vector<double> phi, pt, eta, weight;
+};
+
+Tracks Generate(int event) {
+  std::mt19937 generator(event);
+  std::uniform_real_distribution<double> centrality(0., 100.);
+  std::uniform_real_distribution<double> phi(0., 2*M_PI);
+  std::uniform_real_distribution<double> pt(0., 3.);
+  std::uniform_real_distribution<double> eta(-1., 1.);
+  std::uniform_real_distribution<double> weight(0.5, 1.5);
+  Tracks tracks;
+  tracks.centrality = centrality(generator);
+  const int n_tracks = 50 + event%kMaxTracks/2;
+  for (int track = 0; track < n_tracks; ++track) {
+    tracks.phi.push_back(phi(generator));
+    tracks.pt.push_back(pt(generator));
+    tracks.eta.push_back(eta(generator));
+    tracks.weight.push_back(weight(generator));
+  }
+  return tracks;
+}
+
+void ExpectEqualQVectors(const Qn::DataContainerQVector &expected, const Qn::DataContainerQVector &actual,
+                         const std::string &what) {
+  ASSERT_EQ(expected.size(), actual.size()) << what;
+  for (std::size_t bin = 0; bin < expected.size(); ++bin) {
+    const auto &a = expected.At(bin);
+    const auto &b = actual.At(bin);
+    const auto name = what + " bin " + std::to_string(bin);
+    EXPECT_EQ(a.n(), b.n()) << name;
+    QnTest::ExpectClose(a.sumweights(), b.sumweights(), name + " sum of weights");
+    for (int h = 1; h <= 2; ++h) {
+      QnTest::ExpectClose(a.x(h), b.x(h), name + " x" + std::to_string(h));
+      QnTest::ExpectClose(a.y(h), b.y(h), name + " y" + std::to_string(h));
+    }
+  }
+}
+}
+
+TEST(TrackColumnsTest, ColumnSelectionEqualsTrackByTrack) {
+  auto baseline = Configure(false);
+  auto bulk = Configure(true);
+  auto columns = bulk->CreateTrackColumns({"phi", "pt", "eta", "weight"});
+  int event = 0;
+  for (auto run : {"run1", "run2"}) {
+    baseline->SetCurrentRunName(run);
+    bulk->SetCurrentRunName(run);
+    for (int i = 0; i < 500; ++i, ++event) {
+      const auto tracks = Generate(event);
+      baseline->Reset();
+      auto values = baseline->GetVariableContainer();
+      values[kCentrality] = tracks.centrality;
+      if (baseline->ProcessEvent()) {
+        for (std::size_t track = 0; track < tracks.phi.size(); ++track) {
+          values[kPhi] = tracks.phi[track];
+          values[kPt] = tracks.pt[track];
+          values[kEta] = tracks.eta[track];
+          values[kWeight] = tracks.weight[track];
+          baseline->FillTrackingDetectors();
+        }
+      }
+      baseline->ProcessCorrections();
+      bulk->Reset();
+      bulk->GetVariableContainer()[kCentrality] = tracks.centrality;
+      if (bulk->ProcessEvent()) {
+        columns.Set(tracks.phi.size(), {tracks.phi.data(), tracks.pt.data(), tracks.eta.data(), tracks.weight.data()});
+        bulk->FillTrackingDetectors(columns);
+      }
+      bulk->ProcessCorrections();
+      for (auto step : {Qn::QVector::CorrectionStep::PLAIN, Qn::QVector::CorrectionStep::RECENTERED}) {
+        ExpectEqualQVectors(*baseline->GetQVector("TPC", step), *bulk->GetQVector("TPC", step),
+                            "event " + std::to_string(event));
+      }
+    }
+  }
+  baseline->Finalize();
+  bulk->Finalize();
+  QnTest::ExpectEqualLists(baseline->GetCorrectionList(), bulk->GetCorrectionList());
+  QnTest::ExpectEqualLists(baseline->GetCorrectionQAList(), bulk->GetCorrectionQAList());
+}
+
+TEST(TrackColumnsTest, RejectsVariablesWhichAreNoColumns) {
+  auto baseline = Configure(false);
+  EXPECT_THROW(baseline->CreateTrackColumns({"phi"}), std::invalid_argument);
+}
@@ -0,0 +1,121 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include "DataContainer.h"
+#include "FlatQVectors.h"
+
+namespace {
+/**
+ * Writes the Q-vectors of the events in the object or in the flat layout.
+ * The Q-vectors are generated from a fixed seed, so that both layouts contain the same values.
+ */
+void Write(const std::string &file_name, bool flat, int n_events, int n_q_vectors) {
+  TFile file(file_name.data(), "RECREATE");
+  auto tree = new TTree("tree", "");
+  const std::bitset<Qn::QVector::kmaxharmonics> harmonics("11");
+  const Qn::DataContainerQVector differential({{"pT", 5, 0., 1.}, {"rapidity", 5, -1., 1.}});
+  const Qn::DataContainerQVector integrated;
+  std::vector<std::unique_ptr<Qn::DataContainerQVector>> q_vectors;
+  std::vector<Qn::FlatQVectors> flat_q_vectors;
+  // the differential Q-vectors are followed by one integrated Q-vector.
+  for (int i = 0; i <= n_q_vectors; ++i) {
+    const auto &prototype = i < n_q_vectors ? differential : integrated;
+    q_vectors.emplace_back(new Qn::DataContainerQVector(prototype));
+    const auto name = "Q" + std::to_string(i);
+    if (flat) {
+      flat_q_vectors.emplace_back(name, prototype, harmonics);
+    } else {
+      tree->Branch(name.data(), q_vectors.back().get());
+    }
+  }
+  for (auto &flat_q_vector : flat_q_vectors) flat_q_vector.AttachToTree(tree);
+  std::mt19937_64 generator(1);
+  std::uniform_real_distribution<double> phi(0., 2*M_PI);
+  for (int event = 0; event < n_events; ++event) {
+    for (int i = 0; i <= n_q_vectors; ++i) {
+      for (auto &q_vector : *q_vectors[i]) {
+        q_vector = Qn::QVector(harmonics, Qn::QVector::CorrectionStep::PLAIN, Qn::QVector::Normalization::M);
+        for (int track = 0; track < 4; ++track) q_vector.Add(phi(generator), 1.);
+        q_vector = q_vector.Normal(Qn::QVector::Normalization::M);
+      }
+      if (flat) flat_q_vectors[i].Fill(*q_vectors[i]);
+    }
+    tree->Fill();
+  }
+  file.cd();
+  tree->Write();
+  file.Close();
+}
+
+/**
+ * Reads all branches of all entries.
+ * @return time needed to read the tree in seconds.
+ */
+double Read(const std::string &file_name) {
+  const auto begin = std::chrono::steady_clock::now();
+  std::unique_ptr<TFile> file(TFile::Open(file_name.data()));
+  auto tree = dynamic_cast<TTree *>(file->Get("tree"));
+  const auto n_entries = tree->GetEntries();
+  for (Long64_t entry = 0; entry < n_entries; ++entry) tree->GetEntry(entry);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+Long64_t Size(const std::string &file_name) {
+  std::unique_ptr<TFile> file(TFile::Open(file_name.data()));
+  return file->GetSize();
+}
+}
+
+/**
+ * Compares the file size and read time of the output Q-vectors written as DataContainerQVector objects and in the flat
+ * layout (CorrectionManager::SetFlatOutputTree).
+ * Usage: CompareOutputLayouts [<number of events> [<number of differential Q-vectors>]]
+ * The differential Q-vectors have 25 bins in pT and rapidity and the harmonics 1 and 2. They are followed by one
+ * integrated Q-vector. The defaults match the output of main.cpp: five tracking detectors with four correction steps
+ * each, the integrated DetPsi detector and 5000 events.
+ */
+int main(int argc, char **argv) {
+  const int n_events = argc > 1 ? std::stoi(argv[1]) : 5000;
+  const int n_q_vectors = argc > 2 ? std::stoi(argv[2]) : 20;
+  const std::string object_file = "layout_object.root";
+  const std::string flat_file = "layout_flat.root";
+  Write(object_file, false, n_events, n_q_vectors);
+  Write(flat_file, true, n_events, n_q_vectors);
+  // the files are read twice, the first time only to fill the page cache.
+  Read(object_file);
+  Read(flat_file);
+  const auto object_time = Read(object_file);
+  const auto flat_time = Read(flat_file);
+  const auto object_size = Size(object_file);
+  const auto flat_size = Size(flat_file);
+  std::cout << n_events << " events, " << n_q_vectors + 1 << " Q-vectors" << std::endl;
+  std::cout << "object layout: " << object_size/1e6 << " MB, read in " << object_time << " s" << std::endl;
+  std::cout << "flat layout:   " << flat_size/1e6 << " MB, read in " << flat_time << " s" << std::endl;
+  std::cout << "ratio flat/object: size " << static_cast<double>(flat_size)/object_size
+            << ", read time " << flat_time/object_time << std::endl;
+  return 0;
+}
@@ -0,0 +1,70 @@
+// Flow Vector Correction Framework
+//
+// Copyright (C) 2019  Lukas Kreis Ilya Selyuzhenkov
+// Contact: l.kreis@gsi.de; ilya.selyuzhenkov@gmail.com
+// For a full list of contributors please see docs/Credits
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TFile.h"
+
+#include "CalibrationAccumulators.h"
+#include "CalibrationInput.h"
+#include "CorrectionManager.h"
+
+/**
+ * Merges the accumulator files written by CorrectionManager::WriteCalibrationAccumulators.
+ * Usage: MergeCalibration [-j <number of threads>] <output file> <input files...>
+ * If the name of the output file ends with ".root", the merged calibration histograms are written in the indexed
+ * layout of the calibration input. Otherwise the merged accumulators are written, which can be merged again.
+ */
+int main(int argc, char **argv) {
+  std::vector<std::string> arguments(argv + 1, argv + argc);
+  unsigned int n_threads = std::thread::hardware_concurrency();
+  if (arguments.size() > 1 && arguments[0]=="-j") {
+    n_threads = std::stoul(arguments[1]);
+    arguments.erase(arguments.begin(), arguments.begin() + 2);
+  }
+  n_threads = std::max(1u, n_threads);
+  if (arguments.size() < 2) {
+    std::cerr << "Usage: " << argv[0] << " [-j <number of threads>] <output file> <input files...>" << std::endl;
+    return 1;
+  }
+  const auto output = arguments.front();
+  const std::vector<std::string> inputs(arguments.begin() + 1, arguments.end());
+  try {
+    auto merged = Qn::CalibrationAccumulators::Merge(inputs, n_threads);
+    const std::string root_extension = ".root";
+    if (output.size() > root_extension.size()
+        && output.compare(output.size() - root_extension.size(), root_extension.size(), root_extension)==0) {
+      TFile file(output.data(), "RECREATE");
+      if (file.IsZombie()) throw std::runtime_error("Cannot open the output file " + output + ".");
+      auto list = merged.CreateList();
+      Qn::CalibrationInput::Write(list.get(), &file, Qn::CorrectionManager::kCorrectionListName);
+      file.Close();
+    } else {
+      merged.Write(output);
+    }
+  } catch (const std::exception &error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+  std::cout << "Merged " << inputs.size() << " files into " << output << "." << std::endl;
+  return 0;
+}